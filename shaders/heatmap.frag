@@ -0,0 +1,19 @@
+#version 330 core
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D sceneTexture;
+
+// 0 = black, 1 = blue, 2 = green, 3 = yellow, 4+ = red
+void main() {
+  float layers = texture(sceneTexture, TexCoord).r * 16.0;
+
+  vec3 color = vec3(0.0);
+  if (layers >= 4.0)      color = vec3(1.0, 0.0, 0.0);
+  else if (layers >= 3.0) color = vec3(1.0, 1.0, 0.0);
+  else if (layers >= 2.0) color = vec3(0.0, 1.0, 0.0);
+  else if (layers >= 1.0) color = vec3(0.0, 0.0, 1.0);
+
+  FragColor = vec4(color, 1.0);
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+out vec2 TexCoord;
+
+uniform vec2 uvScale;
+
+// Full-screen triangle, no vertex buffer needed
+void main() {
+  vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+  TexCoord = pos * uvScale;
+  gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
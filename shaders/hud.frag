@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2D fontAtlas;
+
+void main() {
+  float coverage = texture(fontAtlas, TexCoord).a;
+  if (coverage < 0.01) discard;
+  FragColor = Color;
+}
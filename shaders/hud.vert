@@ -0,0 +1,21 @@
+#version 330 core
+
+// Unit quad
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+// Per instance
+layout (location = 2) in vec4 iRect;    // position.xy, size.zw (pixels)
+layout (location = 3) in vec4 iUVRect;  // offset.xy, size.zw
+layout (location = 4) in vec4 iColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+uniform mat4 projection;
+
+void main() {
+  gl_Position = projection * vec4(iRect.xy + aPos * iRect.zw, 0.0, 1.0);
+  TexCoord = iUVRect.xy + aTexCoord * iUVRect.zw;
+  Color = iColor;
+}
@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D minimapTexture;
+
+void main() {
+  // Tiles over a dark backing; off-map texels are transparent border
+  vec4 tile = texture(minimapTexture, TexCoord);
+  FragColor = vec4(mix(vec3(0.0), tile.rgb, tile.a), mix(0.6, 0.9, tile.a));
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;  // Unit quad
+
+out vec2 TexCoord;
+
+uniform mat4 projection;
+uniform vec4 rect;    // position.xy, size.zw (pixels)
+uniform vec4 uvRect;  // Visible part of the map
+
+void main() {
+  gl_Position = projection * vec4(rect.xy + aPos * rect.zw, 0.0, 1.0);
+  TexCoord = uvRect.xy + aPos * uvRect.zw;
+}
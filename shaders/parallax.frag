@@ -0,0 +1,35 @@
+#version 330 core
+
+in vec2 LayerCoord;
+out vec4 FragColor;
+
+const int MAX_LAYERS = 16;  // ParallaxBackground::MAX_LAYERS
+
+// Same block as parallax.vert
+struct Layer {
+  vec4 uvRect;        // Source rect, offset.xy and size.zw in UV
+  vec4 tint;
+  vec4 periodScroll;
+  vec4 motion;
+  vec4 flags;         // x: repeatY
+};
+
+layout (std140) uniform Layers {
+  Layer layers[MAX_LAYERS];
+};
+
+uniform int layerIndex;
+uniform sampler2D layerTexture;
+uniform bool overdrawView;
+
+void main() {
+  Layer constants = layers[layerIndex];
+  bool repeatY = constants.flags.x != 0.0;
+  if (!repeatY && (LayerCoord.y < 0.0 || LayerCoord.y >= 1.0)) discard;
+
+  vec4 texel = texture(layerTexture, constants.uvRect.xy + fract(LayerCoord) * constants.uvRect.zw) * constants.tint;
+  if (texel.a < 0.01) discard;
+
+  // Additively blended: each shaded fragment adds one step
+  FragColor = overdrawView ? vec4(1.0 / 16.0, 0.0, 0.0, 1.0) : texel;
+}
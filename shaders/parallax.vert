@@ -0,0 +1,40 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;  // Unit quad, stretched over the view
+
+out vec2 LayerCoord;  // In repeats of the source rect
+
+const int MAX_LAYERS = 16;  // ParallaxBackground::MAX_LAYERS
+
+// ParallaxBackground's per-layer constants, uploaded when layers change
+struct Layer {
+  vec4 uvRect;
+  vec4 tint;
+  vec4 periodScroll;  // period.xy (world units per repeat), scrollFactor.zw
+  vec4 motion;        // autoScroll.xy, offset.zw
+  vec4 flags;         // x: repeatY
+};
+
+layout (std140) uniform Layers {
+  Layer layers[MAX_LAYERS];
+};
+
+uniform int layerIndex;
+uniform vec4 viewRect;  // World min.xy, max.xy
+uniform float time;
+
+void main() {
+  gl_Position = vec4(aPos.x * 2.0 - 1.0, 1.0 - aPos.y * 2.0, 0.0, 1.0);
+
+  Layer constants = layers[layerIndex];
+  vec2 period = constants.periodScroll.xy;
+  vec2 scrollFactor = constants.periodScroll.zw;
+
+  // The layer trails the camera by (1 - scrollFactor); linear in aPos, so
+  // interpolating it is exact
+  vec2 center = (viewRect.xy + viewRect.zw) * 0.5;
+  vec2 world = mix(viewRect.xy, viewRect.zw, aPos);
+  vec2 layer = world - center * (1.0 - scrollFactor) - constants.motion.zw - constants.motion.xy * time;
+
+  LayerCoord = layer / period;
+}
@@ -4,9 +4,12 @@ in vec2 TexCoord;
 out vec4 FragColor;
 
 uniform sampler2D spriteTexture;
+uniform bool overdrawView;
 
 void main() {
   vec4 texel = texture(spriteTexture, TexCoord);
   if (texel.a < 0.01) discard;
-  FragColor = texel;
+
+  // Additively blended: each shaded fragment adds one step
+  FragColor = overdrawView ? vec4(1.0 / 16.0, 0.0, 0.0, 1.0) : texel;
 }
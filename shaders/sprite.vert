@@ -10,8 +10,10 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform vec2 uvOffset;
 uniform vec2 uvSize;
+uniform float depth;
 
 void main() {
   gl_Position = projection * view * model * vec4(aPos, 0.0, 1.0);
+  gl_Position.z = depth;
   TexCoord = uvOffset + aTexCoord * uvSize;
 }
@@ -0,0 +1,28 @@
+#version 330 core
+
+in vec3 TexCoord;
+in vec2 WorldPos;
+in vec4 Color;
+out vec4 FragColor;
+
+uniform sampler2DArray spriteTextures;
+uniform bool overdrawView;
+
+// Same mask as the tiles; sprites outside current vision are hidden
+uniform bool fogEnabled;
+uniform sampler2D fogMask;
+uniform vec2 fogWorldToUV;
+
+void main() {
+  vec4 texel = texture(spriteTextures, TexCoord) * Color;
+  if (texel.a < 0.01) discard;
+
+  if (fogEnabled) {
+    float fog = texture(fogMask, WorldPos * fogWorldToUV).r;
+    if (fog < 0.75) discard;
+    texel.rgb *= fog;
+  }
+
+  // Additively blended: each shaded fragment adds one step
+  FragColor = overdrawView ? vec4(1.0 / 16.0, 0.0, 0.0, 1.0) : texel;
+}
@@ -0,0 +1,28 @@
+#version 330 core
+
+// Unit quad corner (position and texture coordinate)
+layout (location = 0) in vec2 aPos;
+
+// Per instance, unpacked by the attribute formats
+layout (location = 2) in vec4 iRect;    // position.xy from batchOrigin, size.zw (fixed point)
+layout (location = 3) in vec4 iUVRect;  // offset.xy, size.zw
+layout (location = 4) in float iLayer;  // Array layer
+layout (location = 5) in float iDepth;  // Clip depth
+layout (location = 6) in vec4 iColor;
+
+out vec3 TexCoord;
+out vec2 WorldPos;
+out vec4 Color;
+
+uniform mat4 viewProjection;
+uniform vec2 batchOrigin;
+uniform float rectScale;  // Fixed point -> pixels
+
+void main() {
+  vec4 rect = iRect * rectScale;
+  WorldPos = batchOrigin + rect.xy + aPos * rect.zw;
+  gl_Position = viewProjection * vec4(WorldPos, 0.0, 1.0);
+  gl_Position.z = iDepth;
+  TexCoord = vec3(iUVRect.xy + aPos * iUVRect.zw, iLayer);
+  Color = iColor;
+}
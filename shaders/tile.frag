@@ -1,10 +1,90 @@
 #version 330 core
 
-in vec2 TexCoord;
+in vec2 LocalCoord;
+in vec2 WorldPos;
+flat in vec4 Frame;
 out vec4 FragColor;
 
 uniform sampler2D spriteTexture;
+uniform bool overdrawView;
+
+uniform vec2 uvSize;  // One tile in the tileset
+uniform float tileSize;
+
+// Index texture mode
+uniform bool indexTextureMode;
+uniform usampler2D tileIndices;
+uniform int tilesPerRow;
+
+// Impostor mode: spriteTexture is the whole map prebaked, mipmapped
+uniform bool impostorMode;
+uniform vec2 impostorWorldToUV;
+
+// See TileAnimationTable for the layout
+uniform sampler2D tileAnimations;
+uniform float time;
+
+// Fog of war: 0 = unseen, 0.5 = explored, 1 = visible (one texel per tile)
+uniform bool fogEnabled;
+uniform sampler2D fogMask;
+uniform vec2 fogWorldToUV;
+
+const uint EMPTY_TILE = 0xFFFFu;
+
+// Same as in tile.vert
+vec4 resolveFrame(int tile) {
+  int frameTile = tile;
+  vec2 offset = vec2(0.0);
+
+  // Past the table's rows (TileAnimationTable::MAX_TILES) a tile is static
+  if (tile >= textureSize(tileAnimations, 0).y) {
+    return vec4(float(frameTile % tilesPerRow), float(frameTile / tilesPerRow), offset);
+  }
+
+  vec4 header = texelFetch(tileAnimations, ivec2(0, tile), 0);
+  int frameCount = int(header.x);
+
+  if (frameCount > 0 && header.y > 0.0) {
+    float t = mod(time, header.y);
+    for (int i = 1; i <= frameCount; i++) {
+      vec4 frame = texelFetch(tileAnimations, ivec2(i, tile), 0);
+      frameTile = int(frame.x);
+      offset = frame.zw;
+      if (t < frame.y) break;
+    }
+  }
+
+  return vec4(float(frameTile % tilesPerRow), float(frameTile / tilesPerRow), offset);
+}
 
 void main() {
-  FragColor = texture(spriteTexture, TexCoord);
+  vec4 frame = Frame;
+  vec2 local = LocalCoord;
+  vec4 impostor = vec4(0.0);
+
+  if (impostorMode) {
+    impostor = texture(spriteTexture, WorldPos * impostorWorldToUV);
+    if (impostor.a == 0.0) discard;
+  } else if (indexTextureMode) {
+    vec2 tileCoord = WorldPos / tileSize;
+    uint tile = texelFetch(tileIndices, ivec2(tileCoord), 0).r;
+    if (tile == EMPTY_TILE) discard;
+
+    frame = resolveFrame(int(tile));
+    local = fract(tileCoord);
+  }
+
+  if (overdrawView) {
+    FragColor = vec4(1.0 / 16.0, 0.0, 0.0, 1.0);
+    return;
+  }
+
+  // Scrolling frames wrap inside their cell
+  vec2 uv = (frame.xy + fract(local + frame.zw)) * uvSize;
+  FragColor = impostorMode ? impostor : texture(spriteTexture, uv);
+
+  // Bilinear lookup blurs the mask across tile edges
+  if (fogEnabled) {
+    FragColor.rgb *= texture(fogMask, WorldPos * fogWorldToUV).r;
+  }
 }
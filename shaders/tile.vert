@@ -1,17 +1,64 @@
 #version 330 core
 
-layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec2 aTexCoord;
+layout (location = 0) in vec2 aPos;       // Pixels from the chunk origin (int16)
+layout (location = 1) in vec2 aTexCoord;  // Corner within the run, in tiles (uint8)
+layout (location = 2) in uint aTile;      // Base tile ID (uint16)
+layout (location = 3) in vec2 aChunkOrigin;  // GPU culling path only; (0, 0) otherwise
 
-out vec2 TexCoord;
+out vec2 LocalCoord;
+out vec2 WorldPos;
+flat out vec4 Frame;  // Tileset cell.xy, scroll offset.zw
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform vec2 uvOffset;
-uniform vec2 uvSize;
+uniform float depth;
+
+// Index texture mode draws one quad over the view; tiles are looked up per fragment
+uniform bool indexTextureMode;
+uniform int tilesPerRow;
+
+// Zoomed out: one quad over the view samples the prebaked map instead
+uniform bool impostorMode;
+
+// See TileAnimationTable for the layout
+uniform sampler2D tileAnimations;
+uniform float time;
+
+// Same as in tile.frag
+vec4 resolveFrame(int tile) {
+  int frameTile = tile;
+  vec2 offset = vec2(0.0);
+
+  // Past the table's rows (TileAnimationTable::MAX_TILES) a tile is static
+  if (tile >= textureSize(tileAnimations, 0).y) {
+    return vec4(float(frameTile % tilesPerRow), float(frameTile / tilesPerRow), offset);
+  }
+
+  vec4 header = texelFetch(tileAnimations, ivec2(0, tile), 0);
+  int frameCount = int(header.x);
+
+  if (frameCount > 0 && header.y > 0.0) {
+    float t = mod(time, header.y);
+    for (int i = 1; i <= frameCount; i++) {
+      vec4 frame = texelFetch(tileAnimations, ivec2(i, tile), 0);
+      frameTile = int(frame.x);
+      offset = frame.zw;
+      if (t < frame.y) break;
+    }
+  }
+
+  return vec4(float(frameTile % tilesPerRow), float(frameTile / tilesPerRow), offset);
+}
 
 void main() {
-  gl_Position = projection * view * model * vec4(aPos, 0.0, 1.0);
-  TexCoord = uvOffset + aTexCoord * uvSize;
+  vec4 world = model * vec4(aPos + aChunkOrigin, 0.0, 1.0);
+  gl_Position = projection * view * world;
+  gl_Position.z = depth;
+
+  WorldPos = world.xy;
+  LocalCoord = aTexCoord;
+
+  // Per vertex in chunk mode, so animation costs nothing per fragment
+  Frame = (indexTextureMode || impostorMode) ? vec4(0.0) : resolveFrame(int(aTile));
 }
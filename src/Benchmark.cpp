@@ -0,0 +1,539 @@
+#include "Benchmark.h"
+#include "ComputeShader.h"
+#include "CrowdSteering.h"
+#include "EnemySimulation.h"
+#include "GLDebug.h"
+#include "ProjectileSystem.h"
+#include "RenderTarget.h"
+#include "Shader.h"
+#include "Simd.h"
+#include "Sprite.h"
+#include "SpriteBatch.h"
+#include "SpriteSorter.h"
+#include "TextureArray.h"
+#include "TileAnimationTable.h"
+#include "Tilemap.h"
+#include "Window.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+namespace Benchmark {
+
+  namespace {
+    const int SPRITE_COUNT = 100000;
+
+    struct SortableSprite {
+      int layer;
+      float y;
+    };
+
+    std::vector<SortableSprite> makeSprites(std::mt19937& rng) {
+      std::uniform_real_distribution<float> yDist(0.0f, 4096.0f * 32.0f);
+      std::uniform_int_distribution<int> layerDist(0, 3);
+
+      std::vector<SortableSprite> sprites(SPRITE_COUNT);
+      for (auto& sprite : sprites) {
+        sprite.layer = layerDist(rng);
+        sprite.y = yDist(rng);
+      }
+      return sprites;
+    }
+
+    void sortBenchmarks(std::vector<Result>& results) {
+      std::mt19937 rng(1234);
+      std::vector<SortableSprite> sprites = makeSprites(rng);
+      SpriteSorter sorter;
+      sorter.reserve(SPRITE_COUNT);
+
+      auto fillSorter = [&]() {
+        sorter.clear();
+        for (const auto& sprite : sprites) {
+          sorter.add(SpriteSorter::makeKey(sprite.layer, sprite.y));
+        }
+      };
+
+      // Fresh random order every frame: radix path
+      std::uniform_real_distribution<float> yDist(0.0f, 4096.0f * 32.0f);
+      results.push_back(measure("sprite_sort/radix/100k", 50,
+        [&]() {
+          for (auto& sprite : sprites) sprite.y = yDist(rng);
+          fillSorter();
+        },
+        [&]() { sorter.sort(); }
+      ));
+
+      // Entities drift a pixel or two per frame: insertion-sort path
+      std::uniform_real_distribution<float> jitter(-2.0f, 2.0f);
+      fillSorter();
+      sorter.sort();
+      results.push_back(measure("sprite_sort/coherent/100k", 50,
+        [&]() {
+          for (size_t i = 0; i < sprites.size(); i += 100) sprites[i].y += jitter(rng);
+          fillSorter();
+        },
+        [&]() { sorter.sort(); }
+      ));
+
+      // Baseline: stable comparison sort of pointers
+      std::vector<const SortableSprite*> pointers;
+      results.push_back(measure("sprite_sort/std_stable_sort/100k", 50,
+        [&]() {
+          for (auto& sprite : sprites) sprite.y = yDist(rng);
+          pointers.clear();
+          for (const auto& sprite : sprites) pointers.push_back(&sprite);
+        },
+        [&]() {
+          std::stable_sort(pointers.begin(), pointers.end(),
+            [](const SortableSprite* a, const SortableSprite* b) {
+              if (a->layer != b->layer) return a->layer < b->layer;
+              return a->y < b->y;
+            });
+        }
+      ));
+    }
+  }
+
+  namespace {
+    const int CULL_MAP_TILES = 1024;
+    const int CULL_SPRITE_COUNT = 100000;
+
+    // GPU-driven culling against the GL 3.3 path it replaces: a large map
+    // and a world full of sprites, seen through one internal-resolution view
+    void cullingBenchmarks(std::vector<Result>& results) {
+      Window window("Benchmark", 640, 360, true);
+      if (!window.isOpen()) {
+        std::cerr << "gpu_culling: no GL context, skipped" << std::endl;
+        return;
+      }
+
+      if (!window.supportsGpuCulling()) {
+        std::cerr << "gpu_culling: needs GL 4.3, skipped" << std::endl;
+        return;
+      }
+
+      RenderTarget target(640, 360, true);
+      Shader tileShader("shaders/tile.vert", "shaders/tile.frag");
+      Shader spriteShader("shaders/sprite_batch.vert", "shaders/sprite_batch.frag");
+      ComputeShader tileCull("shaders/tile_cull.comp");
+      ComputeShader spriteCull("shaders/sprite_cull.comp");
+      if (!tileCull.isValid() || !spriteCull.isValid()) return;
+
+      Texture tileset("assets/tile.png");
+      Texture spriteSheet("assets/enemy.png");
+      TileAnimationTable animations;
+
+      // Random tiles, no merging: the most chunks and vertices possible
+      std::mt19937 rng(1234);
+      std::uniform_int_distribution<int> tileDist(GRASS, WATER);
+      Tilemap tilemap(CULL_MAP_TILES, CULL_MAP_TILES, 32, &tileset);
+      for (int y = 0; y < CULL_MAP_TILES; y++) {
+        for (int x = 0; x < CULL_MAP_TILES; x++) {
+          tilemap.setTile(x, y, tileDist(rng));
+        }
+      }
+
+      for (Shader* shader : { &tileShader, &spriteShader }) {
+        shader->use();
+        shader->setInt("overdrawView", 0);
+        shader->setInt("fogEnabled", 0);
+      }
+      tileShader.use();
+      tileShader.setInt("tileAnimations", 1);
+      tileShader.setFloat("time", 0.0f);
+      animations.bind(1);
+      glActiveTexture(GL_TEXTURE0);
+
+      target.bind();
+      glViewport(0, 0, 640, 360);
+
+      Camera camera(640, 360);
+      float mapSpan = CULL_MAP_TILES * 32.0f;
+      std::uniform_real_distribution<float> cameraDist(320.0f, mapSpan - 320.0f);
+
+      auto moveCamera = [&]() {
+        camera.setPosition(Vector2(cameraDist(rng), cameraDist(rng)));
+      };
+
+      auto timeTiles = [&](const std::string& name, ComputeShader* cull) {
+        tilemap.setGpuCulling(cull);
+
+        // Untimed: builds whatever the path needs up front
+        tilemap.render(tileShader, camera);
+        glFinish();
+
+        results.push_back(measure(name, 200, moveCamera,
+          [&]() {
+            tilemap.render(tileShader, camera);
+            glFinish();
+          }
+        ));
+      };
+
+      timeTiles("gpu_culling/tiles/cpu/1024x1024", nullptr);
+      timeTiles("gpu_culling/tiles/gpu/1024x1024", &tileCull);
+
+      // Sprites spread as far as the batch's fixed-point range allows
+      TextureArray spriteTextures(1024, 512);
+      SpriteBatch batch(&spriteTextures);
+      Sprite sprite(&spriteSheet);
+
+      std::uniform_real_distribution<float> offsetDist(-8000.0f, 8000.0f);
+      std::vector<Vector2> positions(CULL_SPRITE_COUNT);
+      for (auto& position : positions) {
+        position = Vector2(mapSpan * 0.5f + offsetDist(rng), mapSpan * 0.5f + offsetDist(rng));
+      }
+      camera.setPosition(Vector2(mapSpan * 0.5f, mapSpan * 0.5f));
+
+      auto submitAll = [&]() {
+        batch.begin(camera);
+        for (const auto& position : positions) {
+          batch.submit(sprite, position, Vector2(32.0f, 32.0f), 0.0f);
+        }
+      };
+
+      auto timeSprites = [&](const std::string& name, ComputeShader* cull) {
+        batch.setGpuCulling(cull);
+        results.push_back(measure(name, 100, submitAll,
+          [&]() {
+            batch.flushCulled(spriteShader);
+            glFinish();
+          }
+        ));
+      };
+
+      timeSprites("gpu_culling/sprites/cpu/100k", nullptr);
+      timeSprites("gpu_culling/sprites/gpu/100k", &spriteCull);
+
+      RenderTarget::unbind();
+    }
+  }
+
+  namespace {
+    const int SIMD_COUNT = 1 << 20;
+
+    // Every kernel at every ISA level this CPU runs, each checked against
+    // the scalar result first
+    void simdBenchmarks(std::vector<Result>& results) {
+      std::mt19937 rng(1234);
+      std::uniform_real_distribution<float> positionDist(0.0f, 4096.0f);
+      std::uniform_real_distribution<float> velocityDist(-100.0f, 100.0f);
+
+      std::vector<float> x(SIMD_COUNT), y(SIMD_COUNT), vx(SIMD_COUNT), vy(SIMD_COUNT);
+      for (int i = 0; i < SIMD_COUNT; i++) {
+        x[i] = positionDist(rng);
+        y[i] = positionDist(rng);
+        vx[i] = velocityDist(rng);
+        vy[i] = velocityDist(rng);
+      }
+      const float view[4] = { 1024.0f, 1024.0f, 1664.0f, 1384.0f };
+
+      // Mostly sorted keys, as the coherent sort sees them
+      std::vector<uint32_t> keys(SIMD_COUNT);
+      for (int i = 0; i < SIMD_COUNT; i++) keys[i] = static_cast<uint32_t>(i) * 16 + (rng() % 24);
+
+      // A sparse bitset: one word in eight has anything set
+      std::vector<uint64_t> bits(SIMD_COUNT / 64 * 8);
+      for (auto& word : bits) {
+        word = rng() % 8 == 0 ? (static_cast<uint64_t>(rng()) << 32 | rng()) & (static_cast<uint64_t>(rng()) << 32 | rng()) : 0;
+      }
+
+      std::vector<float> workX, workY;
+      std::vector<uint32_t> visible(SIMD_COUNT), expectedVisible(SIMD_COUNT);
+      std::vector<uint64_t> packed(SIMD_COUNT), expectedPacked(SIMD_COUNT);
+      std::vector<uint32_t> setBits(bits.size() * 64), expectedBits(bits.size() * 64);
+
+      const Simd::Kernels& reference = Simd::kernelsFor(Simd::Level::SCALAR);
+      size_t expectedCount = reference.cullPoints(x.data(), y.data(), SIMD_COUNT, view, expectedVisible.data());
+      reference.packSortKeys(keys.data(), SIMD_COUNT, expectedPacked.data());
+      size_t expectedDescents = reference.countDescents(expectedPacked.data(), SIMD_COUNT, SIZE_MAX);
+      size_t expectedBitCount = reference.countSetBits(bits.data(), bits.size());
+      reference.findSetBits(bits.data(), bits.size(), expectedBits.data());
+
+      for (int index = 0; index < Simd::LEVEL_COUNT; index++) {
+        Simd::Level level = static_cast<Simd::Level>(index);
+        if (!Simd::isSupported(level)) continue;
+
+        const Simd::Kernels& kernels = Simd::kernelsFor(level);
+        std::string suffix = std::string("/") + Simd::levelName(level);
+
+        bool matches =
+            kernels.cullPoints(x.data(), y.data(), SIMD_COUNT, view, visible.data()) == expectedCount &&
+            std::equal(visible.begin(), visible.begin() + expectedCount, expectedVisible.begin());
+        kernels.packSortKeys(keys.data(), SIMD_COUNT, packed.data());
+        matches = matches && packed == expectedPacked &&
+                  kernels.countDescents(packed.data(), SIMD_COUNT, SIZE_MAX) == expectedDescents &&
+                  kernels.countSetBits(bits.data(), bits.size()) == expectedBitCount &&
+                  kernels.findSetBits(bits.data(), bits.size(), setBits.data()) == expectedBitCount &&
+                  std::equal(setBits.begin(), setBits.begin() + expectedBitCount, expectedBits.begin());
+        if (!matches) {
+          std::cerr << "simd: " << Simd::levelName(level) << " disagrees with scalar" << std::endl;
+        }
+
+        results.push_back(measure("simd/integrate/1M" + suffix, 100,
+          [&]() { workX = x; workY = y; },
+          [&]() { kernels.integrate(workX.data(), workY.data(), vx.data(), vy.data(), SIMD_COUNT, 0.016f); }
+        ));
+        results.push_back(measure("simd/cull_points/1M" + suffix, 100, []() {},
+          [&]() { kernels.cullPoints(x.data(), y.data(), SIMD_COUNT, view, visible.data()); }
+        ));
+        results.push_back(measure("simd/pack_sort_keys/1M" + suffix, 100, []() {},
+          [&]() { kernels.packSortKeys(keys.data(), SIMD_COUNT, packed.data()); }
+        ));
+        results.push_back(measure("simd/count_descents/1M" + suffix, 100, []() {},
+          [&]() { kernels.countDescents(packed.data(), SIMD_COUNT, SIZE_MAX); }
+        ));
+        results.push_back(measure("simd/count_set_bits/8M" + suffix, 100, []() {},
+          [&]() { kernels.countSetBits(bits.data(), bits.size()); }
+        ));
+        results.push_back(measure("simd/find_set_bits/8M" + suffix, 100, []() {},
+          [&]() { kernels.findSetBits(bits.data(), bits.size(), setBits.data()); }
+        ));
+      }
+    }
+  }
+
+  namespace {
+    const int LOD_ENEMY_COUNT = 100000;
+    const float LOD_WORLD_SIZE = 50000.0f;
+    const float LOD_VIEW_EXTENT = 734.0f;  // Half-diagonal of a 1280x720 view
+
+    // Enemies spread over a large world with the player walking through
+    // it: the simulation LOD against ticking every enemy every step
+    void simulationBenchmarks(std::vector<Result>& results) {
+      // Enemy sprites hold GL resources
+      Window window("Benchmark", 640, 360, true);
+      if (!window.isOpen()) {
+        std::cerr << "simulation_lod: no GL context, skipped" << std::endl;
+        return;
+      }
+
+      Texture enemyTexture("assets/enemy.png");
+      std::mt19937 rng(1234);
+      std::uniform_real_distribution<float> positionDist(0.0f, LOD_WORLD_SIZE);
+
+      EnemySimulation simulation;
+      for (int i = 0; i < LOD_ENEMY_COUNT; i++) {
+        simulation.add(std::make_unique<Enemy>("Enemy", positionDist(rng), positionDist(rng), 10, 30.0f,
+                                               &enemyTexture));
+      }
+
+      Vector2 player(LOD_WORLD_SIZE * 0.5f, LOD_WORLD_SIZE * 0.5f);
+      // The player, and a 1280x720 view centered on them
+      std::vector<EnemySimulation::Focus> focus{ { player, 0.0f }, { player, LOD_VIEW_EXTENT } };
+      auto chase = [&player](Enemy& enemy, float step) {
+        enemy.setTarget(player);
+        enemy.update(step);
+      };
+      auto walk = [&]() {
+        player.x += 200.0f / 60.0f;
+        focus[0].position = player;
+        focus[1].position = player;
+      };
+
+      auto step = [&]() {
+        simulation.update(1.0f / 60.0f, focus, chase);
+        simulation.restIdle();
+      };
+
+      // The first step puts the far ones to sleep
+      step();
+
+      results.push_back(measure("simulation_lod/tiered/100k", 300, walk, step));
+      results.push_back(measure("simulation_lod/every_enemy/100k", 50, walk,
+        [&]() {
+          for (int i = 0; i < simulation.size(); i++) chase(simulation.get(i), 1.0f / 60.0f);
+        }
+      ));
+    }
+  }
+
+  namespace {
+    const int PROJECTILE_COUNT = 50000;
+    const int PROJECTILE_MAP_TILES = 256;
+    const int PROJECTILE_TARGETS = 1000;
+
+    // A full pool on an open map with scattered walls, with and without
+    // targets to hit; dead projectiles are replaced untimed
+    void projectileBenchmarks(std::vector<Result>& results) {
+      // The tilemap holds GL resources
+      Window window("Benchmark", 640, 360, true);
+      if (!window.isOpen()) {
+        std::cerr << "projectiles: no GL context, skipped" << std::endl;
+        return;
+      }
+
+      Texture tileset("assets/tile.png");
+      std::mt19937 rng(1234);
+      std::uniform_int_distribution<int> tileDist(0, 19);
+      Tilemap tilemap(PROJECTILE_MAP_TILES, PROJECTILE_MAP_TILES, 32, &tileset);
+      for (int y = 0; y < PROJECTILE_MAP_TILES; y++) {
+        for (int x = 0; x < PROJECTILE_MAP_TILES; x++) {
+          tilemap.setTile(x, y, tileDist(rng) == 0 ? WATER : GRASS);
+        }
+      }
+
+      float mapSpan = PROJECTILE_MAP_TILES * 32.0f;
+      std::uniform_real_distribution<float> positionDist(0.0f, mapSpan);
+      std::uniform_real_distribution<float> angleDist(0.0f, 6.2831853f);
+
+      std::vector<float> targetX(PROJECTILE_TARGETS), targetY(PROJECTILE_TARGETS);
+      for (int i = 0; i < PROJECTILE_TARGETS; i++) {
+        targetX[i] = positionDist(rng);
+        targetY[i] = positionDist(rng);
+      }
+      SpatialGrid targets(64.0f);
+      targets.build(targetX.data(), targetY.data(), PROJECTILE_TARGETS, glm::vec4(0.0f, 0.0f, mapSpan, mapSpan));
+
+      ProjectileSystem projectiles(PROJECTILE_COUNT);
+      projectiles.setTilemap(&tilemap);
+      auto refill = [&]() {
+        while (projectiles.size() < static_cast<size_t>(PROJECTILE_COUNT)) {
+          float angle = angleDist(rng);
+          projectiles.spawn(Vector2(positionDist(rng), positionDist(rng)),
+                            Vector2(std::cos(angle) * 300.0f, std::sin(angle) * 300.0f), 4.0f, 1);
+        }
+      };
+
+      results.push_back(measure("projectiles/update/50k", 200, refill,
+        [&]() { projectiles.update(ProjectileSystem::FIXED_STEP, nullptr, 0.0f); }
+      ));
+      results.push_back(measure("projectiles/update_targets/50k", 200, refill,
+        [&]() { projectiles.update(ProjectileSystem::FIXED_STEP, &targets, 20.0f); }
+      ));
+    }
+  }
+
+  namespace {
+    const int CROWD_AGENT_COUNT = 20000;
+
+    // A ring of agents closing in on one point, so steps go from spread out
+    // to packed; on the calling thread and across a WorkerPool. Agents are
+    // re-added from the last step untimed, as the game does each frame.
+    void crowdBenchmarks(std::vector<Result>& results) {
+      std::mt19937 rng(1234);
+      std::uniform_real_distribution<float> angleDist(0.0f, 6.2831853f);
+      std::uniform_real_distribution<float> radiusDist(300.0f, 2500.0f);
+
+      Vector2 target(4096.0f, 4096.0f);
+      std::vector<Vector2> start(CROWD_AGENT_COUNT);
+      for (Vector2& position : start) {
+        float angle = angleDist(rng), radius = radiusDist(rng);
+        position = target + Vector2(std::cos(angle) * radius, std::sin(angle) * radius);
+      }
+
+      WorkerPool pool;
+      for (int parallel = 0; parallel < 2; parallel++) {
+        CrowdSteering crowd(16.0f, parallel ? &pool : nullptr);
+        std::vector<Vector2> positions = start;
+        std::vector<Vector2> velocities(CROWD_AGENT_COUNT);
+        bool stepped = false;
+        auto readd = [&]() {
+          for (size_t i = 0; stepped && i < positions.size(); i++) {
+            positions[i] = crowd.getPosition(i);
+            velocities[i] = crowd.getVelocity(i);
+          }
+          crowd.clear();
+          for (size_t i = 0; i < positions.size(); i++) {
+            crowd.add(positions[i], velocities[i], target, 30.0f + (i % 5) * 10.0f, 1.0f / 60.0f);
+          }
+          stepped = true;
+        };
+
+        std::string name = parallel
+          ? "crowd/step/20k/" + std::to_string(pool.getThreadCount()) + "_threads"
+          : "crowd/step/20k/1_thread";
+        results.push_back(measure(name, 300, readd, [&]() { crowd.step(); }));
+      }
+    }
+  }
+
+  namespace {
+    struct Group {
+      const char* name;
+      void (*run)(std::vector<Result>& results);
+    };
+
+    const Group GROUPS[] = {
+      { "sprite_sort", sortBenchmarks },
+      { "gpu_culling", cullingBenchmarks },
+      { "simd", simdBenchmarks },
+      { "simulation_lod", simulationBenchmarks },
+      { "projectiles", projectileBenchmarks },
+      { "crowd", crowdBenchmarks },
+    };
+
+    // Result names are "group/case/...": a filter matches anywhere in one
+    bool matches(const std::string& name, const std::string& filter) {
+      return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    // Could the group produce a matching result? Its name appears in all of
+    // them, so a filter inside it or starting with "group/" decides it.
+    bool mayMatch(const std::string& group, const std::string& filter) {
+      return matches(group, filter) || filter.compare(0, group.size() + 1, group + "/") == 0;
+    }
+  }
+
+  Result measure(const std::string& name, int iterations,
+                 const std::function<void()>& setup,
+                 const std::function<void()>& body) {
+    std::vector<double> times;
+    times.reserve(iterations);
+    int warningsBefore = GLDebug::getTotals().performanceTotal();
+
+    for (int i = 0; i < iterations; i++) {
+      setup();
+
+      auto start = std::chrono::steady_clock::now();
+      body();
+      auto end = std::chrono::steady_clock::now();
+
+      times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    int warnings = GLDebug::getTotals().performanceTotal() - warningsBefore;
+    return { name, iterations, times.front(), times[times.size() / 2], warnings };
+  }
+
+  int run(const std::string& filter) {
+    std::vector<Result> results;
+
+    // A filter naming no group (only part of a case) runs every group and
+    // keeps the matching results
+    bool anyGroup = false;
+    for (const auto& group : GROUPS) {
+      anyGroup = anyGroup || mayMatch(group.name, filter);
+    }
+
+    for (const auto& group : GROUPS) {
+      if (anyGroup && !mayMatch(group.name, filter)) continue;
+
+      group.run(results);
+    }
+
+    std::cout << "{\"benchmarks\": [" << std::endl;
+
+    bool first = true;
+    for (const auto& result : results) {
+      if (!matches(result.name, filter)) continue;
+
+      if (!first) std::cout << "," << std::endl;
+      first = false;
+
+      std::cout << "  {\"name\": \"" << result.name << "\""
+                << ", \"iterations\": " << result.iterations
+                << ", \"min_ms\": " << result.minMs
+                << ", \"median_ms\": " << result.medianMs
+                << ", \"gl_perf_warnings\": " << result.glPerfWarnings << "}";
+    }
+
+    std::cout << std::endl << "]}" << std::endl;
+    return 0;
+  }
+}
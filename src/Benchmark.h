@@ -0,0 +1,26 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Micro-benchmarks for engine kernels, run with `./game --bench [filter]`.
+// CPU groups need no window; GPU groups render offscreen in a hidden one.
+// Results are printed to stdout as JSON.
+namespace Benchmark {
+
+  struct Result {
+    std::string name;
+    int iterations;
+    double minMs;
+    double medianMs;
+    int glPerfWarnings;  // Driver performance messages during the run (debug builds)
+  };
+
+  // Times `iterations` calls of `body`, running `setup` untimed before each
+  Result measure(const std::string& name, int iterations,
+                 const std::function<void()>& setup,
+                 const std::function<void()>& body);
+
+  int run(const std::string& filter);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+
+// Built-in 5x7 pixel font baked into a small glyph atlas at startup, so
+// HUD text needs no font files or extra libraries. Covers printable ASCII;
+// the cell after '~' is a solid block used for plain rectangles.
+class BitmapFont {
+  private:
+    GLObject textureID;
+    int atlasWidth;
+    int atlasHeight;
+
+  public:
+    static const int GLYPH_WIDTH = 5;
+    static const int GLYPH_HEIGHT = 7;
+    static const int CELL_WIDTH = 6;    // Glyph plus one pixel of spacing
+    static const int CELL_HEIGHT = 8;
+
+    BitmapFont();
+
+    void bind(GLuint slot = 0);
+    void unbind();
+
+    // UV rect (offset.xy, size.zw) of a glyph; unknown characters map to '?'
+    glm::vec4 getGlyphUV(char c) const;
+
+    // Zero-size UV rect inside the solid block, for flat-colored quads
+    glm::vec4 getSolidUV() const;
+};
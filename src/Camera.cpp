@@ -8,6 +8,8 @@ Camera::Camera(int viewportWidth, const int viewportHeight) {
   this->viewportHeight = viewportHeight;
 
   position = Vector2(0, 0);
+  pixelScale = 1.0f;
+  zoom = 1.0f;
 
   // Default until call setWorldBoundires. Setting min/max to allow camera to go anywhere initially
   worldMin = Vector2(0.0f, 0.0f);
@@ -24,8 +26,8 @@ void Camera::centerOn(const Vector2& target) {
   position = target;
 
   // Calculate calid range for camera center
-  float halfWidth = viewportWidth / 2.0f;
-  float halfHeight = viewportHeight / 2.0f;
+  float halfWidth = viewportWidth / (2.0f * getScale());
+  float halfHeight = viewportHeight / (2.0f * getScale());
 
   float minX = worldMin.x + halfWidth;
   float maxX = worldMax.x - halfWidth;
@@ -37,12 +39,12 @@ void Camera::centerOn(const Vector2& target) {
   position.y = clamp(position.y, minY, maxY);
 
   // World narrower than viewport - center horizontally
-  if (worldMax.x - worldMin.x < viewportWidth) {
+  if (worldMax.x - worldMin.x < halfWidth * 2.0f) {
     position.x = (worldMax.x + worldMin.x ) / 2.0f;
   }
   
   // World narrower than viewport - center vertically
-  if (worldMax.y - worldMin.y < viewportHeight) {
+  if (worldMax.y - worldMin.y < halfHeight * 2.0f) {
     position.y = (worldMax.y + worldMin.y) / 2.0f;
   }
 }
@@ -50,8 +52,9 @@ void Camera::centerOn(const Vector2& target) {
 Vector2 Camera::worldToScreen(const Vector2& worldPos) const {
   Vector2 screenPos;
 
-  screenPos.x = worldPos.x - position.x + (viewportWidth / 2.0f);
-  screenPos.y = worldPos.y - position.y + (viewportHeight / 2.0f);
+  float scale = getScale();
+  screenPos.x = (worldPos.x - position.x) * scale + (viewportWidth / 2.0f);
+  screenPos.y = (worldPos.y - position.y) * scale + (viewportHeight / 2.0f);
   return screenPos;
 }
 
@@ -64,6 +67,14 @@ void Camera::setViewportSize(int width, int height) {
   viewportHeight = height;
 }
 
+void Camera::setZoom(float zoom) {
+  this->zoom = clamp(zoom, MIN_ZOOM, MAX_ZOOM);
+}
+
+void Camera::setPixelScale(float pixelScale) {
+  this->pixelScale = pixelScale;
+}
+
 void Camera::setWorldBounds(float minX, float minY, float maxX, float maxY) {
   worldMin = Vector2(minX, minY);
   worldMax = Vector2(maxX, maxY);
@@ -81,8 +92,25 @@ int Camera::getViewportHeight() const {
   return viewportHeight;
 }
 
+float Camera::getZoom() const {
+  return zoom;
+}
+
+float Camera::getScale() const {
+  return pixelScale * zoom;
+}
+
+glm::vec4 Camera::getViewRect() const {
+  float halfWidth = viewportWidth / (2.0f * getScale());
+  float halfHeight = viewportHeight / (2.0f * getScale());
+  return glm::vec4(position.x - halfWidth, position.y - halfHeight,
+                   position.x + halfWidth, position.y + halfHeight);
+}
+
 glm::mat4 Camera::getViewMatrix() const {
-  float tx = -position.x + viewportWidth / 2.0f;
-  float ty = -position.y + viewportHeight / 2.0f;
-  return glm::translate(glm::mat4(1.0f), glm::vec3(tx, ty, 0.0f));
+  // Scale about the camera center, then put the center mid-viewport
+  glm::mat4 view = glm::translate(glm::mat4(1.0f),
+      glm::vec3(viewportWidth / 2.0f, viewportHeight / 2.0f, 0.0f));
+  view = glm::scale(view, glm::vec3(getScale(), getScale(), 1.0f));
+  return glm::translate(view, glm::vec3(-position.x, -position.y, 0.0f));
 }
@@ -12,10 +12,17 @@ class Camera {
     Vector2 worldMin;
     Vector2 worldMax;
 
-    // Visible area
+    // Visible area, in internal-resolution pixels
     int viewportWidth;
     int viewportHeight;
 
+    // Internal pixels per world unit at zoom 1, so a low internal
+    // resolution doesn't shrink the visible world
+    float pixelScale;
+
+    // User zoom on top of that; below 1 is zoomed out
+    float zoom;
+
   public:
     Camera(int viewportWidth, int viewportHeight);
 
@@ -24,12 +31,26 @@ class Camera {
     void setPosition(const Vector2& pos);
     void centerOn(const Vector2& target);
 
+    // Clamped to [MIN_ZOOM, MAX_ZOOM]
+    void setZoom(float zoom);
+    void setPixelScale(float pixelScale);
+
     float clamp(float value, float x, float y);
 
     // Getters
     Vector2 getPosition()   const;
     int getViewportWidth()  const;
     int getViewportHeight() const;
+    float getZoom() const;
+
+    // Internal pixels per world unit: pixel scale times zoom
+    float getScale() const;
+
+    // World area in view: min.xy, max.xy
+    glm::vec4 getViewRect() const;
+
+    static constexpr float MIN_ZOOM = 1.0f / 16.0f;
+    static constexpr float MAX_ZOOM = 4.0f;
 
     Vector2 worldToScreen(const Vector2& worldPos) const; // For rendering
     glm::mat4 getViewMatrix() const;
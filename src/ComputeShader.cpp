@@ -0,0 +1,96 @@
+#include "ComputeShader.h"
+
+ComputeShader::ComputeShader(const std::string& computePath)
+  : programID(0),
+    path(computePath)
+{
+  std::string source = readFile(path);
+  if (source.empty()) {
+    std::cerr << "Failed to read compute shader: " << path << std::endl;
+    return;
+  }
+
+  GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+  const char* src = source.c_str();
+  glShaderSource(shader, 1, &src, nullptr);
+  glCompileShader(shader);
+
+  GLint success;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+    std::cerr << "Compute shader compilation failed (" << path << ")\n" << infoLog << std::endl;
+    glDeleteShader(shader);
+    return;
+  }
+
+  programID = glCreateProgram();
+  glAttachShader(programID, shader);
+  glLinkProgram(programID);
+  glDeleteShader(shader);
+
+  glGetProgramiv(programID, GL_LINK_STATUS, &success);
+  if (!success) {
+    char infoLog[512];
+    glGetProgramInfoLog(programID, 512, nullptr, infoLog);
+    std::cerr << "Compute shader linking failed (" << path << ")\n" << infoLog << std::endl;
+    glDeleteProgram(programID);
+    programID = 0;
+    return;
+  }
+
+  std::cout << "Compute shader compiled: " << path << std::endl;
+}
+
+ComputeShader::~ComputeShader() {
+  if (programID != 0) {
+    glDeleteProgram(programID);
+  }
+}
+
+std::string ComputeShader::readFile(const std::string& filepath) {
+  std::ifstream file(filepath);
+  if (!file.is_open()) return "";
+
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  return buffer.str();
+}
+
+void ComputeShader::use() {
+  glUseProgram(programID);
+}
+
+void ComputeShader::dispatch(int items, int groupSize) {
+  if (items <= 0) return;
+  glDispatchCompute(static_cast<GLuint>((items + groupSize - 1) / groupSize), 1, 1);
+}
+
+bool ComputeShader::isValid() const {
+  return programID != 0;
+}
+
+GLuint ComputeShader::getID() const {
+  return programID;
+}
+
+void ComputeShader::setInt(const std::string& name, int value) {
+  glUniform1i(glGetUniformLocation(programID, name.c_str()), value);
+}
+
+void ComputeShader::setUint(const std::string& name, unsigned int value) {
+  glUniform1ui(glGetUniformLocation(programID, name.c_str()), value);
+}
+
+void ComputeShader::setFloat(const std::string& name, float value) {
+  glUniform1f(glGetUniformLocation(programID, name.c_str()), value);
+}
+
+void ComputeShader::setVec2(const std::string& name, const glm::vec2& value) {
+  glUniform2fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+}
+
+void ComputeShader::setVec4(const std::string& name, const glm::vec4& value) {
+  glUniform4fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+}
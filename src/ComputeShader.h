@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Common.h"
+
+// Single-stage compute program (GL 4.3). Only created when
+// Window::supportsGpuCulling() says the context can run it.
+class ComputeShader {
+  private:
+    GLuint programID;
+    std::string path;
+
+    std::string readFile(const std::string& filepath);
+
+  public:
+    ComputeShader(const std::string& computePath);
+    ~ComputeShader();
+
+    void use();
+
+    // Runs ceil(items / groupSize) work groups
+    void dispatch(int items, int groupSize);
+
+    bool isValid() const;
+    GLuint getID() const;
+
+    // Uniform setters
+    void setInt(const std::string& name, int value);
+    void setUint(const std::string& name, unsigned int value);
+    void setFloat(const std::string& name, float value);
+    void setVec2(const std::string& name, const glm::vec2& value);
+    void setVec4(const std::string& name, const glm::vec4& value);
+};
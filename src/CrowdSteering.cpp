@@ -0,0 +1,221 @@
+#include "CrowdSteering.h"
+
+#include <algorithm>
+#include <cmath>
+
+CrowdSteering::CrowdSteering(float agentRadius, WorkerPool* pool)
+  : agentRadius(agentRadius),
+    neighbourRadius(agentRadius * 2.5f),
+    pool(pool)
+{
+  // A cell per neighbourhood: a query reads at most 3x3 cells
+  grid = std::make_unique<SpatialGrid>(neighbourRadius);
+}
+
+void CrowdSteering::setTilemap(const Tilemap* tilemap) {
+  tiles.setTilemap(tilemap);
+}
+
+void CrowdSteering::clear() {
+  positionX.clear();
+  positionY.clear();
+  velocityX.clear();
+  velocityY.clear();
+  targetX.clear();
+  targetY.clear();
+  maxSpeed.clear();
+  stepTime.clear();
+}
+
+size_t CrowdSteering::add(const Vector2& position, const Vector2& velocity, const Vector2& target, float maxSpeed,
+                          float deltaTime) {
+  positionX.push_back(position.x);
+  positionY.push_back(position.y);
+  velocityX.push_back(velocity.x);
+  velocityY.push_back(velocity.y);
+  targetX.push_back(target.x);
+  targetY.push_back(target.y);
+  this->maxSpeed.push_back(std::max(0.0f, maxSpeed));
+  stepTime.push_back(std::max(0.0f, deltaTime));
+  return positionX.size() - 1;
+}
+
+void CrowdSteering::step() {
+  size_t count = positionX.size();
+  if (count == 0) return;
+
+  tiles.sync();
+
+  glm::vec4 bounds(positionX[0], positionY[0], positionX[0], positionY[0]);
+  for (size_t i = 1; i < count; i++) {
+    bounds.x = std::min(bounds.x, positionX[i]);
+    bounds.y = std::min(bounds.y, positionY[i]);
+    bounds.z = std::max(bounds.z, positionX[i]);
+    bounds.w = std::max(bounds.w, positionY[i]);
+  }
+  grid->build(positionX.data(), positionY.data(), count, bounds);
+
+  nextX.resize(count);
+  nextY.resize(count);
+  nextVelocityX.resize(count);
+  nextVelocityY.resize(count);
+
+  if (pool != nullptr) {
+    pool->parallelFor(count, CHUNK_SIZE, [this](size_t begin, size_t end) { steerRange(begin, end); });
+  } else {
+    steerRange(0, count);
+  }
+
+  positionX.swap(nextX);
+  positionY.swap(nextY);
+  velocityX.swap(nextVelocityX);
+  velocityY.swap(nextVelocityY);
+}
+
+size_t CrowdSteering::size() const {
+  return positionX.size();
+}
+
+Vector2 CrowdSteering::getPosition(size_t agent) const {
+  return Vector2(positionX[agent], positionY[agent]);
+}
+
+Vector2 CrowdSteering::getVelocity(size_t agent) const {
+  return Vector2(velocityX[agent], velocityY[agent]);
+}
+
+void CrowdSteering::steerRange(size_t begin, size_t end) {
+  const float inverseSpacing = 1.0f / (agentRadius * 2.0f);
+  bool hasTiles = tiles.hasTilemap();
+
+  for (size_t i = begin; i < end; i++) {
+    float px = positionX[i], py = positionY[i];
+    float vx = velocityX[i], vy = velocityY[i];
+    float speed = maxSpeed[i];
+    float dt = stepTime[i];
+
+    if (dt <= 0.0f || speed <= 0.0f) {
+      nextX[i] = px;
+      nextY[i] = py;
+      nextVelocityX[i] = dt <= 0.0f ? vx : 0.0f;
+      nextVelocityY[i] = dt <= 0.0f ? vy : 0.0f;
+      continue;
+    }
+
+    float toX = targetX[i] - px, toY = targetY[i] - py;
+    float distance = std::sqrt(toX * toX + toY * toY);
+    float headingX = 0.0f, headingY = 0.0f;
+    if (distance > 1.0e-3f) {
+      headingX = toX / distance;
+      headingY = toY / distance;
+    }
+
+    // Neighbours; this agent's own point counts against the budget too
+    float awayX = 0.0f, awayY = 0.0f;
+    float flowX = 0.0f, flowY = 0.0f;
+    float brake = 1.0f;
+    int neighbours = 0;
+    uint32_t self = static_cast<uint32_t>(i);
+    grid->forEachNear(px, py, neighbourRadius, MAX_NEIGHBOURS + 1, [&](uint32_t id, float qx, float qy) {
+      if (id == self) return;
+
+      neighbours++;
+      flowX += velocityX[id];
+      flowY += velocityY[id];
+
+      // Stronger the closer, nothing past the spacing. Branch-free: which
+      // neighbours are close is a coin flip.
+      float offsetX = px - qx, offsetY = py - qy;
+      float squared = offsetX * offsetX + offsetY * offsetY;
+      // (1 - gap / spacing) / gap, as one sqrt and one divide
+      float inverseGap = 1.0f / std::sqrt(std::max(squared, 1.0e-6f));
+      float gap = squared * inverseGap;
+      float weight = std::max(0.0f, inverseGap - inverseSpacing);
+      awayX += offsetX * weight;
+      awayY += offsetY * weight;
+
+      // One in the way: wait behind it rather than push into it
+      bool ahead = weight > 0.0f && offsetX * headingX + offsetY * headingY < -AHEAD_COSINE * gap;
+      brake = std::min(brake, ahead ? std::max(0.0f, gap * 2.0f * inverseSpacing - 1.0f) : 1.0f);
+
+      // Stacked agents split along a direction fixed per pair, opposite
+      // for each of the two
+      if (squared <= 1.0e-6f) {
+        float angle = static_cast<float>(std::min(self, id)) * 2.3999632f;
+        float side = self < id ? 1.0f : -1.0f;
+        awayX += std::cos(angle) * side;
+        awayY += std::sin(angle) * side;
+      }
+    });
+
+    // Arrival, held back by whoever is in the way
+    float approach = speed * std::min(1.0f, distance / ARRIVAL_RADIUS) * brake;
+    float desiredX = headingX * approach;
+    float desiredY = headingY * approach;
+
+    if (neighbours > 0) {
+      float share = ALIGNMENT_WEIGHT / neighbours;
+      desiredX += flowX * share - desiredX * ALIGNMENT_WEIGHT;
+      desiredY += flowY * share - desiredY * ALIGNMENT_WEIGHT;
+    }
+    desiredX += awayX * speed * SEPARATION_WEIGHT;
+    desiredY += awayY * speed * SEPARATION_WEIGHT;
+
+    // Obstacle avoidance: probe each axis from the agent's edge
+    bool startSolid = hasTiles && tiles.isSolidAt(px, py);
+    if (hasTiles && !startSolid) {
+      float edgeX = desiredX > 0.0f ? agentRadius : -agentRadius;
+      float edgeY = desiredY > 0.0f ? agentRadius : -agentRadius;
+      bool blockedX = desiredX != 0.0f && tiles.isSolidAt(px + edgeX + desiredX * LOOKAHEAD, py);
+      bool blockedY = desiredY != 0.0f && tiles.isSolidAt(px, py + edgeY + desiredY * LOOKAHEAD);
+      if (blockedX) {
+        desiredY += std::copysign(std::abs(desiredX), toY);
+        desiredX = 0.0f;
+      }
+      if (blockedY) {
+        desiredX += blockedX ? 0.0f : std::copysign(std::abs(desiredY), toX);
+        desiredY = 0.0f;
+      }
+    }
+
+    // Toward the desired velocity, bounded, then capped at max speed
+    float changeX = desiredX - vx, changeY = desiredY - vy;
+    float change = std::sqrt(changeX * changeX + changeY * changeY);
+    float maxChange = MAX_ACCELERATION * dt;
+    if (change > maxChange) {
+      changeX *= maxChange / change;
+      changeY *= maxChange / change;
+    }
+    vx += changeX;
+    vy += changeY;
+
+    float velocity = std::sqrt(vx * vx + vy * vy);
+    if (velocity > speed) {
+      vx *= speed / velocity;
+      vy *= speed / velocity;
+    }
+
+    // Never end the step inside a solid tile: slide along it or stop. One
+    // that starts inside (spawned there) may walk out.
+    float x = px + vx * dt, y = py + vy * dt;
+    if (hasTiles && !startSolid && tiles.isSolidAt(x, y)) {
+      if (!tiles.isSolidAt(x, py)) {
+        y = py;
+        vy = 0.0f;
+      } else if (!tiles.isSolidAt(px, y)) {
+        x = px;
+        vx = 0.0f;
+      } else {
+        x = px;
+        y = py;
+        vx = 0.0f;
+        vy = 0.0f;
+      }
+    }
+
+    nextX[i] = x;
+    nextY[i] = y;
+    nextVelocityX[i] = vx;
+    nextVelocityY[i] = vy;
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Common.h"
+#include "SolidTileMask.h"
+#include "SpatialGrid.h"
+#include "Tilemap.h"
+#include "Vector2.h"
+#include "WorkerPool.h"
+
+// Local steering for crowds chasing a target, so enemies around the player
+// spread out instead of piling onto one point.
+//
+// Agents are added every step in parallel arrays (position, velocity,
+// target, max speed, the time the step covers). A step builds a SpatialGrid
+// over the positions, then each agent blends a desired velocity from:
+//  - arrival: toward its target at full speed, slowing within ARRIVAL_RADIUS
+//    and behind neighbours in the way, so a crowd queues instead of
+//    squeezing into the middle
+//  - alignment: a share of its neighbours' average velocity
+//  - separation: away from neighbours closer than two agent radii
+//  - obstacle avoidance: a component that would run into a solid tile
+//    within LOOKAHEAD is turned along the wall, toward the target's side
+// Neighbours are the first MAX_NEIGHBOURS within the neighbour radius
+// (SpatialGrid::forEachNear), which caps the cost in a dense crowd. This is
+// local avoidance, not pathfinding.
+//
+// Velocity moves toward the desired one by at most MAX_ACCELERATION, never
+// past it, and is capped at the agent's max speed, so long steps and packed
+// crowds stay stable. Every agent reads the step's starting state and
+// writes only its own result: the step runs in WorkerPool chunks and comes
+// out the same on any thread count.
+class CrowdSteering {
+  private:
+    float agentRadius;
+    float neighbourRadius;
+    WorkerPool* pool;
+
+    std::vector<float> positionX, positionY;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> targetX, targetY;
+    std::vector<float> maxSpeed;
+    std::vector<float> stepTime;  // 0 = holds still, an obstacle to the rest
+
+    // Written by the step, swapped in after it
+    std::vector<float> nextX, nextY;
+    std::vector<float> nextVelocityX, nextVelocityY;
+
+    std::unique_ptr<SpatialGrid> grid;
+    SolidTileMask tiles;
+
+    void steerRange(size_t begin, size_t end);
+
+  public:
+    static const int MAX_NEIGHBOURS = 8;
+    static constexpr float ARRIVAL_RADIUS = 64.0f;
+
+    // Neighbours within this angle of the way to the target (cosine) brake
+    // the approach, to a stop at one agent radius
+    static constexpr float AHEAD_COSINE = 0.5f;
+    static constexpr float ALIGNMENT_WEIGHT = 0.2f;
+    static constexpr float SEPARATION_WEIGHT = 3.0f;
+    static constexpr float LOOKAHEAD = 0.25f;
+    static constexpr float MAX_ACCELERATION = 900.0f;
+
+    // Agents per WorkerPool chunk
+    static const size_t CHUNK_SIZE = 1024;
+
+    // Agents keep about two radii apart. Without a pool the step runs on
+    // the calling thread.
+    CrowdSteering(float agentRadius = 20.0f, WorkerPool* pool = nullptr);
+
+    // Solid tiles (see Tilemap::isSolid) are avoided; nullptr = none
+    void setTilemap(const Tilemap* tilemap);
+
+    // Drops the agents, keeping the storage
+    void clear();
+
+    // Returns the agent's index. deltaTime 0 adds one that holds still.
+    size_t add(const Vector2& position, const Vector2& velocity, const Vector2& target, float maxSpeed,
+               float deltaTime);
+
+    // Moves every agent by its own deltaTime
+    void step();
+
+    size_t size() const;
+
+    // After step(); before it, what was added
+    Vector2 getPosition(size_t agent) const;
+    Vector2 getVelocity(size_t agent) const;
+};
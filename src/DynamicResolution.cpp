@@ -0,0 +1,104 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  // Thresholds relative to the budget
+  const float DOWNSCALE_THRESHOLD = 1.0f;
+  const float UPSCALE_THRESHOLD = 0.8f;
+
+  // Consecutive samples needed before acting
+  const int DOWNSCALE_SAMPLES = 3;
+  const int UPSCALE_SAMPLES = 60;
+
+  // Samples ignored after a change (queries lag a few frames behind)
+  const int COOLDOWN_SAMPLES = 8;
+
+  // Scales are snapped to this step so the viewport size is stable
+  const float SCALE_STEP = 1.0f / 32.0f;
+
+  const float SMOOTHING = 0.1f;
+}
+
+DynamicResolution::DynamicResolution(float budgetMs, float minScale, float maxScale)
+  : budgetMs(budgetMs),
+    minScale(minScale),
+    maxScale(maxScale),
+    scale(maxScale),
+    enabled(true),
+    averageMs(0.0f),
+    overBudgetSamples(0),
+    underBudgetSamples(0),
+    cooldownSamples(0)
+{
+}
+
+bool DynamicResolution::update(float gpuMs) {
+  averageMs = (averageMs == 0.0f) ? gpuMs : averageMs + (gpuMs - averageMs) * SMOOTHING;
+
+  if (!enabled) return false;
+
+  if (cooldownSamples > 0) {
+    cooldownSamples--;
+    return false;
+  }
+
+  // Spikes count immediately, recoveries use the smoothed value
+  if (gpuMs > budgetMs * DOWNSCALE_THRESHOLD) {
+    overBudgetSamples++;
+    underBudgetSamples = 0;
+  } else if (averageMs < budgetMs * UPSCALE_THRESHOLD) {
+    underBudgetSamples++;
+    overBudgetSamples = 0;
+  } else {
+    overBudgetSamples = 0;
+    underBudgetSamples = 0;
+  }
+
+  float oldScale = scale;
+
+  if (overBudgetSamples >= DOWNSCALE_SAMPLES && scale > minScale) {
+    // Always drop at least one step so a marginal overrun still reacts
+    float target = scale * std::sqrt(budgetMs / averageMs);
+    setScale(std::min(target, scale - SCALE_STEP));
+  } else if (underBudgetSamples >= UPSCALE_SAMPLES && scale < maxScale) {
+    // Climb gently; overshooting would just bounce back down
+    float target = scale * std::sqrt(budgetMs * UPSCALE_THRESHOLD / averageMs);
+    setScale(std::min(target, scale + 4.0f * SCALE_STEP));
+  }
+
+  if (scale == oldScale) return false;
+
+  overBudgetSamples = 0;
+  underBudgetSamples = 0;
+  cooldownSamples = COOLDOWN_SAMPLES;
+  return true;
+}
+
+void DynamicResolution::setScale(float newScale) {
+  newScale = std::round(newScale / SCALE_STEP) * SCALE_STEP;
+  scale = std::clamp(newScale, minScale, maxScale);
+}
+
+void DynamicResolution::setEnabled(bool enabled) {
+  this->enabled = enabled;
+  if (!enabled) {
+    scale = maxScale;
+  }
+}
+
+float DynamicResolution::getScale() const {
+  return scale;
+}
+
+float DynamicResolution::getAverageMs() const {
+  return averageMs;
+}
+
+float DynamicResolution::getBudgetMs() const {
+  return budgetMs;
+}
+
+bool DynamicResolution::isEnabled() const {
+  return enabled;
+}
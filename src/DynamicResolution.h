@@ -0,0 +1,40 @@
+#pragma once
+
+// Feedback controller that picks a render scale from measured GPU frame time.
+//
+// Cost scales with pixel count (scale squared), so the controller moves the
+// scale by sqrt(budget / measured). Hysteresis keeps it from oscillating:
+// it drops quickly when over budget, but only climbs back after the GPU has
+// been comfortably under budget for a while, and waits a few samples after
+// every change for the new resolution to show up in the measurements.
+class DynamicResolution {
+  private:
+    float budgetMs;
+    float minScale;
+    float maxScale;
+    float scale;
+    bool enabled;
+
+    // Smoothed GPU time
+    float averageMs;
+
+    int overBudgetSamples;
+    int underBudgetSamples;
+    int cooldownSamples;
+
+    void setScale(float newScale);
+
+  public:
+    DynamicResolution(float budgetMs, float minScale = 0.5f, float maxScale = 1.0f);
+
+    // Feed one GPU time sample. Returns true if the scale changed.
+    bool update(float gpuMs);
+
+    void setEnabled(bool enabled);
+
+    // Getters
+    float getScale() const;
+    float getAverageMs() const;
+    float getBudgetMs() const;
+    bool isEnabled() const;
+};
@@ -0,0 +1,351 @@
+#include "DynamicTexture.h"
+#include "GLCapture.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  const char* OWNER = "DynamicTexture";
+
+  // 8 MiB a frame is ~480 MB/s at 60 fps; well under any PCIe link
+  const size_t DEFAULT_FRAME_BUDGET = 8 * 1024 * 1024;
+
+  size_t alignUp(size_t bytes) {
+    return (bytes + 3) & ~static_cast<size_t>(3);
+  }
+}
+
+size_t DynamicTexture::frameBudget = DEFAULT_FRAME_BUDGET;
+size_t DynamicTexture::frameBytes = 0;
+size_t DynamicTexture::lastFrameBytes = 0;
+
+DynamicTexture::DynamicTexture(int width, int height, Format format, int levelCount,
+                               int bufferCount, bool persistentMapping)
+  : format(format),
+    bytesPerPixel(format == Format::R8 ? 1 : 4),
+    bufferSize(0),
+    nextBuffer(0),
+    persistentMemory(nullptr),
+    texelsUploaded(0)
+{
+  levelCount = std::max(1, levelCount);
+  bufferCount = std::max(2, std::min(3, bufferCount));
+
+  levels.resize(levelCount);
+  for (int i = 0; i < levelCount; i++) {
+    Level& level = levels[i];
+    level.width = std::max(1, width >> i);
+    level.height = std::max(1, height >> i);
+    level.words.resize((static_cast<size_t>(level.width) * level.height * bytesPerPixel + 3) / 4, 0);
+
+    // Room for every level at once, plus row padding between rects
+    bufferSize += alignUp(levelBytes(i)) + MAX_DIRTY_RECTS * 4;
+  }
+
+  texture = GLObject(GLResources::Kind::TEXTURE, OWNER);
+  glBindTexture(GL_TEXTURE_2D, texture.get());
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+  GLenum internalFormat = format == Format::R8 ? GL_R8 : GL_RGBA8;
+  GLenum pixelFormat = format == Format::R8 ? GL_RED : GL_RGBA;
+  for (int i = 0; i < levelCount; i++) {
+    glTexImage2D(GL_TEXTURE_2D, i, internalFormat, levels[i].width, levels[i].height, 0,
+                 pixelFormat, GL_UNSIGNED_BYTE, nullptr);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  fences.resize(bufferCount, nullptr);
+
+  // Captures can't see writes through a persistent mapping
+  if (persistentMapping && GLAD_GL_ARB_buffer_storage && !GLCapture::isRequested()) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr ringSize = static_cast<GLsizeiptr>(bufferSize) * bufferCount;
+
+    buffers.emplace_back(GLResources::Kind::BUFFER, OWNER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[0].get());
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, ringSize, nullptr, flags);
+    persistentMemory = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, ringSize, flags));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (persistentMemory == nullptr) {
+      std::cerr << "DynamicTexture: persistent mapping failed, using map/unmap" << std::endl;
+      buffers.clear();
+    }
+  }
+
+  if (persistentMemory == nullptr) {
+    for (int i = 0; i < bufferCount; i++) {
+      buffers.emplace_back(GLResources::Kind::BUFFER, OWNER);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers.back().get());
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  // Storage starts undefined; the first uploads define it
+  markAllDirty();
+}
+
+DynamicTexture::~DynamicTexture() {
+  if (persistentMemory != nullptr) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[0].get());
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+
+  for (GLsync fence : fences) {
+    if (fence != nullptr) glDeleteSync(fence);
+  }
+}
+
+uint8_t* DynamicTexture::getPixels(int level) {
+  return reinterpret_cast<uint8_t*>(levels[level].words.data());
+}
+
+uint32_t* DynamicTexture::getPixels32(int level) {
+  return levels[level].words.data();
+}
+
+void DynamicTexture::markDirty(int x0, int y0, int x1, int y1, int levelIndex) {
+  Level& level = levels[levelIndex];
+
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, level.width);
+  y1 = std::min(y1, level.height);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  // Absorb every rect this one overlaps or touches, so rects never overlap
+  Rect merged{ x0, y0, x1, y1 };
+  for (size_t i = 0; i < level.dirty.size();) {
+    const Rect& rect = level.dirty[i];
+    bool touches = merged.x0 <= rect.x1 && rect.x0 <= merged.x1 &&
+                   merged.y0 <= rect.y1 && rect.y0 <= merged.y1;
+    if (!touches) {
+      i++;
+      continue;
+    }
+
+    merged = Rect{ std::min(merged.x0, rect.x0), std::min(merged.y0, rect.y0),
+                   std::max(merged.x1, rect.x1), std::max(merged.y1, rect.y1) };
+    level.dirty.erase(level.dirty.begin() + i);
+    i = 0;
+  }
+
+  level.dirty.push_back(merged);
+
+  if (static_cast<int>(level.dirty.size()) > MAX_DIRTY_RECTS) {
+    Rect bounds = level.dirty[0];
+    for (const Rect& rect : level.dirty) {
+      bounds = Rect{ std::min(bounds.x0, rect.x0), std::min(bounds.y0, rect.y0),
+                     std::max(bounds.x1, rect.x1), std::max(bounds.y1, rect.y1) };
+    }
+    level.dirty.assign(1, bounds);
+  }
+}
+
+void DynamicTexture::markAllDirty() {
+  for (Level& level : levels) {
+    level.dirty.assign(1, Rect{ 0, 0, level.width, level.height });
+  }
+}
+
+bool DynamicTexture::isDirty() const {
+  for (const Level& level : levels) {
+    if (!level.dirty.empty()) return true;
+  }
+  return false;
+}
+
+uint8_t* DynamicTexture::beginStaging(int index) {
+  GLsync& fence = fences[index];
+  bool busy = false;
+
+  if (fence != nullptr) {
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    busy = status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED;
+  }
+
+  if (persistentMemory != nullptr) {
+    // Can't orphan persistent storage; try again next frame
+    if (busy) return nullptr;
+
+    if (fence != nullptr) glDeleteSync(fence);
+    fence = nullptr;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[0].get());
+    return persistentMemory + static_cast<size_t>(index) * bufferSize;
+  }
+
+  if (fence != nullptr) glDeleteSync(fence);
+  fence = nullptr;
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers[index].get());
+
+  // Still being read: orphan it so the driver hands over fresh storage
+  if (busy) {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW);
+  }
+
+  // Nothing in flight uses this storage any more, so skip the driver's sync
+  void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+  if (mapped == nullptr) {
+    std::cerr << "DynamicTexture: failed to map upload buffer" << std::endl;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+  return static_cast<uint8_t*>(mapped);
+}
+
+void DynamicTexture::endStaging() {
+  if (persistentMemory == nullptr) {
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  }
+}
+
+void DynamicTexture::upload() {
+  if (!isDirty()) return;
+
+  // Budget spent by other textures; the first upload of a frame always moves
+  size_t remaining = frameBudget > frameBytes ? frameBudget - frameBytes : 0;
+  if (remaining == 0 && frameBytes > 0) return;
+
+  int index = nextBuffer;
+  uint8_t* staging = beginStaging(index);
+  if (staging == nullptr) return;
+  nextBuffer = (nextBuffer + 1) % static_cast<int>(fences.size());
+
+  struct Copy {
+    int level;
+    Rect rect;
+    size_t offset;
+  };
+  std::vector<Copy> copies;
+  size_t offset = 0;
+  bool budgetSpent = false;
+
+  for (int i = 0; i < static_cast<int>(levels.size()) && !budgetSpent; i++) {
+    Level& level = levels[i];
+    const uint8_t* pixels = getPixels(i);
+
+    while (!level.dirty.empty()) {
+      Rect& rect = level.dirty.back();
+      size_t rowBytes = static_cast<size_t>(rect.x1 - rect.x0) * bytesPerPixel;
+      int rows = rect.y1 - rect.y0;
+
+      // Whole rows only; always at least one so a huge rect still progresses
+      int fit = static_cast<int>(std::min<size_t>(rows, remaining / rowBytes));
+      if (fit == 0) {
+        if (frameBytes + offset > 0) {
+          budgetSpent = true;
+          break;
+        }
+        fit = 1;
+      }
+
+      for (int y = 0; y < fit; y++) {
+        const uint8_t* source = pixels + ((static_cast<size_t>(rect.y0 + y) * level.width + rect.x0) * bytesPerPixel);
+        std::memcpy(staging + offset + y * rowBytes, source, rowBytes);
+      }
+
+      copies.push_back(Copy{ i, Rect{ rect.x0, rect.y0, rect.x1, rect.y0 + fit }, offset });
+
+      size_t bytes = rowBytes * fit;
+      offset += alignUp(bytes);
+      remaining -= std::min(remaining, bytes);
+
+      if (fit == rows) {
+        level.dirty.pop_back();
+      } else {
+        rect.y0 += fit;
+        budgetSpent = true;
+        break;
+      }
+    }
+  }
+
+  endStaging();
+
+  if (copies.empty()) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    return;
+  }
+
+  GLenum pixelFormat = format == Format::R8 ? GL_RED : GL_RGBA;
+  size_t base = persistentMemory != nullptr ? static_cast<size_t>(index) * bufferSize : 0;
+
+  glBindTexture(GL_TEXTURE_2D, texture.get());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  for (const Copy& copy : copies) {
+    int w = copy.rect.x1 - copy.rect.x0;
+    int h = copy.rect.y1 - copy.rect.y0;
+    glTexSubImage2D(GL_TEXTURE_2D, copy.level, copy.rect.x0, copy.rect.y0, w, h,
+                    pixelFormat, GL_UNSIGNED_BYTE, reinterpret_cast<void*>(base + copy.offset));
+    texelsUploaded += w * h;
+  }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+  // Reusable once the GPU has pulled these copies out of it
+  fences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  frameBytes += offset;
+}
+
+void DynamicTexture::bind(GLuint slot) const {
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D, texture.get());
+}
+
+GLuint DynamicTexture::getID() const {
+  return texture.get();
+}
+
+int DynamicTexture::getWidth(int level) const {
+  return levels[level].width;
+}
+
+int DynamicTexture::getHeight(int level) const {
+  return levels[level].height;
+}
+
+int DynamicTexture::getLevelCount() const {
+  return static_cast<int>(levels.size());
+}
+
+bool DynamicTexture::isPersistentlyMapped() const {
+  return persistentMemory != nullptr;
+}
+
+int DynamicTexture::getTexelsUploaded() const {
+  return texelsUploaded;
+}
+
+size_t DynamicTexture::levelBytes(int level) const {
+  return static_cast<size_t>(levels[level].width) * levels[level].height * bytesPerPixel;
+}
+
+void DynamicTexture::setFrameBudget(size_t bytes) {
+  frameBudget = bytes;
+}
+
+size_t DynamicTexture::getFrameBudget() {
+  return frameBudget;
+}
+
+void DynamicTexture::endFrame() {
+  lastFrameBytes = frameBytes;
+  frameBytes = 0;
+}
+
+size_t DynamicTexture::getLastFrameBytes() {
+  return lastFrameBytes;
+}
+
+size_t DynamicTexture::getFrameBytes() {
+  return frameBytes;
+}
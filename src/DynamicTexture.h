@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+
+// Texture whose pixels are written on the CPU and streamed to the GPU.
+//
+// Owners write into the CPU copy (getPixels) and mark what changed; upload
+// packs the dirty rectangles into the next pixel unpack buffer of a small
+// ring and copies them into the texture from there. A ring buffer whose
+// fence hasn't signaled is orphaned (or, persistently mapped, skipped until
+// next frame) instead of waited on, so uploads never stall the frame.
+//
+// All dynamic textures share one per-frame upload budget. Rectangles past
+// it are uploaded partially, a band of rows at a time, and finish on the
+// following frames.
+class DynamicTexture {
+  public:
+    enum class Format { R8, RGBA8 };
+
+  private:
+    struct Rect {
+      int x0, y0, x1, y1;  // Exclusive max
+    };
+
+    struct Level {
+      int width, height;
+      std::vector<uint32_t> words;  // Pixels, rows tightly packed
+      std::vector<Rect> dirty;
+    };
+
+    // Beyond this many separate rects per level, they merge into one
+    static const int MAX_DIRTY_RECTS = 32;
+
+    static size_t frameBudget;
+    static size_t frameBytes;
+    static size_t lastFrameBytes;
+
+    GLObject texture;
+    Format format;
+    int bytesPerPixel;
+    std::vector<Level> levels;
+
+    // Staging ring; one buffer (or region, when persistently mapped) per upload
+    std::vector<GLObject> buffers;
+    std::vector<GLsync> fences;
+    size_t bufferSize;
+    int nextBuffer;
+    uint8_t* persistentMemory;  // Whole ring, mapped once
+
+    int texelsUploaded;
+
+    uint8_t* beginStaging(int index);
+    void endStaging();
+    size_t levelBytes(int level) const;
+
+  public:
+    // bufferCount is 2 (double) or 3 (triple) buffering. Persistent mapping
+    // needs ARB_buffer_storage and falls back to map/unmap without it.
+    DynamicTexture(int width, int height, Format format, int levelCount = 1,
+                   int bufferCount = 3, bool persistentMapping = false);
+    ~DynamicTexture();
+
+    DynamicTexture(const DynamicTexture&) = delete;
+    DynamicTexture& operator=(const DynamicTexture&) = delete;
+
+    // CPU copy of a level: R8 is one byte per pixel, RGBA8 one uint32_t
+    uint8_t* getPixels(int level = 0);
+    uint32_t* getPixels32(int level = 0);
+
+    void markDirty(int x0, int y0, int x1, int y1, int level = 0);
+    void markAllDirty();
+    bool isDirty() const;
+
+    // Streams what the shared budget allows this frame; the rest stays dirty
+    void upload();
+
+    void bind(GLuint slot) const;
+    GLuint getID() const;
+
+    int getWidth(int level = 0) const;
+    int getHeight(int level = 0) const;
+    int getLevelCount() const;
+    bool isPersistentlyMapped() const;
+
+    // Texels copied to the texture since creation
+    int getTexelsUploaded() const;
+
+    // Shared budget, in bytes per frame
+    static void setFrameBudget(size_t bytes);
+    static size_t getFrameBudget();
+
+    // Called once per frame (Window::swapBuffers)
+    static void endFrame();
+    static size_t getLastFrameBytes();
+
+    // Streamed since the last endFrame
+    static size_t getFrameBytes();
+};
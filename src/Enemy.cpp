@@ -1,44 +1,108 @@
 #include "Enemy.h"
 
+namespace {
+  // White at half alpha (see VertexFormat::packColor)
+  const uint32_t HURT_TINT = 0x80FFFFFF;
+}
+
 Enemy::Enemy(const std::string& name, float x, float y, int damage, float speed, Texture* texture)
     : Entity(name, x, y) {
     this->damage = damage;
+    this->health = 30;
     this->speed = speed;
     this->targetPosition = Vector2(0, 0);
+    this->velocity = Vector2(0, 0);
+    this->moving = false;
+    this->hurtTime = 0.0f;
+    this->asleep = false;
+    this->simulationSlot = 0;
 
     sprite = std::make_unique<Sprite>(texture);
     sprite->setSize(Vector2(48, 48));
+    // Enemies that sleep from the start still draw where they are
+    sprite->setPosition(position);
 }
 
 void Enemy::update(float deltaTime) {
   if (!isActive) return;
+  updateHurtFlash(deltaTime);
 
   // Move toward origin
   Vector2 direction = targetPosition - position;
   float  distance = direction.length();
 
   // Only move if we're not already at the target
-  if (distance > 1.0f) {
+  moving = distance > 1.0f;
+  velocity = Vector2(0, 0);
+  if (moving) {
     // Normalize direction and move
-    Vector2 normalized = direction.normalized();
-    position = position + normalized * speed * deltaTime;
+    velocity = direction.normalized() * speed;
+    position = position + velocity * deltaTime;
     sprite->setPosition(position);
   }
 }
 
-void Enemy::render(Shader& shader, const Camera& camera) {
+void Enemy::render(SpriteBatch& batch) {
   if (!isActive) return;
-  sprite->draw(shader, camera);
+  if (translucent) {
+    batch.submit(*sprite, sprite->getPosition(), sprite->getSize(), depth, HURT_TINT);
+  } else {
+    batch.submit(*sprite, depth);
+  }
+}
+
+float Enemy::getDepthY() const {
+  // Sort by the feet, not the top of the sprite
+  return position.y + sprite->getSize().y;
+}
+
+const Sprite* Enemy::getSprite() const {
+  return sprite.get();
 }
 
 void Enemy::setTarget(const Vector2& targetPos) {
   targetPosition = targetPos;
 }
 
+void Enemy::setMotion(const Vector2& position, const Vector2& velocity) {
+  this->position = position;
+  this->velocity = velocity;
+  sprite->setPosition(position);
+  moving = (targetPosition - position).length() > 1.0f;
+}
+
+void Enemy::takeDamage(int amount) {
+  health -= amount;
+  hurtTime = HURT_FLASH;
+  translucent = true;
+  if (health <= 0) {
+    health = 0;
+    isActive = false;
+  }
+}
+
+void Enemy::updateHurtFlash(float deltaTime) {
+  if (hurtTime <= 0.0f) return;
+  hurtTime -= deltaTime;
+  translucent = hurtTime > 0.0f;
+}
+
+bool Enemy::isIdle() const {
+  return !moving && hurtTime <= 0.0f;
+}
+
 int Enemy::getDamage() const {
   return damage;
 }
 
+int Enemy::getHealth() const {
+  return health;
+}
+
 float Enemy::getSpeed() const {
   return speed;
 }
+
+const Vector2& Enemy::getVelocity() const {
+  return velocity;
+}
@@ -3,6 +3,7 @@
 #include "Camera.h"
 #include "Entity.h"
 #include "Sprite.h"
+#include "SpriteBatch.h"
 #include "Shader.h"
 
 struct EnemySpawn {
@@ -12,22 +13,55 @@ struct EnemySpawn {
   float speed;
 };
 
+class EnemySimulation;
+
 class Enemy : public Entity {
 private:
   int damage;
+  int health;
   float speed;
   Vector2 targetPosition;
+  Vector2 velocity;
+  bool moving;
+  float hurtTime;  // Left on the hit flash
   std::unique_ptr<Sprite> sprite;
 
+  // Where EnemySimulation keeps this enemy: which list, which slot
+  friend class EnemySimulation;
+  bool asleep;
+  size_t simulationSlot;
+
 public:
+  // Seconds an enemy draws see-through after a hit
+  static constexpr float HURT_FLASH = 0.2f;
+
   Enemy(const std::string& name, float x, float y, int damage, float speed, Texture* texture);
 
   void update(float deltaTime) override;
-  void render(Shader& shader, const Camera& camera) override;
+  void render(SpriteBatch& batch) override;
+  float getDepthY() const override;
+  const Sprite* getSprite() const override;
 
   void setTarget(const Vector2& targetPos);
-  
+
+  // Moved by something else (CrowdSteering) instead of update(); idle
+  // once at its target, like update()
+  void setMotion(const Vector2& position, const Vector2& velocity);
+
+  // Deactivates at zero health, and flashes translucent for HURT_FLASH.
+  // Use EnemySimulation::damage so sleeping enemies wake up.
+  void takeDamage(int amount);
+
+  // Runs the hit flash down; update() does this itself
+  void updateHurtFlash(float deltaTime);
+
+  // Reached its target on the last update or setMotion (or never moved),
+  // not flashing
+  bool isIdle() const;
+
   // Getters
   int getDamage() const;
+  int getHealth() const;
   float getSpeed() const;
+  const Vector2& getVelocity() const;
 };
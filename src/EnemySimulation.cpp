@@ -0,0 +1,299 @@
+#include "EnemySimulation.h"
+
+#include <algorithm>
+#include <limits>
+
+EnemySimulation::EnemySimulation(float nearRadius, float sleepRadius, float wakeRadius)
+  : nearRadius(nearRadius),
+    sleepRadius(sleepRadius),
+    wakeRadius(std::min(wakeRadius, sleepRadius)),
+    focusTravel(0.0),
+    focusCountChanged(false),
+    time(0.0),
+    steps(0),
+    nextTicket(1),
+    nextPhase(0),
+    stats{ 0, 0, 0, 0, 0 }
+{
+}
+
+void EnemySimulation::add(std::unique_ptr<Enemy> enemy) {
+  if (!enemy) return;
+
+  Record record;
+  record.pendingTime = 0.0f;
+  record.phase = nextPhase;
+  record.restUntil = 0.0;
+  record.ticket = 0;
+  record.wakesOnProximity = false;
+  record.recheckTravel = 0.0;
+  record.wakeTime = std::numeric_limits<double>::infinity();
+  nextPhase = (nextPhase + 1) % MID_INTERVAL;
+
+  enemy->asleep = false;
+  enemy->simulationSlot = awake.size();
+  record.enemy = std::move(enemy);
+  awake.push_back(std::move(record));
+}
+
+void EnemySimulation::update(float deltaTime, const std::vector<Focus>& focusPoints, const TickFunction& tick,
+                             const SkipFunction& skip) {
+  stats.ticked = 0;
+  stats.resting = 0;
+  stats.woken = 0;
+  tickedEnemies.clear();
+  time += deltaTime;
+  steps++;
+  updateFocus(focusPoints);
+
+  popDue(timerWakes, time);
+  for (const WakeEntry& entry : dueWakes) {
+    if (isCurrent(entry)) wake(entry.slot);
+  }
+
+  // A new or vanished focus point can be anywhere: recheck every sleeper
+  popDue(proximityWakes, focusCountChanged ? std::numeric_limits<double>::infinity() : focusTravel);
+  for (const WakeEntry& entry : dueWakes) {
+    if (!isCurrent(entry)) continue;
+
+    Record& record = sleeping[entry.slot];
+    float distance = extentDistance(record.enemy->getPosition());
+    if (distance <= wakeRadius) {
+      wake(entry.slot);
+    } else {
+      record.recheckTravel = focusTravel + (distance - wakeRadius);
+      proximityWakes.push(WakeEntry{ record.recheckTravel, entry.slot, record.ticket });
+    }
+  }
+
+  if (proximityWakes.size() + timerWakes.size() > 4 * sleeping.size() + 256) compactWakes();
+
+  // Sleeping swap-removes, so the slot is checked again afterwards
+  for (size_t i = 0; i < awake.size();) {
+    Record& record = awake[i];
+    if (extentDistance(record.enemy->getPosition()) > sleepRadius) {
+      sleep(i, true, std::numeric_limits<double>::infinity());
+      continue;
+    }
+
+    // Resting time isn't owed: the next tick starts fresh, as after a wake
+    if (record.restUntil > time) {
+      record.pendingTime = 0.0f;
+      stats.resting++;
+      if (skip) skip(*record.enemy);
+      i++;
+      continue;
+    }
+
+    record.pendingTime += deltaTime;
+    bool mid = focusDistance(record.enemy->getPosition()) > nearRadius;
+    if (mid && (steps + record.phase) % MID_INTERVAL != 0) {
+      if (skip) skip(*record.enemy);
+      i++;
+      continue;
+    }
+
+    float step = std::min(record.pendingTime, MAX_TICK);
+    record.pendingTime = 0.0f;
+    tick(*record.enemy, step);
+    tickedEnemies.push_back(record.enemy.get());
+    stats.ticked++;
+    i++;
+  }
+}
+
+void EnemySimulation::restIdle() {
+  for (Enemy* enemy : tickedEnemies) {
+    if (!enemy->asleep && enemy->isIdle()) awake[enemy->simulationSlot].restUntil = time + IDLE_RECHECK;
+  }
+  tickedEnemies.clear();
+}
+
+void EnemySimulation::damage(Enemy& enemy, int amount) {
+  enemy.takeDamage(amount);
+  if (enemy.asleep) {
+    wake(enemy.simulationSlot);
+  } else {
+    awake[enemy.simulationSlot].restUntil = 0.0;
+  }
+}
+
+void EnemySimulation::sleepFor(Enemy& enemy, float seconds) {
+  if (!enemy.asleep) {
+    sleep(enemy.simulationSlot, false, time + seconds);
+    return;
+  }
+
+  Record& record = sleeping[enemy.simulationSlot];
+  record.ticket = nextTicket++;
+  record.wakesOnProximity = false;
+  record.wakeTime = time + seconds;
+  schedule(enemy.simulationSlot);
+}
+
+void EnemySimulation::wake(Enemy& enemy) {
+  if (enemy.asleep) wake(enemy.simulationSlot);
+}
+
+void EnemySimulation::removeInactive() {
+  tickedEnemies.clear();
+
+  for (size_t i = 0; i < awake.size();) {
+    if (awake[i].enemy->getIsActive()) {
+      i++;
+    } else {
+      takeAwake(i);
+    }
+  }
+
+  for (size_t i = 0; i < sleeping.size();) {
+    if (sleeping[i].enemy->getIsActive()) {
+      i++;
+    } else {
+      takeSleeping(i);
+    }
+  }
+}
+
+void EnemySimulation::clear() {
+  tickedEnemies.clear();
+  awake.clear();
+  sleeping.clear();
+  proximityWakes = WakeHeap();
+  timerWakes = WakeHeap();
+}
+
+int EnemySimulation::size() const {
+  return static_cast<int>(awake.size() + sleeping.size());
+}
+
+Enemy& EnemySimulation::get(int index) const {
+  size_t slot = static_cast<size_t>(index);
+  if (slot < awake.size()) return *awake[slot].enemy;
+  return *sleeping[slot - awake.size()].enemy;
+}
+
+EnemySimulation::Stats EnemySimulation::getStats() const {
+  Stats result = stats;
+  result.awake = static_cast<int>(awake.size());
+  result.sleeping = static_cast<int>(sleeping.size());
+  return result;
+}
+
+float EnemySimulation::focusDistance(const Vector2& position) const {
+  // Without a focus point everything counts as near
+  if (focus.empty()) return 0.0f;
+
+  float nearest = std::numeric_limits<float>::max();
+  for (const Focus& point : focus) {
+    nearest = std::min(nearest, (position - point.position).length());
+  }
+  return nearest;
+}
+
+float EnemySimulation::extentDistance(const Vector2& position) const {
+  if (focus.empty()) return 0.0f;
+
+  // Negative inside an extent
+  float nearest = std::numeric_limits<float>::max();
+  for (const Focus& point : focus) {
+    nearest = std::min(nearest, (position - point.position).length() - point.extent);
+  }
+  return nearest;
+}
+
+void EnemySimulation::updateFocus(const std::vector<Focus>& focusPoints) {
+  focusCountChanged = focusPoints.size() != focus.size();
+
+  // The nearest extent can't get closer to a sleeper than the fastest
+  // focus point moved plus how much its extent grew
+  if (!focusCountChanged) {
+    float travel = 0.0f;
+    for (size_t i = 0; i < focus.size(); i++) {
+      float moved = (focusPoints[i].position - focus[i].position).length();
+      travel = std::max(travel, moved + std::max(0.0f, focusPoints[i].extent - focus[i].extent));
+    }
+    focusTravel += travel;
+  }
+
+  focus = focusPoints;
+}
+
+EnemySimulation::Record EnemySimulation::takeAwake(size_t slot) {
+  Record record = std::move(awake[slot]);
+  if (slot + 1 != awake.size()) {
+    awake[slot] = std::move(awake.back());
+    awake[slot].enemy->simulationSlot = slot;
+  }
+  awake.pop_back();
+  return record;
+}
+
+EnemySimulation::Record EnemySimulation::takeSleeping(size_t slot) {
+  Record record = std::move(sleeping[slot]);
+  if (slot + 1 != sleeping.size()) {
+    sleeping[slot] = std::move(sleeping.back());
+    sleeping[slot].enemy->simulationSlot = slot;
+    sleeping[slot].ticket = nextTicket++;
+    schedule(slot);
+  }
+  sleeping.pop_back();
+  return record;
+}
+
+void EnemySimulation::sleep(size_t awakeSlot, bool wakesOnProximity, double wakeTime) {
+  Record record = takeAwake(awakeSlot);
+  record.pendingTime = 0.0f;
+  record.ticket = nextTicket++;
+  record.wakesOnProximity = wakesOnProximity;
+  record.wakeTime = wakeTime;
+  if (wakesOnProximity) {
+    float distance = extentDistance(record.enemy->getPosition());
+    record.recheckTravel = focusTravel + std::max(0.0f, distance - wakeRadius);
+  }
+
+  record.enemy->asleep = true;
+  record.enemy->simulationSlot = sleeping.size();
+  sleeping.push_back(std::move(record));
+  schedule(sleeping.size() - 1);
+}
+
+void EnemySimulation::wake(size_t sleepingSlot) {
+  Record record = takeSleeping(sleepingSlot);
+  record.pendingTime = 0.0f;
+  record.restUntil = 0.0;
+  record.enemy->asleep = false;
+  record.enemy->simulationSlot = awake.size();
+  awake.push_back(std::move(record));
+  stats.woken++;
+}
+
+void EnemySimulation::schedule(size_t sleepingSlot) {
+  const Record& record = sleeping[sleepingSlot];
+  if (record.wakesOnProximity) {
+    proximityWakes.push(WakeEntry{ record.recheckTravel, sleepingSlot, record.ticket });
+  }
+  if (record.wakeTime != std::numeric_limits<double>::infinity()) {
+    timerWakes.push(WakeEntry{ record.wakeTime, sleepingSlot, record.ticket });
+  }
+}
+
+void EnemySimulation::compactWakes() {
+  proximityWakes = WakeHeap();
+  timerWakes = WakeHeap();
+  for (size_t i = 0; i < sleeping.size(); i++) {
+    schedule(i);
+  }
+}
+
+void EnemySimulation::popDue(WakeHeap& heap, double limit) {
+  dueWakes.clear();
+  while (!heap.empty() && heap.top().key <= limit) {
+    dueWakes.push_back(heap.top());
+    heap.pop();
+  }
+}
+
+bool EnemySimulation::isCurrent(const WakeEntry& entry) const {
+  return entry.slot < sleeping.size() && sleeping[entry.slot].ticket == entry.ticket;
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <functional>
+#include <queue>
+
+#include "Common.h"
+#include "Enemy.h"
+#include "Vector2.h"
+
+// Simulation level of detail for enemies.
+//
+// Distance to the nearest focus point (the player, each view's camera)
+// picks a tier:
+//  - near: ticks every step
+//  - mid: ticks every MID_INTERVAL steps with the time it skipped (capped
+//    at MAX_TICK), staggered so each step ticks a share of them
+//  - far: sleeps
+// The sleep and wake radii are measured from the edge of a focus point's
+// extent (a view's half-diagonal), so they grow as a view zooms out and
+// nothing in view sleeps.
+// Idle enemies (at their target once restIdle runs) rest: they stay awake
+// but skip their ticks like a mid-tier enemy does, so per-step structures
+// built through the skip callback (the crowd) still see them, until
+// IDLE_RECHECK passes or they're damaged.
+//
+// Awake and sleeping enemies live in separate dense lists, so a step only
+// walks the awake ones. A sleeper wakes when damaged, when its timer fires
+// or, if it fell asleep far away, when a focus point comes within
+// wakeRadius. Proximity isn't polled: the simulation keeps a running total
+// of how far the fastest focus point moved, and a sleeper is only rechecked
+// once that total has grown by its distance to the wake radius (extents
+// count towards the travel as they change). Timers and
+// rechecks come off heaps, so a step costs the awake enemies plus the
+// sleepers that are due, however many enemies the world holds.
+class EnemySimulation {
+  public:
+    struct Stats {
+      int awake;
+      int ticked;     // Enemies updated in the last step
+      int resting;    // Awake but idle in the last step
+      int sleeping;
+      int woken;      // In the last step
+    };
+
+    struct Focus {
+      Vector2 position;
+      float extent;  // Added to the sleep and wake radii
+    };
+
+    // Called for each enemy that ticks, with the time it covers
+    using TickFunction = std::function<void(Enemy&, float)>;
+
+    // Called for each awake enemy that doesn't tick this step
+    using SkipFunction = std::function<void(Enemy&)>;
+
+  private:
+    struct Record {
+      std::unique_ptr<Enemy> enemy;
+
+      // Awake
+      float pendingTime;  // Mid tier: time since the last tick
+      int phase;          // Mid tier: which step of MID_INTERVAL it ticks on
+      double restUntil;   // Idle: skipped until then
+
+      // Sleeping; heap entries carrying another ticket are stale
+      uint64_t ticket;
+      bool wakesOnProximity;
+      double recheckTravel;  // Focus travel at which to recheck the distance
+      double wakeTime;       // Or infinity
+    };
+
+    struct WakeEntry {
+      double key;
+      size_t slot;
+      uint64_t ticket;
+
+      bool operator>(const WakeEntry& other) const { return key > other.key; }
+    };
+    using WakeHeap = std::priority_queue<WakeEntry, std::vector<WakeEntry>, std::greater<WakeEntry>>;
+
+    std::vector<Record> awake;
+    std::vector<Record> sleeping;
+    WakeHeap proximityWakes;
+    WakeHeap timerWakes;
+    std::vector<WakeEntry> dueWakes;
+
+    // Ticked in the last update, for restIdle
+    std::vector<Enemy*> tickedEnemies;
+
+    float nearRadius;
+    float sleepRadius;
+    float wakeRadius;
+
+    std::vector<Focus> focus;
+    double focusTravel;
+    bool focusCountChanged;
+
+    double time;
+    uint64_t steps;
+    uint64_t nextTicket;
+    int nextPhase;
+
+    Stats stats;
+
+    // To the nearest focus point, and past the nearest focus extent (what
+    // the sleep and wake radii are compared with)
+    float focusDistance(const Vector2& position) const;
+    float extentDistance(const Vector2& position) const;
+    void updateFocus(const std::vector<Focus>& focusPoints);
+
+    // Swap-remove; the moved record gets its new slot (and, asleep, a new
+    // ticket and heap entries)
+    Record takeAwake(size_t slot);
+    Record takeSleeping(size_t slot);
+
+    void sleep(size_t awakeSlot, bool wakesOnProximity, double wakeTime);
+    void wake(size_t sleepingSlot);
+    void schedule(size_t sleepingSlot);
+
+    // Stale entries pile up while their keys aren't due; past a multiple of
+    // the sleepers, the heaps are rebuilt from the records
+    void compactWakes();
+
+    // Pops everything due first, so entries pushed meanwhile wait a step
+    void popDue(WakeHeap& heap, double limit);
+    bool isCurrent(const WakeEntry& entry) const;
+
+  public:
+    static const int MID_INTERVAL = 4;
+    static constexpr float MAX_TICK = 0.25f;
+    static constexpr float IDLE_RECHECK = 0.5f;
+
+    // Near within nearRadius, asleep beyond sleepRadius past the extents;
+    // far sleepers wake within wakeRadius (smaller, so the border doesn't
+    // flicker)
+    EnemySimulation(float nearRadius = 480.0f, float sleepRadius = 900.0f, float wakeRadius = 500.0f);
+
+    // Starts awake
+    void add(std::unique_ptr<Enemy> enemy);
+
+    // Advances time, wakes what's due and ticks the awake enemies. `skip`
+    // sees the awake ones that don't tick, resting ones included (to keep
+    // them in per-step structures). Neither may add, wake, damage or put
+    // enemies to sleep.
+    void update(float deltaTime, const std::vector<Focus>& focusPoints, const TickFunction& tick,
+                const SkipFunction& skip = nullptr);
+
+    // Rests the enemies ticked by the last update that are now idle. Call
+    // once their motion for the step is final: right after update, or after
+    // a crowd step moved them.
+    void restIdle();
+
+    // Damages the enemy and wakes it
+    void damage(Enemy& enemy, int amount);
+
+    // Sleeps until the timer or damage, whatever the distance
+    void sleepFor(Enemy& enemy, float seconds);
+    void wake(Enemy& enemy);
+
+    // Drops deactivated enemies, awake or not
+    void removeInactive();
+    void clear();
+
+    // Awake enemies first, then sleeping ones
+    int size() const;
+    Enemy& get(int index) const;
+
+    Stats getStats() const;
+};
@@ -5,16 +5,18 @@ Entity::Entity(const std::string& name, float x, float y) {
   this->name = name;
   this->position = Vector2(x, y);
   this->isActive = true;
+  this->layer = 0;
+  this->depth = 0.0f;
+  this->translucent = false;
 }
 
 void Entity::update(float deltaTime) {
   (void)deltaTime;
 }
 
-void Entity::render(Shader& shader, const Camera& camera) {
+void Entity::render(SpriteBatch& batch) {
   // Base implementation does nothing
-  (void)shader;
-  (void)camera;
+  (void)batch;
 }
 
 void Entity::printInfo() const {
@@ -38,6 +40,22 @@ bool Entity::getIsActive() const {
   return isActive;
 }
 
+int Entity::getLayer() const {
+  return layer;
+}
+
+bool Entity::isTranslucent() const {
+  return translucent;
+}
+
+float Entity::getDepthY() const {
+  return position.y;
+}
+
+const Sprite* Entity::getSprite() const {
+  return nullptr;
+}
+
 void Entity::setPosition(const Vector2& newPosition) {
   position = newPosition;
 }
@@ -45,3 +63,15 @@ void Entity::setPosition(const Vector2& newPosition) {
 void Entity::setActive(bool active) {
   isActive = active;
 }
+
+void Entity::setLayer(int newLayer) {
+  layer = newLayer;
+}
+
+void Entity::setDepth(float newDepth) {
+  depth = newDepth;
+}
+
+void Entity::setTranslucent(bool value) {
+  translucent = value;
+}
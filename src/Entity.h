@@ -4,8 +4,8 @@
 #include "Common.h"
 #include "Vector2.h"
 
-class Camera;
-class Shader;
+class Sprite;
+class SpriteBatch;
 
 class Entity {
 protected:
@@ -13,13 +13,22 @@ protected:
   Vector2 position;
   bool isActive;
 
+  // Draw layer; within a layer lower y draws first
+  int layer;
+
+  // Depth for this frame, assigned by the renderer from layer and y
+  float depth;
+
+  // Translucent entities skip the depth-tested cutout pass
+  bool translucent;
+
 public:
   // Constructor declaration
   Entity(const std::string& name, float x, float y);
   virtual ~Entity() = default;
 
   virtual void update(float deltaTime);
-  virtual void render(Shader& shader, const Camera& camera);
+  virtual void render(SpriteBatch& batch);
 
   void printInfo() const;
 
@@ -27,8 +36,19 @@ public:
   std::string getName() const;
   Vector2 getPosition() const;
   bool getIsActive() const;
+  int getLayer() const;
+  bool isTranslucent() const;
+
+  // Y used for depth sorting (where the entity touches the ground)
+  virtual float getDepthY() const;
+
+  // Current frame, for icons drawn outside the world (minimap markers)
+  virtual const Sprite* getSprite() const;
 
   // Setters
   void setPosition(const Vector2& newPosition);
   void setActive(bool active);
+  void setLayer(int newLayer);
+  void setDepth(float newDepth);
+  void setTranslucent(bool value);
 };
@@ -0,0 +1,240 @@
+#include "FogOfWar.h"
+#include <algorithm>
+
+namespace {
+  const uint8_t FOG_HIDDEN = 0;
+  const uint8_t FOG_EXPLORED = 128;
+  const uint8_t FOG_VISIBLE = 255;
+
+  // Octant transforms for shadowcasting: (xx, xy, yx, yy)
+  const int OCTANTS[8][4] = {
+    { 1,  0,  0,  1}, { 0,  1,  1,  0}, { 0, -1,  1,  0}, {-1,  0,  0,  1},
+    {-1,  0,  0, -1}, { 0, -1, -1,  0}, { 0,  1, -1,  0}, { 1,  0,  0, -1},
+  };
+}
+
+FogOfWar::FogOfWar(const Tilemap* tilemap)
+  : tilemap(tilemap),
+    width(tilemap->getTileCountX()),
+    height(tilemap->getTileCountY()),
+    seenRevision(tilemap->getRevision()),
+    dirtyX0(0),
+    dirtyY0(0),
+    dirtyX1(0),
+    dirtyY1(0)
+{
+  visibleCount.resize(width * height, 0);
+  explored.resize((width * height + 63) / 64, 0);
+
+  // Linear filtering (the default) softens the fog edge across tile
+  // boundaries. Starts all hidden, which is all zeros.
+  mask = std::make_unique<DynamicTexture>(width, height, DynamicTexture::Format::R8);
+}
+
+void FogOfWar::setViewer(int id, const Vector2& worldPosition, int radiusTiles) {
+  int tileSize = tilemap->getTileSize();
+  int tileX = static_cast<int>(std::floor(worldPosition.x / tileSize));
+  int tileY = static_cast<int>(std::floor(worldPosition.y / tileSize));
+
+  auto it = viewers.find(id);
+  if (it == viewers.end()) {
+    if (viewers.size() >= MAX_VIEWERS) {
+      std::cerr << "FogOfWar: more than " << MAX_VIEWERS << " viewers" << std::endl;
+      return;
+    }
+    viewers[id] = Viewer{tileX, tileY, radiusTiles, true, {}};
+    return;
+  }
+
+  Viewer& viewer = it->second;
+  if (viewer.tileX == tileX && viewer.tileY == tileY && viewer.radius == radiusTiles) return;
+
+  // Old view area goes dark again
+  markDirty(viewer.tileX - viewer.radius, viewer.tileY - viewer.radius,
+            viewer.tileX + viewer.radius + 1, viewer.tileY + viewer.radius + 1);
+
+  viewer.tileX = tileX;
+  viewer.tileY = tileY;
+  viewer.radius = radiusTiles;
+  viewer.moved = true;
+}
+
+void FogOfWar::removeViewer(int id) {
+  auto it = viewers.find(id);
+  if (it == viewers.end()) return;
+
+  Viewer& viewer = it->second;
+  for (int index : viewer.visible) {
+    visibleCount[index]--;
+  }
+
+  markDirty(viewer.tileX - viewer.radius, viewer.tileY - viewer.radius,
+            viewer.tileX + viewer.radius + 1, viewer.tileY + viewer.radius + 1);
+  viewers.erase(it);
+}
+
+void FogOfWar::update() {
+  // Walls may have changed under a viewer: recompute everyone (still local)
+  bool mapChanged = tilemap->getRevision() != seenRevision;
+  seenRevision = tilemap->getRevision();
+
+  for (auto& [id, viewer] : viewers) {
+    if (viewer.moved || mapChanged) {
+      recompute(viewer);
+    }
+  }
+
+  upload();
+}
+
+void FogOfWar::recompute(Viewer& viewer) {
+  for (int index : viewer.visible) {
+    visibleCount[index]--;
+  }
+  viewer.visible.clear();
+
+  reveal(viewer, viewer.tileX, viewer.tileY);
+  for (const auto& octant : OCTANTS) {
+    castLight(viewer, 1, 1.0f, 0.0f, octant[0], octant[1], octant[2], octant[3]);
+  }
+
+  // Octant edges are visited twice
+  std::sort(viewer.visible.begin(), viewer.visible.end());
+  viewer.visible.erase(std::unique(viewer.visible.begin(), viewer.visible.end()),
+                       viewer.visible.end());
+
+  for (int index : viewer.visible) {
+    visibleCount[index]++;
+    explored[index / 64] |= uint64_t(1) << (index % 64);
+  }
+
+  markDirty(viewer.tileX - viewer.radius, viewer.tileY - viewer.radius,
+            viewer.tileX + viewer.radius + 1, viewer.tileY + viewer.radius + 1);
+  viewer.moved = false;
+}
+
+void FogOfWar::castLight(Viewer& viewer, int row, float start, float end,
+                         int xx, int xy, int yx, int yy) {
+  // Recursive shadowcasting over one octant: scan rows outward, narrowing
+  // the [start, end] slope window behind solid tiles
+  if (start < end) return;
+
+  int radius = viewer.radius;
+  float newStart = 0.0f;
+  bool blocked = false;
+
+  for (int distance = row; distance <= radius && !blocked; distance++) {
+    int dy = -distance;
+
+    for (int dx = -distance; dx <= 0; dx++) {
+      float leftSlope = (dx - 0.5f) / (dy + 0.5f);
+      float rightSlope = (dx + 0.5f) / (dy - 0.5f);
+
+      if (start < rightSlope) continue;
+      if (end > leftSlope) break;
+
+      int x = viewer.tileX + dx * xx + dy * xy;
+      int y = viewer.tileY + dx * yx + dy * yy;
+      bool inside = x >= 0 && y >= 0 && x < width && y < height;
+
+      if (inside && dx * dx + dy * dy <= radius * radius) {
+        reveal(viewer, x, y);
+      }
+
+      // Off the map blocks sight like a wall
+      bool solid = !inside || tilemap->isSolid(x, y);
+
+      if (blocked) {
+        if (solid) {
+          newStart = rightSlope;
+          continue;
+        }
+        blocked = false;
+        start = newStart;
+      } else if (solid && distance < radius) {
+        blocked = true;
+        castLight(viewer, distance + 1, start, leftSlope, xx, xy, yx, yy);
+        newStart = rightSlope;
+      }
+    }
+  }
+}
+
+void FogOfWar::reveal(Viewer& viewer, int x, int y) {
+  if (x < 0 || y < 0 || x >= width || y >= height) return;
+  viewer.visible.push_back(y * width + x);
+}
+
+void FogOfWar::markDirty(int x0, int y0, int x1, int y1) {
+  x0 = std::max(x0, 0);
+  y0 = std::max(y0, 0);
+  x1 = std::min(x1, width);
+  y1 = std::min(y1, height);
+  if (x0 >= x1 || y0 >= y1) return;
+
+  if (dirtyX0 >= dirtyX1) {
+    dirtyX0 = x0;
+    dirtyY0 = y0;
+    dirtyX1 = x1;
+    dirtyY1 = y1;
+    return;
+  }
+
+  dirtyX0 = std::min(dirtyX0, x0);
+  dirtyY0 = std::min(dirtyY0, y0);
+  dirtyX1 = std::max(dirtyX1, x1);
+  dirtyY1 = std::max(dirtyY1, y1);
+}
+
+void FogOfWar::upload() {
+  // Refresh the CPU copy of what changed; the mask streams it out
+  if (dirtyX0 < dirtyX1) {
+    uint8_t* texels = mask->getPixels();
+
+    for (int y = dirtyY0; y < dirtyY1; y++) {
+      int index = y * width + dirtyX0;
+
+      for (int x = dirtyX0; x < dirtyX1; x++, index++) {
+        if (visibleCount[index] > 0) {
+          texels[index] = FOG_VISIBLE;
+        } else {
+          texels[index] = isExploredIndex(index) ? FOG_EXPLORED : FOG_HIDDEN;
+        }
+      }
+    }
+
+    mask->markDirty(dirtyX0, dirtyY0, dirtyX1, dirtyY1);
+    dirtyX0 = dirtyX1 = 0;
+    dirtyY0 = dirtyY1 = 0;
+  }
+
+  // Also finishes whatever last frame's budget left over
+  mask->upload();
+}
+
+void FogOfWar::bind(GLuint slot) {
+  mask->bind(slot);
+}
+
+bool FogOfWar::isExploredIndex(int index) const {
+  return (explored[index / 64] >> (index % 64)) & 1;
+}
+
+bool FogOfWar::isVisible(int tileX, int tileY) const {
+  if (tileX < 0 || tileY < 0 || tileX >= width || tileY >= height) return false;
+  return visibleCount[tileY * width + tileX] > 0;
+}
+
+bool FogOfWar::isExplored(int tileX, int tileY) const {
+  if (tileX < 0 || tileY < 0 || tileX >= width || tileY >= height) return false;
+  return isExploredIndex(tileY * width + tileX);
+}
+
+int FogOfWar::getTexelsUploaded() const {
+  return mask->getTexelsUploaded();
+}
+
+glm::vec2 FogOfWar::getWorldToUV() const {
+  float tileSize = static_cast<float>(tilemap->getTileSize());
+  return glm::vec2(1.0f / (width * tileSize), 1.0f / (height * tileSize));
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <map>
+
+#include "Common.h"
+#include "DynamicTexture.h"
+#include "Tilemap.h"
+#include "Vector2.h"
+
+// Explored/visible mask for a tilemap, one R8 texel per tile:
+// 0 = never seen, 128 = explored, 255 = currently visible.
+//
+// Visibility is recomputed only for viewers that moved to another tile,
+// with recursive shadowcasting against Tilemap::isSolid, so the cost scales
+// with viewer radius rather than map size. Only the rectangle each update
+// touched is re-uploaded, streamed through a DynamicTexture.
+class FogOfWar {
+  private:
+    struct Viewer {
+      int tileX, tileY;
+      int radius;
+      bool moved;
+      std::vector<int> visible;  // Tile indices this viewer currently sees
+    };
+
+    const Tilemap* tilemap;
+    int width;
+    int height;
+    uint64_t seenRevision;
+
+    std::map<int, Viewer> viewers;
+
+    // How many viewers see each tile, so overlapping views can come and go.
+    // 16 bits: crowds of viewers (units, torches) can overlap past 255.
+    std::vector<uint16_t> visibleCount;
+    std::vector<uint64_t> explored;
+
+    std::unique_ptr<DynamicTexture> mask;
+
+    // Texels to refresh in the mask, in tiles (exclusive max); empty when x0 >= x1
+    int dirtyX0, dirtyY0, dirtyX1, dirtyY1;
+
+    void recompute(Viewer& viewer);
+    void castLight(Viewer& viewer, int row, float start, float end,
+                   int xx, int xy, int yx, int yy);
+    void reveal(Viewer& viewer, int x, int y);
+    void markDirty(int x0, int y0, int x1, int y1);
+    void upload();
+
+    bool isExploredIndex(int index) const;
+
+  public:
+    // What visibleCount can count; more viewers are refused
+    static const size_t MAX_VIEWERS = 0xFFFF;
+
+    FogOfWar(const Tilemap* tilemap);
+
+    // Adds or moves a viewer; cheap when it stays on the same tile
+    void setViewer(int id, const Vector2& worldPosition, int radiusTiles);
+    void removeViewer(int id);
+
+    // Recomputes moved viewers and uploads the changed part of the mask
+    void update();
+
+    void bind(GLuint slot);
+
+    // Queries
+    bool isVisible(int tileX, int tileY) const;
+    bool isExplored(int tileX, int tileY) const;
+
+    // Getters
+    int getTexelsUploaded() const;
+    glm::vec2 getWorldToUV() const;
+};
@@ -0,0 +1,859 @@
+#include "GLCapture.h"
+#include "Common.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace GLCapture {
+
+  namespace {
+    // Every hooked loader entry point: name without the gl prefix
+    #define CAPTURE_HOOKS(X) \
+      X(GenBuffers) X(DeleteBuffers) X(GenTextures) X(DeleteTextures) \
+      X(GenVertexArrays) X(DeleteVertexArrays) X(GenFramebuffers) X(DeleteFramebuffers) \
+      X(GenRenderbuffers) X(DeleteRenderbuffers) \
+      X(CreateShader) X(ShaderSource) X(CompileShader) X(DeleteShader) \
+      X(CreateProgram) X(AttachShader) X(LinkProgram) X(DeleteProgram) X(UseProgram) \
+      X(GetUniformLocation) X(GetUniformBlockIndex) X(UniformBlockBinding) \
+      X(Uniform1i) X(Uniform1ui) X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) \
+      X(Uniform2fv) X(Uniform4fv) X(UniformMatrix4fv) \
+      X(BindBuffer) X(BindBufferBase) X(BufferData) X(BufferSubData) \
+      X(MapBufferRange) X(UnmapBuffer) \
+      X(ActiveTexture) X(BindTexture) X(TexParameteri) X(TexParameterfv) X(PixelStorei) \
+      X(TexImage2D) X(TexSubImage2D) X(TexImage3D) X(CopyTexSubImage3D) X(GenerateMipmap) \
+      X(BindVertexArray) X(VertexAttribPointer) X(VertexAttribIPointer) \
+      X(EnableVertexAttribArray) X(VertexAttribDivisor) X(VertexAttribI4ui) \
+      X(BindFramebuffer) X(FramebufferTexture2D) X(FramebufferTextureLayer) \
+      X(FramebufferRenderbuffer) X(BindRenderbuffer) X(RenderbufferStorage) \
+      X(Enable) X(Disable) X(BlendFunc) X(DepthFunc) X(DepthMask) X(Viewport) X(ClearColor) \
+      X(Scissor) \
+      X(Clear) X(BlitFramebuffer) X(DrawArrays) X(DrawElements) X(DrawElementsInstanced) \
+      X(DrawElementsIndirect) X(MultiDrawElementsIndirect) X(DispatchCompute) X(MemoryBarrier) \
+      X(DrawElementsBaseVertex)
+
+    #define DECLARE_REAL(name) decltype(glad_gl##name) real##name = nullptr;
+    CAPTURE_HOOKS(DECLARE_REAL)
+    #undef DECLARE_REAL
+
+    // An open glMapBufferRange, copied into the stream on unmap
+    struct Mapping {
+      GLenum target;
+      GLintptr offset;
+      GLsizeiptr length;
+      GLbitfield access;
+      void* pointer;
+    };
+
+    // A pre-roll upload and the part of its object it wrote
+    struct Upload {
+      size_t begin;   // The record's bytes in the stream
+      size_t end;
+      int level;
+      int64_t x, y, width, height;  // Buffers: offset, 0, size, 1
+      bool whole;     // Respecifies the level (glBufferData, glTexImage*)
+      int source;     // Buffer upload an image upload read, or -1
+      int readers;    // Live image uploads reading this one
+      bool superseded;
+      bool dead;
+    };
+
+    std::string outputPath;
+    int framesToCapture = 0;
+    int framesToSkip = 0;
+    bool requested = false;
+    bool installed = false;
+    bool recording = false;
+    bool triggered = false;
+    int frameIndex = 0;
+    int framesCaptured = 0;
+
+    Header header;
+    std::vector<uint8_t> stream;
+    std::vector<Mapping> mappings;
+
+    // Client state that decides how many bytes an upload reads
+    GLint unpackAlignment = 4;
+    GLint unpackRowLength = 0;
+
+    // Bindings uploads go through
+    std::unordered_map<GLenum, GLuint> boundBuffers;
+    std::unordered_map<GLuint, GLuint> elementBuffers;  // Per vertex array
+    GLuint boundVertexArray = 0;
+    GLenum activeTexture = GL_TEXTURE0;
+    std::unordered_map<uint64_t, GLuint> boundTextures;  // (unit, target) -> texture
+
+    // Pre-roll uploads since the last time something read them. Once a later
+    // upload covers one and no image upload still reads it, its record is
+    // dropped from the stream, so skipped frames don't pile up contents.
+    std::vector<Upload> uploads;
+    std::unordered_map<uint64_t, std::vector<int>> liveUploads;  // Object -> uncovered uploads
+    std::vector<std::pair<size_t, size_t>> deadRanges;
+    size_t deadBytes = 0;
+
+    int persistentPasses = 0;
+
+    int64_t floatArg(float value) {
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    int64_t pointerArg(const void* pointer) {
+      return static_cast<int64_t>(reinterpret_cast<intptr_t>(pointer));
+    }
+
+    bool isWork(Op op) {
+      return op >= Op::CLEAR && op < Op::COUNT;
+    }
+
+    // GPU-side reads of buffer or texture contents
+    bool readsContents(Op op) {
+      return isWork(op) || op == Op::COPY_TEX_SUB_IMAGE_3D || op == Op::GENERATE_MIPMAP;
+    }
+
+    GLuint boundBuffer(GLenum target) {
+      return target == GL_ELEMENT_ARRAY_BUFFER ? elementBuffers[boundVertexArray] : boundBuffers[target];
+    }
+
+    void bindBuffer(GLenum target, GLuint buffer) {
+      if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        elementBuffers[boundVertexArray] = buffer;
+      } else {
+        boundBuffers[target] = buffer;
+      }
+    }
+
+    uint64_t textureBinding(GLenum unit, GLenum target) {
+      return (static_cast<uint64_t>(unit) << 32) | target;
+    }
+
+    // Tracked objects: buffers by name, textures with bit 32 set; 0 is none
+    uint64_t bufferObject(GLuint buffer) {
+      return buffer;
+    }
+
+    uint64_t textureObject(GLenum target) {
+      GLuint texture = boundTextures[textureBinding(activeTexture, target)];
+      return texture != 0 ? (static_cast<uint64_t>(1) << 32) | texture : 0;
+    }
+
+    // Whether `outer` overwrites everything `inner` wrote
+    bool covers(const Upload& outer, const Upload& inner) {
+      if (outer.level != inner.level) return false;
+      if (outer.whole) return true;
+      if (inner.whole) return false;  // Storage has to stay specified
+      return inner.x >= outer.x && inner.y >= outer.y &&
+             inner.x + inner.width <= outer.x + outer.width &&
+             inner.y + inner.height <= outer.y + outer.height;
+    }
+
+    void drop(int index) {
+      Upload& upload = uploads[index];
+      upload.dead = true;
+      deadRanges.push_back({ upload.begin, upload.end });
+      deadBytes += upload.end - upload.begin;
+
+      // Its source may only have been kept for it
+      if (upload.source >= 0) {
+        Upload& source = uploads[upload.source];
+        if (--source.readers == 0 && source.superseded) drop(upload.source);
+      }
+    }
+
+    void supersede(int index) {
+      uploads[index].superseded = true;
+      if (uploads[index].readers == 0) drop(index);
+    }
+
+    // Something read the tracked contents: everything so far stays
+    void keepUploads() {
+      uploads.clear();
+      liveUploads.clear();
+    }
+
+    // The object is gone, and nothing read its pending contents
+    void forgetObject(uint64_t object) {
+      auto it = liveUploads.find(object);
+      if (it == liveUploads.end()) return;
+
+      for (int index : it->second) supersede(index);
+      liveUploads.erase(it);
+    }
+
+    // Slides the live records down over the dropped ones
+    void compact() {
+      if (deadRanges.empty()) return;
+      std::sort(deadRanges.begin(), deadRanges.end());
+
+      std::vector<size_t> removedThrough;  // Dead bytes up to each range's end
+      size_t write = deadRanges.front().first;
+      size_t removed = 0;
+      for (size_t i = 0; i < deadRanges.size(); i++) {
+        size_t liveBegin = deadRanges[i].second;
+        size_t liveEnd = i + 1 < deadRanges.size() ? deadRanges[i + 1].first : stream.size();
+        std::memmove(stream.data() + write, stream.data() + liveBegin, liveEnd - liveBegin);
+        write += liveEnd - liveBegin;
+
+        removed += deadRanges[i].second - deadRanges[i].first;
+        removedThrough.push_back(removed);
+      }
+      stream.resize(write);
+
+      for (Upload& upload : uploads) {
+        if (upload.dead) continue;
+        size_t before = std::lower_bound(deadRanges.begin(), deadRanges.end(),
+                                         std::make_pair(upload.begin, size_t(0))) - deadRanges.begin();
+        size_t shift = before > 0 ? removedThrough[before - 1] : 0;
+        upload.begin -= shift;
+        upload.end -= shift;
+      }
+
+      deadRanges.clear();
+      deadBytes = 0;
+    }
+
+    void compactIfSparse() {
+      if (deadBytes > stream.size() / 2) compact();
+    }
+
+    template <typename T>
+    void put(const T& value) {
+      const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+      stream.insert(stream.end(), bytes, bytes + sizeof(T));
+    }
+
+    void record(Op op, const std::vector<int64_t>& args,
+                const void* blob = nullptr, size_t blobSize = 0) {
+      // The pre-roll only has to rebuild state, not pixels
+      if (!recording && isWork(op) && persistentPasses == 0) return;
+      if (!recording && readsContents(op)) keepUploads();
+
+      put(static_cast<uint16_t>(op));
+      put(static_cast<uint8_t>(args.size()));
+      for (int64_t arg : args) put(arg);
+
+      if (blob == nullptr) blobSize = 0;
+      put(static_cast<uint32_t>(blobSize));
+      const uint8_t* bytes = static_cast<const uint8_t*>(blob);
+      if (blobSize > 0) stream.insert(stream.end(), bytes, bytes + blobSize);
+    }
+
+    size_t componentsOf(GLenum format) {
+      switch (format) {
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: return 1;
+        case GL_RG: case GL_RG_INTEGER: return 2;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: return 3;
+        default: return 4;
+      }
+    }
+
+    size_t bytesPerPixel(GLenum format, GLenum type) {
+      switch (type) {
+        case GL_UNSIGNED_BYTE: case GL_BYTE: return componentsOf(format);
+        case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: return 2 * componentsOf(format);
+        case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: return 4 * componentsOf(format);
+        default: return 4;  // Packed formats: one 32-bit word per pixel
+      }
+    }
+
+    // Bytes an upload reads from client memory under the current unpack state
+    size_t imageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type) {
+      if (width <= 0 || height <= 0 || depth <= 0) return 0;
+
+      size_t pixel = bytesPerPixel(format, type);
+      size_t rowPixels = unpackRowLength > 0 ? unpackRowLength : width;
+      size_t alignment = static_cast<size_t>(unpackAlignment);
+      size_t rowBytes = (rowPixels * pixel + alignment - 1) / alignment * alignment;
+
+      // The last row only needs its own pixels
+      size_t rows = static_cast<size_t>(height) * depth;
+      return rowBytes * (rows - 1) + width * pixel;
+    }
+
+    // Records an upload to `object` (0: untracked); in the pre-roll, the
+    // earlier uploads it covers are dropped
+    void recordUpload(uint64_t object, Upload upload, Op op, const std::vector<int64_t>& args,
+                      const void* blob, size_t blobSize) {
+      upload.begin = stream.size();
+      record(op, args, blob, blobSize);
+      upload.end = stream.size();
+      if (recording || object == 0) return;
+
+      int index = static_cast<int>(uploads.size());
+      uploads.push_back(upload);
+      if (upload.source >= 0) uploads[upload.source].readers++;
+
+      std::vector<int>& live = liveUploads[object];
+      std::vector<int> uncovered;
+      for (int earlier : live) {
+        if (covers(uploads[index], uploads[earlier])) {
+          supersede(earlier);
+        } else {
+          uncovered.push_back(earlier);
+        }
+      }
+      uncovered.push_back(index);
+      live.swap(uncovered);
+
+      compactIfSparse();
+    }
+
+    Upload bufferUpload(int64_t offset, int64_t size, bool whole) {
+      return Upload{ 0, 0, 0, offset, 0, size, 1, whole, -1, 0, false, false };
+    }
+
+    Upload imageUpload(GLint level, int64_t x, int64_t y, int64_t width, int64_t height,
+                       bool whole, int source) {
+      return Upload{ 0, 0, level, x, y, width, height, whole, source, 0, false, false };
+    }
+
+    // The one buffer upload an image reads from the unpack buffer; when
+    // there isn't one, that buffer's pending uploads all stay
+    int unpackSource(int64_t offset, size_t bytes) {
+      auto it = liveUploads.find(bufferObject(boundBuffer(GL_PIXEL_UNPACK_BUFFER)));
+      if (recording || it == liveUploads.end()) return -1;
+
+      int source = -1;
+      int overlapping = 0;
+      int64_t end = offset + static_cast<int64_t>(bytes);
+      for (int index : it->second) {
+        const Upload& upload = uploads[index];
+        if (upload.x >= end || upload.x + upload.width <= offset) continue;
+        overlapping++;
+        if (upload.x <= offset && upload.x + upload.width >= end) source = index;
+      }
+
+      if (overlapping == 1 && source >= 0) return source;
+      liveUploads.erase(it);
+      return -1;
+    }
+
+    // Pixels from a bound unpack buffer are an offset, not client memory.
+    // Two extra args: (from buffer, offset).
+    void recordImage(Op op, std::vector<int64_t> args, GLenum target, Upload upload,
+                     const void* pixels, size_t bytes) {
+      bool fromBuffer = boundBuffer(GL_PIXEL_UNPACK_BUFFER) != 0;
+      args.push_back(fromBuffer);
+      args.push_back(fromBuffer ? pointerArg(pixels) : 0);
+      if (fromBuffer) upload.source = unpackSource(pointerArg(pixels), bytes);
+      recordUpload(textureObject(target), upload, op, args, fromBuffer ? nullptr : pixels, bytes);
+    }
+
+    // Deleting unbinds, and drops whatever was still pending in the pre-roll
+    void forgetBuffers(GLsizei n, const GLuint* names) {
+      for (GLsizei i = 0; i < n; i++) {
+        if (!recording) forgetObject(bufferObject(names[i]));
+        for (auto& binding : boundBuffers) {
+          if (binding.second == names[i]) binding.second = 0;
+        }
+        for (auto& binding : elementBuffers) {
+          if (binding.second == names[i]) binding.second = 0;
+        }
+      }
+      compactIfSparse();
+    }
+
+    void forgetTextures(GLsizei n, const GLuint* names) {
+      for (GLsizei i = 0; i < n; i++) {
+        if (!recording && names[i] != 0) forgetObject((static_cast<uint64_t>(1) << 32) | names[i]);
+        for (auto& binding : boundTextures) {
+          if (binding.second == names[i]) binding.second = 0;
+        }
+      }
+      compactIfSparse();
+    }
+
+    void recordNames(Op op, GLsizei n, const GLuint* names) {
+      record(op, { n }, names, n * sizeof(GLuint));
+    }
+
+    // Objects
+    void GLAD_API_PTR hookGenBuffers(GLsizei n, GLuint* names) {
+      realGenBuffers(n, names);
+      recordNames(Op::GEN_BUFFERS, n, names);
+    }
+    void GLAD_API_PTR hookDeleteBuffers(GLsizei n, const GLuint* names) {
+      recordNames(Op::DELETE_BUFFERS, n, names);
+      forgetBuffers(n, names);
+      realDeleteBuffers(n, names);
+    }
+    void GLAD_API_PTR hookGenTextures(GLsizei n, GLuint* names) {
+      realGenTextures(n, names);
+      recordNames(Op::GEN_TEXTURES, n, names);
+    }
+    void GLAD_API_PTR hookDeleteTextures(GLsizei n, const GLuint* names) {
+      recordNames(Op::DELETE_TEXTURES, n, names);
+      forgetTextures(n, names);
+      realDeleteTextures(n, names);
+    }
+    void GLAD_API_PTR hookGenVertexArrays(GLsizei n, GLuint* names) {
+      realGenVertexArrays(n, names);
+      recordNames(Op::GEN_VERTEX_ARRAYS, n, names);
+    }
+    void GLAD_API_PTR hookDeleteVertexArrays(GLsizei n, const GLuint* names) {
+      recordNames(Op::DELETE_VERTEX_ARRAYS, n, names);
+      realDeleteVertexArrays(n, names);
+    }
+    void GLAD_API_PTR hookGenFramebuffers(GLsizei n, GLuint* names) {
+      realGenFramebuffers(n, names);
+      recordNames(Op::GEN_FRAMEBUFFERS, n, names);
+    }
+    void GLAD_API_PTR hookDeleteFramebuffers(GLsizei n, const GLuint* names) {
+      recordNames(Op::DELETE_FRAMEBUFFERS, n, names);
+      realDeleteFramebuffers(n, names);
+    }
+    void GLAD_API_PTR hookGenRenderbuffers(GLsizei n, GLuint* names) {
+      realGenRenderbuffers(n, names);
+      recordNames(Op::GEN_RENDERBUFFERS, n, names);
+    }
+    void GLAD_API_PTR hookDeleteRenderbuffers(GLsizei n, const GLuint* names) {
+      recordNames(Op::DELETE_RENDERBUFFERS, n, names);
+      realDeleteRenderbuffers(n, names);
+    }
+
+    // Programs
+    GLuint GLAD_API_PTR hookCreateShader(GLenum type) {
+      GLuint shader = realCreateShader(type);
+      record(Op::CREATE_SHADER, { type, shader });
+      return shader;
+    }
+    void GLAD_API_PTR hookShaderSource(GLuint shader, GLsizei count,
+                                       const GLchar* const* strings, const GLint* lengths) {
+      // Concatenated into one string
+      std::string source;
+      for (GLsizei i = 0; i < count; i++) {
+        if (lengths != nullptr && lengths[i] >= 0) {
+          source.append(strings[i], lengths[i]);
+        } else {
+          source.append(strings[i]);
+        }
+      }
+      record(Op::SHADER_SOURCE, { shader }, source.data(), source.size());
+      realShaderSource(shader, count, strings, lengths);
+    }
+    void GLAD_API_PTR hookCompileShader(GLuint shader) {
+      record(Op::COMPILE_SHADER, { shader });
+      realCompileShader(shader);
+    }
+    void GLAD_API_PTR hookDeleteShader(GLuint shader) {
+      record(Op::DELETE_SHADER, { shader });
+      realDeleteShader(shader);
+    }
+    GLuint GLAD_API_PTR hookCreateProgram() {
+      GLuint program = realCreateProgram();
+      record(Op::CREATE_PROGRAM, { program });
+      return program;
+    }
+    void GLAD_API_PTR hookAttachShader(GLuint program, GLuint shader) {
+      record(Op::ATTACH_SHADER, { program, shader });
+      realAttachShader(program, shader);
+    }
+    void GLAD_API_PTR hookLinkProgram(GLuint program) {
+      record(Op::LINK_PROGRAM, { program });
+      realLinkProgram(program);
+    }
+    void GLAD_API_PTR hookDeleteProgram(GLuint program) {
+      record(Op::DELETE_PROGRAM, { program });
+      realDeleteProgram(program);
+    }
+    void GLAD_API_PTR hookUseProgram(GLuint program) {
+      record(Op::USE_PROGRAM, { program });
+      realUseProgram(program);
+    }
+    GLint GLAD_API_PTR hookGetUniformLocation(GLuint program, const GLchar* name) {
+      GLint location = realGetUniformLocation(program, name);
+      record(Op::GET_UNIFORM_LOCATION, { program, location }, name, std::strlen(name) + 1);
+      return location;
+    }
+    GLuint GLAD_API_PTR hookGetUniformBlockIndex(GLuint program, const GLchar* name) {
+      GLuint index = realGetUniformBlockIndex(program, name);
+      record(Op::GET_UNIFORM_BLOCK_INDEX, { program, index }, name, std::strlen(name) + 1);
+      return index;
+    }
+    void GLAD_API_PTR hookUniformBlockBinding(GLuint program, GLuint blockIndex, GLuint binding) {
+      record(Op::UNIFORM_BLOCK_BINDING, { program, blockIndex, binding });
+      realUniformBlockBinding(program, blockIndex, binding);
+    }
+    void GLAD_API_PTR hookUniform1i(GLint location, GLint v0) {
+      record(Op::UNIFORM_1I, { location, v0 });
+      realUniform1i(location, v0);
+    }
+    void GLAD_API_PTR hookUniform1ui(GLint location, GLuint v0) {
+      record(Op::UNIFORM_1UI, { location, v0 });
+      realUniform1ui(location, v0);
+    }
+    void GLAD_API_PTR hookUniform1f(GLint location, GLfloat v0) {
+      record(Op::UNIFORM_1F, { location, floatArg(v0) });
+      realUniform1f(location, v0);
+    }
+    void GLAD_API_PTR hookUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+      record(Op::UNIFORM_2F, { location, floatArg(v0), floatArg(v1) });
+      realUniform2f(location, v0, v1);
+    }
+    void GLAD_API_PTR hookUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+      record(Op::UNIFORM_3F, { location, floatArg(v0), floatArg(v1), floatArg(v2) });
+      realUniform3f(location, v0, v1, v2);
+    }
+    void GLAD_API_PTR hookUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+      record(Op::UNIFORM_4F, { location, floatArg(v0), floatArg(v1), floatArg(v2), floatArg(v3) });
+      realUniform4f(location, v0, v1, v2, v3);
+    }
+    void GLAD_API_PTR hookUniform2fv(GLint location, GLsizei count, const GLfloat* value) {
+      record(Op::UNIFORM_2FV, { location, count }, value, count * 2 * sizeof(GLfloat));
+      realUniform2fv(location, count, value);
+    }
+    void GLAD_API_PTR hookUniform4fv(GLint location, GLsizei count, const GLfloat* value) {
+      record(Op::UNIFORM_4FV, { location, count }, value, count * 4 * sizeof(GLfloat));
+      realUniform4fv(location, count, value);
+    }
+    void GLAD_API_PTR hookUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose,
+                                           const GLfloat* value) {
+      record(Op::UNIFORM_MATRIX_4FV, { location, count, transpose }, value, count * 16 * sizeof(GLfloat));
+      realUniformMatrix4fv(location, count, transpose, value);
+    }
+
+    // Buffers
+    void GLAD_API_PTR hookBindBuffer(GLenum target, GLuint buffer) {
+      bindBuffer(target, buffer);
+      record(Op::BIND_BUFFER, { target, buffer });
+      realBindBuffer(target, buffer);
+    }
+    void GLAD_API_PTR hookBindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+      bindBuffer(target, buffer);
+      record(Op::BIND_BUFFER_BASE, { target, index, buffer });
+      realBindBufferBase(target, index, buffer);
+    }
+    void GLAD_API_PTR hookBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+      recordUpload(bufferObject(boundBuffer(target)), bufferUpload(0, size, true),
+                   Op::BUFFER_DATA, { target, size, usage }, data, static_cast<size_t>(size));
+      realBufferData(target, size, data, usage);
+    }
+    void GLAD_API_PTR hookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+      recordUpload(bufferObject(boundBuffer(target)), bufferUpload(offset, size, false),
+                   Op::BUFFER_SUB_DATA, { target, offset, size }, data, static_cast<size_t>(size));
+      realBufferSubData(target, offset, size, data);
+    }
+    void* GLAD_API_PTR hookMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
+                                          GLbitfield access) {
+      void* pointer = realMapBufferRange(target, offset, length, access);
+      if (pointer != nullptr) mappings.push_back({ target, offset, length, access, pointer });
+      return pointer;
+    }
+    GLboolean GLAD_API_PTR hookUnmapBuffer(GLenum target) {
+      // Whatever was written through the mapping replays as a sub-data upload
+      for (auto it = mappings.begin(); it != mappings.end(); ++it) {
+        if (it->target != target) continue;
+        if (it->access & GL_MAP_WRITE_BIT) {
+          recordUpload(bufferObject(boundBuffer(target)), bufferUpload(it->offset, it->length, false),
+                       Op::BUFFER_SUB_DATA, { target, it->offset, it->length },
+                       it->pointer, static_cast<size_t>(it->length));
+        }
+        mappings.erase(it);
+        break;
+      }
+      return realUnmapBuffer(target);
+    }
+
+    // Textures
+    void GLAD_API_PTR hookActiveTexture(GLenum texture) {
+      activeTexture = texture;
+      record(Op::ACTIVE_TEXTURE, { texture });
+      realActiveTexture(texture);
+    }
+    void GLAD_API_PTR hookBindTexture(GLenum target, GLuint texture) {
+      boundTextures[textureBinding(activeTexture, target)] = texture;
+      record(Op::BIND_TEXTURE, { target, texture });
+      realBindTexture(target, texture);
+    }
+    void GLAD_API_PTR hookTexParameteri(GLenum target, GLenum name, GLint param) {
+      record(Op::TEX_PARAMETER_I, { target, name, param });
+      realTexParameteri(target, name, param);
+    }
+    void GLAD_API_PTR hookTexParameterfv(GLenum target, GLenum name, const GLfloat* params) {
+      // Only vector parameter in use is the border color
+      record(Op::TEX_PARAMETER_FV, { target, name }, params, 4 * sizeof(GLfloat));
+      realTexParameterfv(target, name, params);
+    }
+    void GLAD_API_PTR hookPixelStorei(GLenum name, GLint param) {
+      if (name == GL_UNPACK_ALIGNMENT) unpackAlignment = param;
+      if (name == GL_UNPACK_ROW_LENGTH) unpackRowLength = param;
+      record(Op::PIXEL_STORE_I, { name, param });
+      realPixelStorei(name, param);
+    }
+    void GLAD_API_PTR hookTexImage2D(GLenum target, GLint level, GLint internalFormat,
+                                     GLsizei width, GLsizei height, GLint border,
+                                     GLenum format, GLenum type, const void* pixels) {
+      recordImage(Op::TEX_IMAGE_2D,
+                  { target, level, internalFormat, width, height, border, format, type },
+                  target, imageUpload(level, 0, 0, width, height, true, -1),
+                  pixels, imageBytes(width, height, 1, format, type));
+      realTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+    void GLAD_API_PTR hookTexSubImage2D(GLenum target, GLint level, GLint x, GLint y,
+                                        GLsizei width, GLsizei height,
+                                        GLenum format, GLenum type, const void* pixels) {
+      recordImage(Op::TEX_SUB_IMAGE_2D,
+                  { target, level, x, y, width, height, format, type },
+                  target, imageUpload(level, x, y, width, height, false, -1),
+                  pixels, imageBytes(width, height, 1, format, type));
+      realTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    }
+    void GLAD_API_PTR hookTexImage3D(GLenum target, GLint level, GLint internalFormat,
+                                     GLsizei width, GLsizei height, GLsizei depth, GLint border,
+                                     GLenum format, GLenum type, const void* pixels) {
+      recordImage(Op::TEX_IMAGE_3D,
+                  { target, level, internalFormat, width, height, depth, border, format, type },
+                  target, imageUpload(level, 0, 0, width, height, true, -1),
+                  pixels, imageBytes(width, height, depth, format, type));
+      realTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+    }
+    void GLAD_API_PTR hookCopyTexSubImage3D(GLenum target, GLint level, GLint xOffset, GLint yOffset,
+                                            GLint zOffset, GLint x, GLint y,
+                                            GLsizei width, GLsizei height) {
+      record(Op::COPY_TEX_SUB_IMAGE_3D, { target, level, xOffset, yOffset, zOffset, x, y, width, height });
+      realCopyTexSubImage3D(target, level, xOffset, yOffset, zOffset, x, y, width, height);
+    }
+    void GLAD_API_PTR hookGenerateMipmap(GLenum target) {
+      record(Op::GENERATE_MIPMAP, { target });
+      realGenerateMipmap(target);
+    }
+
+    // Vertex arrays
+    void GLAD_API_PTR hookBindVertexArray(GLuint array) {
+      boundVertexArray = array;
+      record(Op::BIND_VERTEX_ARRAY, { array });
+      realBindVertexArray(array);
+    }
+    void GLAD_API_PTR hookVertexAttribPointer(GLuint index, GLint size, GLenum type,
+                                              GLboolean normalized, GLsizei stride, const void* pointer) {
+      record(Op::VERTEX_ATTRIB_POINTER, { index, size, type, normalized, stride, pointerArg(pointer) });
+      realVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    }
+    void GLAD_API_PTR hookVertexAttribIPointer(GLuint index, GLint size, GLenum type,
+                                               GLsizei stride, const void* pointer) {
+      record(Op::VERTEX_ATTRIB_I_POINTER, { index, size, type, stride, pointerArg(pointer) });
+      realVertexAttribIPointer(index, size, type, stride, pointer);
+    }
+    void GLAD_API_PTR hookEnableVertexAttribArray(GLuint index) {
+      record(Op::ENABLE_VERTEX_ATTRIB_ARRAY, { index });
+      realEnableVertexAttribArray(index);
+    }
+    void GLAD_API_PTR hookVertexAttribDivisor(GLuint index, GLuint divisor) {
+      record(Op::VERTEX_ATTRIB_DIVISOR, { index, divisor });
+      realVertexAttribDivisor(index, divisor);
+    }
+    void GLAD_API_PTR hookVertexAttribI4ui(GLuint index, GLuint x, GLuint y, GLuint z, GLuint w) {
+      record(Op::VERTEX_ATTRIB_I_4UI, { index, x, y, z, w });
+      realVertexAttribI4ui(index, x, y, z, w);
+    }
+
+    // Framebuffers
+    void GLAD_API_PTR hookBindFramebuffer(GLenum target, GLuint framebuffer) {
+      record(Op::BIND_FRAMEBUFFER, { target, framebuffer });
+      realBindFramebuffer(target, framebuffer);
+    }
+    void GLAD_API_PTR hookFramebufferTexture2D(GLenum target, GLenum attachment, GLenum texTarget,
+                                               GLuint texture, GLint level) {
+      record(Op::FRAMEBUFFER_TEXTURE_2D, { target, attachment, texTarget, texture, level });
+      realFramebufferTexture2D(target, attachment, texTarget, texture, level);
+    }
+    void GLAD_API_PTR hookFramebufferTextureLayer(GLenum target, GLenum attachment, GLuint texture,
+                                                  GLint level, GLint layer) {
+      record(Op::FRAMEBUFFER_TEXTURE_LAYER, { target, attachment, texture, level, layer });
+      realFramebufferTextureLayer(target, attachment, texture, level, layer);
+    }
+    void GLAD_API_PTR hookFramebufferRenderbuffer(GLenum target, GLenum attachment,
+                                                  GLenum renderbufferTarget, GLuint renderbuffer) {
+      record(Op::FRAMEBUFFER_RENDERBUFFER, { target, attachment, renderbufferTarget, renderbuffer });
+      realFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+    }
+    void GLAD_API_PTR hookBindRenderbuffer(GLenum target, GLuint renderbuffer) {
+      record(Op::BIND_RENDERBUFFER, { target, renderbuffer });
+      realBindRenderbuffer(target, renderbuffer);
+    }
+    void GLAD_API_PTR hookRenderbufferStorage(GLenum target, GLenum internalFormat,
+                                              GLsizei width, GLsizei height) {
+      record(Op::RENDERBUFFER_STORAGE, { target, internalFormat, width, height });
+      realRenderbufferStorage(target, internalFormat, width, height);
+    }
+
+    // Fixed-function state
+    void GLAD_API_PTR hookEnable(GLenum cap) {
+      record(Op::ENABLE, { cap });
+      realEnable(cap);
+    }
+    void GLAD_API_PTR hookDisable(GLenum cap) {
+      record(Op::DISABLE, { cap });
+      realDisable(cap);
+    }
+    void GLAD_API_PTR hookBlendFunc(GLenum source, GLenum destination) {
+      record(Op::BLEND_FUNC, { source, destination });
+      realBlendFunc(source, destination);
+    }
+    void GLAD_API_PTR hookDepthFunc(GLenum func) {
+      record(Op::DEPTH_FUNC, { func });
+      realDepthFunc(func);
+    }
+    void GLAD_API_PTR hookDepthMask(GLboolean flag) {
+      record(Op::DEPTH_MASK, { flag });
+      realDepthMask(flag);
+    }
+    void GLAD_API_PTR hookViewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+      record(Op::VIEWPORT, { x, y, width, height });
+      realViewport(x, y, width, height);
+    }
+    void GLAD_API_PTR hookClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+      record(Op::CLEAR_COLOR, { floatArg(r), floatArg(g), floatArg(b), floatArg(a) });
+      realClearColor(r, g, b, a);
+    }
+    void GLAD_API_PTR hookScissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+      record(Op::SCISSOR, { x, y, width, height });
+      realScissor(x, y, width, height);
+    }
+
+    // Work
+    void GLAD_API_PTR hookClear(GLbitfield mask) {
+      record(Op::CLEAR, { mask });
+      realClear(mask);
+    }
+    void GLAD_API_PTR hookBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+                                          GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+                                          GLbitfield mask, GLenum filter) {
+      record(Op::BLIT_FRAMEBUFFER, { srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter });
+      realBlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+    }
+    void GLAD_API_PTR hookDrawArrays(GLenum mode, GLint first, GLsizei count) {
+      record(Op::DRAW_ARRAYS, { mode, first, count });
+      realDrawArrays(mode, first, count);
+    }
+    void GLAD_API_PTR hookDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+      record(Op::DRAW_ELEMENTS, { mode, count, type, pointerArg(indices) });
+      realDrawElements(mode, count, type, indices);
+    }
+    void GLAD_API_PTR hookDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
+                                                 const void* indices, GLint baseVertex) {
+      record(Op::DRAW_ELEMENTS_BASE_VERTEX, { mode, count, type, pointerArg(indices), baseVertex });
+      realDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    }
+    void GLAD_API_PTR hookDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+                                                const void* indices, GLsizei instances) {
+      record(Op::DRAW_ELEMENTS_INSTANCED, { mode, count, type, pointerArg(indices), instances });
+      realDrawElementsInstanced(mode, count, type, indices, instances);
+    }
+    void GLAD_API_PTR hookDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect) {
+      record(Op::DRAW_ELEMENTS_INDIRECT, { mode, type, pointerArg(indirect) });
+      realDrawElementsIndirect(mode, type, indirect);
+    }
+    void GLAD_API_PTR hookMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect,
+                                                    GLsizei drawCount, GLsizei stride) {
+      record(Op::MULTI_DRAW_ELEMENTS_INDIRECT, { mode, type, pointerArg(indirect), drawCount, stride });
+      realMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    }
+    void GLAD_API_PTR hookDispatchCompute(GLuint x, GLuint y, GLuint z) {
+      record(Op::DISPATCH_COMPUTE, { x, y, z });
+      realDispatchCompute(x, y, z);
+    }
+    void GLAD_API_PTR hookMemoryBarrier(GLbitfield barriers) {
+      record(Op::MEMORY_BARRIER, { barriers });
+      realMemoryBarrier(barriers);
+    }
+
+    void uninstall() {
+      #define RESTORE_HOOK(name) if (real##name != nullptr) glad_gl##name = real##name;
+      CAPTURE_HOOKS(RESTORE_HOOK)
+      #undef RESTORE_HOOK
+      installed = false;
+    }
+
+    void writeFile() {
+      header.frameCount = static_cast<uint32_t>(framesCaptured);
+
+      std::ofstream file(outputPath, std::ios::binary);
+      if (!file.is_open()) {
+        std::cerr << "GL capture: failed to open " << outputPath << std::endl;
+        return;
+      }
+
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(stream.data()), stream.size());
+
+      std::cout << "GL capture: " << framesCaptured << " frames, "
+                << stream.size() / 1024 << " KB -> " << outputPath << std::endl;
+    }
+  }
+
+  void request(const std::string& path, int frames, int skipFrames) {
+    outputPath = path;
+    framesToCapture = std::max(1, frames);
+    framesToSkip = std::max(0, skipFrames);
+    requested = true;
+  }
+
+  bool isRequested() {
+    return requested;
+  }
+
+  void install(int width, int height) {
+    if (!requested || installed) return;
+
+    header = Header{ MAGIC, VERSION, width, height, 0 };
+    stream.clear();
+    keepUploads();
+    deadRanges.clear();
+    deadBytes = 0;
+
+    // Only hook what the driver actually provides (compute may be missing)
+    #define INSTALL_HOOK(name) \
+      real##name = glad_gl##name; \
+      if (real##name != nullptr) glad_gl##name = hook##name;
+    CAPTURE_HOOKS(INSTALL_HOOK)
+    #undef INSTALL_HOOK
+
+    installed = true;
+    std::cout << "GL capture: recording " << framesToCapture << " frames after "
+              << framesToSkip << " (F9 starts now)" << std::endl;
+  }
+
+  void trigger() {
+    if (installed && !recording) triggered = true;
+  }
+
+  void endFrame() {
+    if (!installed) return;
+
+    if (recording) {
+      record(Op::FRAME_END, {});
+      if (++framesCaptured < framesToCapture) return;
+
+      writeFile();
+      uninstall();
+      recording = false;
+      requested = false;
+      stream.clear();
+      stream.shrink_to_fit();
+      return;
+    }
+
+    // Whole frames only: the window opens at a frame boundary
+    if (++frameIndex >= framesToSkip || triggered) {
+      compact();
+      keepUploads();
+      recording = true;
+      record(Op::CAPTURE_BEGIN, {});
+      std::cout << "GL capture: pre-roll " << stream.size() / 1024 << " KB" << std::endl;
+    }
+  }
+
+  bool isRecording() {
+    return recording;
+  }
+
+  PersistentPass::PersistentPass() {
+    persistentPasses++;
+  }
+
+  PersistentPass::~PersistentPass() {
+    persistentPasses--;
+  }
+}
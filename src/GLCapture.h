@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// GL command stream capture, run with `./game --capture <file> [frames] [skip]`.
+//
+// Every GL call the engine makes goes through the loader's function
+// pointers, so capture swaps the ones the engine uses for recorders. Calls
+// are serialized with the data they read (buffer, texture and shader
+// contents), and object names are remapped on replay, so a trace replays
+// without the game. Setup and the frames before the capture window are
+// kept as a pre-roll with their draws dropped (except in a PersistentPass)
+// and only the latest contents of each buffer and texture; the next
+// `frames` frames are kept whole. See GLReplay for the other side.
+namespace GLCapture {
+
+  // Trace file: Header, then commands until the end of the file.
+  // Command = u16 op, u8 argc, i64 args[argc], u32 blob size, blob.
+  const uint32_t MAGIC = 0x52544C47;  // "GLTR"
+  const uint32_t VERSION = 3;
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint32_t frameCount;
+  };
+
+  enum class Op : uint16_t {
+    // Markers
+    CAPTURE_BEGIN,    // Pre-roll ends here
+    FRAME_END,
+
+    // Objects (blob = captured names)
+    GEN_BUFFERS, DELETE_BUFFERS,
+    GEN_TEXTURES, DELETE_TEXTURES,
+    GEN_VERTEX_ARRAYS, DELETE_VERTEX_ARRAYS,
+    GEN_FRAMEBUFFERS, DELETE_FRAMEBUFFERS,
+    GEN_RENDERBUFFERS, DELETE_RENDERBUFFERS,
+
+    // Programs
+    CREATE_SHADER, SHADER_SOURCE, COMPILE_SHADER, DELETE_SHADER,
+    CREATE_PROGRAM, ATTACH_SHADER, LINK_PROGRAM, DELETE_PROGRAM, USE_PROGRAM,
+    GET_UNIFORM_LOCATION, GET_UNIFORM_BLOCK_INDEX, UNIFORM_BLOCK_BINDING,
+    UNIFORM_1I, UNIFORM_1UI, UNIFORM_1F, UNIFORM_2F, UNIFORM_3F, UNIFORM_4F,
+    UNIFORM_2FV, UNIFORM_4FV, UNIFORM_MATRIX_4FV,
+
+    // Buffers
+    BIND_BUFFER, BIND_BUFFER_BASE, BUFFER_DATA, BUFFER_SUB_DATA,
+
+    // Textures
+    ACTIVE_TEXTURE, BIND_TEXTURE, TEX_PARAMETER_I, TEX_PARAMETER_FV, PIXEL_STORE_I,
+    TEX_IMAGE_2D, TEX_SUB_IMAGE_2D, TEX_IMAGE_3D, COPY_TEX_SUB_IMAGE_3D,
+    GENERATE_MIPMAP,
+
+    // Vertex arrays
+    BIND_VERTEX_ARRAY, VERTEX_ATTRIB_POINTER, VERTEX_ATTRIB_I_POINTER,
+    ENABLE_VERTEX_ATTRIB_ARRAY, VERTEX_ATTRIB_DIVISOR, VERTEX_ATTRIB_I_4UI,
+
+    // Framebuffers
+    BIND_FRAMEBUFFER, FRAMEBUFFER_TEXTURE_2D, FRAMEBUFFER_TEXTURE_LAYER,
+    FRAMEBUFFER_RENDERBUFFER, BIND_RENDERBUFFER, RENDERBUFFER_STORAGE,
+
+    // Fixed-function state
+    ENABLE, DISABLE, BLEND_FUNC, DEPTH_FUNC, DEPTH_MASK, VIEWPORT, CLEAR_COLOR,
+    SCISSOR,
+
+    // Work (dropped from the pre-roll)
+    CLEAR, BLIT_FRAMEBUFFER, DRAW_ARRAYS, DRAW_ELEMENTS, DRAW_ELEMENTS_INSTANCED,
+    DRAW_ELEMENTS_INDIRECT, MULTI_DRAW_ELEMENTS_INDIRECT, DISPATCH_COMPUTE,
+    MEMORY_BARRIER, DRAW_ELEMENTS_BASE_VERTEX,
+
+    COUNT
+  };
+
+  // Arms capture; the loader is hooked when the window's context exists
+  void request(const std::string& path, int frames, int skipFrames);
+  bool isRequested();
+
+  // Called by Window right after the GL loader
+  void install(int width, int height);
+
+  // Starts the capture window now instead of after the skipped frames
+  void trigger();
+
+  // Called by Window on every swap; writes the file when the last frame ends
+  void endFrame();
+
+  bool isRecording();
+
+  // Draws made while one is alive are kept in the pre-roll too, for passes
+  // whose output outlives the frame (the tilemap's impostor bakes)
+  class PersistentPass {
+    public:
+      PersistentPass();
+      ~PersistentPass();
+
+      PersistentPass(const PersistentPass&) = delete;
+      PersistentPass& operator=(const PersistentPass&) = delete;
+  };
+}
@@ -0,0 +1,151 @@
+#include "GLDebug.h"
+
+#ifndef NDEBUG
+
+#include "Common.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+namespace GLDebug {
+
+  namespace {
+    // Each distinct message prints this many times, then at 10x, 100x, ...
+    const int PRINT_FIRST = 3;
+
+    bool installed = false;
+    Counters frame{};
+    Counters lastFrame{};
+    Counters totals{};
+    std::unordered_map<uint64_t, int> seen;
+
+    bool contains(const std::string& text, const char* word) {
+      return text.find(word) != std::string::npos;
+    }
+
+    const char* typeName(GLenum type) {
+      switch (type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        default: return "other";
+      }
+    }
+
+    // Drivers word these differently; match on the gist
+    const char* countPerformance(const std::string& message, Counters& counters) {
+      std::string lower(message);
+      std::transform(lower.begin(), lower.end(), lower.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+      if (contains(lower, "stall") || contains(lower, "sync") ||
+          contains(lower, "wait") || contains(lower, "busy")) {
+        counters.bufferStalls++;
+        return "buffer stall";
+      }
+      if (contains(lower, "recompil")) {
+        counters.recompiles++;
+        return "shader recompile";
+      }
+      if (contains(lower, "redundant")) {
+        counters.redundantState++;
+        return "redundant state";
+      }
+
+      counters.otherPerformance++;
+      return "performance";
+    }
+
+    void GLAD_API_PTR onMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                GLsizei length, const GLchar* message, const void*) {
+      // Our own group markers, and informational chatter
+      if (type == GL_DEBUG_TYPE_PUSH_GROUP || type == GL_DEBUG_TYPE_POP_GROUP ||
+          type == GL_DEBUG_TYPE_MARKER) return;
+      if (type == GL_DEBUG_TYPE_OTHER && severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+
+      std::string text = length >= 0 ? std::string(message, length) : std::string(message);
+      const char* category = typeName(type);
+
+      if (type == GL_DEBUG_TYPE_ERROR) {
+        frame.errors++;
+      } else if (type == GL_DEBUG_TYPE_PERFORMANCE) {
+        category = countPerformance(text, frame);
+      }
+
+      uint64_t key = (static_cast<uint64_t>(source) << 48) ^
+                     (static_cast<uint64_t>(type) << 32) ^ id;
+      int count = ++seen[key];
+
+      bool print = count <= PRINT_FIRST;
+      for (int step = 10; !print && step <= count; step *= 10) {
+        print = count == step;
+      }
+      if (!print) return;
+
+      std::cerr << "GL " << category << " (id " << id << ")";
+      if (count > PRINT_FIRST) std::cerr << " [seen " << count << " times]";
+      std::cerr << ": " << text << std::endl;
+    }
+
+    void add(Counters& into, const Counters& from) {
+      into.errors += from.errors;
+      into.bufferStalls += from.bufferStalls;
+      into.recompiles += from.recompiles;
+      into.redundantState += from.redundantState;
+      into.otherPerformance += from.otherPerformance;
+    }
+  }
+
+  bool install() {
+    if (installed) return true;
+    if (!GLAD_GL_KHR_debug) return false;
+
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT)) return false;
+
+    // Synchronous, so messages land in the frame (and call stack) that caused them
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(onMessage, nullptr);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+
+    installed = true;
+    std::cout << "GL debug output: ON" << std::endl;
+    return true;
+  }
+
+  bool isInstalled() {
+    return installed;
+  }
+
+  void endFrame() {
+    add(totals, frame);
+    lastFrame = frame;
+    frame = Counters{};
+  }
+
+  Counters getLastFrame() {
+    return lastFrame;
+  }
+
+  Counters getTotals() {
+    // Include the frame in progress (benchmarks never swap)
+    Counters result = totals;
+    add(result, frame);
+    return result;
+  }
+
+  ScopedGroup::ScopedGroup(const char* name) : pushed(installed) {
+    if (pushed) glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+  }
+
+  ScopedGroup::~ScopedGroup() {
+    if (pushed) glPopDebugGroup();
+  }
+}
+
+#endif
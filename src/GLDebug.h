@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+
+// KHR_debug sink: driver messages are categorized, rate-limited on stderr
+// and counted per frame, and render passes are named with debug groups so
+// external tools (RenderDoc, apitrace) show readable captures.
+//
+// Debug builds only, and messages only with GAME_GL_DEBUG=1 (see Window).
+// With NDEBUG (`make release`) everything below is an empty inline and
+// GL_DEBUG_GROUP expands to nothing.
+namespace GLDebug {
+
+  struct Counters {
+    int errors;
+    int bufferStalls;     // Waits on buffers the GPU is still using
+    int recompiles;       // State-dependent shader variants built at draw time
+    int redundantState;
+    int otherPerformance;
+
+    int performanceTotal() const {
+      return bufferStalls + recompiles + redundantState + otherPerformance;
+    }
+  };
+
+#ifndef NDEBUG
+  // Hooks the callback if the context is a debug one with KHR_debug
+  bool install();
+  bool isInstalled();
+
+  // Called once per frame (Window::swapBuffers)
+  void endFrame();
+
+  // Counts of the last finished frame, and since install
+  Counters getLastFrame();
+  Counters getTotals();
+
+  class ScopedGroup {
+    public:
+      ScopedGroup(const char* name);
+      ~ScopedGroup();
+
+      ScopedGroup(const ScopedGroup&) = delete;
+      ScopedGroup& operator=(const ScopedGroup&) = delete;
+
+    private:
+      bool pushed;
+  };
+#else
+  inline bool install() { return false; }
+  inline bool isInstalled() { return false; }
+  inline void endFrame() {}
+  inline Counters getLastFrame() { return Counters{}; }
+  inline Counters getTotals() { return Counters{}; }
+#endif
+}
+
+#ifndef NDEBUG
+  #define GL_DEBUG_CONCAT_(a, b) a##b
+  #define GL_DEBUG_CONCAT(a, b) GL_DEBUG_CONCAT_(a, b)
+  // Names the GL commands until the end of the enclosing scope
+  #define GL_DEBUG_GROUP(name) GLDebug::ScopedGroup GL_DEBUG_CONCAT(debugGroup_, __LINE__)(name)
+#else
+  #define GL_DEBUG_GROUP(name) ((void)0)
+#endif
@@ -0,0 +1,541 @@
+#include "GLReplay.h"
+#include "GLCapture.h"
+#include "Window.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+namespace GLReplay {
+
+  namespace {
+    using GLCapture::Op;
+
+    const int MAX_ARGS = 12;
+
+    struct Command {
+      Op op;
+      int argc;
+      int64_t args[MAX_ARGS];
+      const uint8_t* blob;
+      uint32_t blobSize;
+    };
+
+    // Captured object name -> name in this context
+    struct NameMap {
+      std::unordered_map<GLuint, GLuint> names;
+
+      GLuint get(int64_t captured) const {
+        auto it = names.find(static_cast<GLuint>(captured));
+        return it != names.end() ? it->second : static_cast<GLuint>(captured);
+      }
+    };
+
+    struct Replayer {
+      NameMap buffers, textures, vertexArrays, framebuffers, renderbuffers;
+      NameMap shaders, programs;
+
+      // (program, captured location) -> location here
+      std::unordered_map<uint64_t, GLint> locations;
+      std::unordered_map<uint64_t, GLuint> blockIndices;  // Same for uniform blocks
+      GLuint currentProgram = 0;
+
+      GLint location(int64_t captured) const {
+        if (captured < 0) return -1;
+        auto it = locations.find(locationKey(currentProgram, captured));
+        return it != locations.end() ? it->second : static_cast<GLint>(captured);
+      }
+
+      static uint64_t locationKey(GLuint program, int64_t location) {
+        return (static_cast<uint64_t>(program) << 32) | static_cast<uint32_t>(location);
+      }
+
+      void execute(const Command& c);
+    };
+
+    float floatArg(int64_t value) {
+      uint32_t bits = static_cast<uint32_t>(value);
+      float result;
+      std::memcpy(&result, &bits, sizeof(result));
+      return result;
+    }
+
+    const void* pointerArg(int64_t value) {
+      return reinterpret_cast<const void*>(static_cast<intptr_t>(value));
+    }
+
+    // Images carry (from buffer, offset) after their own args
+    const void* imageSource(const Command& c) {
+      if (c.args[c.argc - 2] != 0) return pointerArg(c.args[c.argc - 1]);
+      return c.blobSize > 0 ? c.blob : nullptr;
+    }
+
+    template <typename Gen>
+    void generate(NameMap& map, const Command& c, Gen gen) {
+      GLsizei n = static_cast<GLsizei>(c.args[0]);
+      std::vector<GLuint> captured(n), created(n);
+      std::memcpy(captured.data(), c.blob, n * sizeof(GLuint));
+      gen(n, created.data());
+
+      for (GLsizei i = 0; i < n; i++) map.names[captured[i]] = created[i];
+    }
+
+    template <typename Delete>
+    void release(NameMap& map, const Command& c, Delete del) {
+      GLsizei n = static_cast<GLsizei>(c.args[0]);
+      std::vector<GLuint> captured(n), names(n);
+      std::memcpy(captured.data(), c.blob, n * sizeof(GLuint));
+
+      for (GLsizei i = 0; i < n; i++) {
+        names[i] = map.get(captured[i]);
+        map.names.erase(captured[i]);
+      }
+      del(n, names.data());
+    }
+
+    void Replayer::execute(const Command& c) {
+      const int64_t* a = c.args;
+
+      switch (c.op) {
+        case Op::CAPTURE_BEGIN:
+        case Op::FRAME_END:
+        case Op::COUNT:
+          break;
+
+        // Objects
+        case Op::GEN_BUFFERS:
+          generate(buffers, c, [](GLsizei n, GLuint* out) { glGenBuffers(n, out); });
+          break;
+        case Op::DELETE_BUFFERS:
+          release(buffers, c, [](GLsizei n, const GLuint* in) { glDeleteBuffers(n, in); });
+          break;
+        case Op::GEN_TEXTURES:
+          generate(textures, c, [](GLsizei n, GLuint* out) { glGenTextures(n, out); });
+          break;
+        case Op::DELETE_TEXTURES:
+          release(textures, c, [](GLsizei n, const GLuint* in) { glDeleteTextures(n, in); });
+          break;
+        case Op::GEN_VERTEX_ARRAYS:
+          generate(vertexArrays, c, [](GLsizei n, GLuint* out) { glGenVertexArrays(n, out); });
+          break;
+        case Op::DELETE_VERTEX_ARRAYS:
+          release(vertexArrays, c, [](GLsizei n, const GLuint* in) { glDeleteVertexArrays(n, in); });
+          break;
+        case Op::GEN_FRAMEBUFFERS:
+          generate(framebuffers, c, [](GLsizei n, GLuint* out) { glGenFramebuffers(n, out); });
+          break;
+        case Op::DELETE_FRAMEBUFFERS:
+          release(framebuffers, c, [](GLsizei n, const GLuint* in) { glDeleteFramebuffers(n, in); });
+          break;
+        case Op::GEN_RENDERBUFFERS:
+          generate(renderbuffers, c, [](GLsizei n, GLuint* out) { glGenRenderbuffers(n, out); });
+          break;
+        case Op::DELETE_RENDERBUFFERS:
+          release(renderbuffers, c, [](GLsizei n, const GLuint* in) { glDeleteRenderbuffers(n, in); });
+          break;
+
+        // Programs
+        case Op::CREATE_SHADER:
+          shaders.names[static_cast<GLuint>(a[1])] = glCreateShader(static_cast<GLenum>(a[0]));
+          break;
+        case Op::SHADER_SOURCE: {
+          const GLchar* source = reinterpret_cast<const GLchar*>(c.blob);
+          GLint length = static_cast<GLint>(c.blobSize);
+          glShaderSource(shaders.get(a[0]), 1, &source, &length);
+          break;
+        }
+        case Op::COMPILE_SHADER:
+          glCompileShader(shaders.get(a[0]));
+          break;
+        case Op::DELETE_SHADER:
+          glDeleteShader(shaders.get(a[0]));
+          break;
+        case Op::CREATE_PROGRAM:
+          programs.names[static_cast<GLuint>(a[0])] = glCreateProgram();
+          break;
+        case Op::ATTACH_SHADER:
+          glAttachShader(programs.get(a[0]), shaders.get(a[1]));
+          break;
+        case Op::LINK_PROGRAM:
+          glLinkProgram(programs.get(a[0]));
+          break;
+        case Op::DELETE_PROGRAM:
+          glDeleteProgram(programs.get(a[0]));
+          break;
+        case Op::USE_PROGRAM:
+          currentProgram = programs.get(a[0]);
+          glUseProgram(currentProgram);
+          break;
+        case Op::GET_UNIFORM_LOCATION: {
+          GLuint program = programs.get(a[0]);
+          GLint found = glGetUniformLocation(program, reinterpret_cast<const GLchar*>(c.blob));
+          locations[locationKey(program, a[1])] = found;
+          break;
+        }
+        case Op::GET_UNIFORM_BLOCK_INDEX: {
+          GLuint program = programs.get(a[0]);
+          GLuint found = glGetUniformBlockIndex(program, reinterpret_cast<const GLchar*>(c.blob));
+          blockIndices[locationKey(program, a[1])] = found;
+          break;
+        }
+        case Op::UNIFORM_BLOCK_BINDING: {
+          GLuint program = programs.get(a[0]);
+          auto it = blockIndices.find(locationKey(program, a[1]));
+          GLuint index = it != blockIndices.end() ? it->second : static_cast<GLuint>(a[1]);
+          if (index != GL_INVALID_INDEX) glUniformBlockBinding(program, index, static_cast<GLuint>(a[2]));
+          break;
+        }
+        case Op::UNIFORM_1I:
+          glUniform1i(location(a[0]), static_cast<GLint>(a[1]));
+          break;
+        case Op::UNIFORM_1UI:
+          glUniform1ui(location(a[0]), static_cast<GLuint>(a[1]));
+          break;
+        case Op::UNIFORM_1F:
+          glUniform1f(location(a[0]), floatArg(a[1]));
+          break;
+        case Op::UNIFORM_2F:
+          glUniform2f(location(a[0]), floatArg(a[1]), floatArg(a[2]));
+          break;
+        case Op::UNIFORM_3F:
+          glUniform3f(location(a[0]), floatArg(a[1]), floatArg(a[2]), floatArg(a[3]));
+          break;
+        case Op::UNIFORM_4F:
+          glUniform4f(location(a[0]), floatArg(a[1]), floatArg(a[2]), floatArg(a[3]), floatArg(a[4]));
+          break;
+        case Op::UNIFORM_2FV:
+          glUniform2fv(location(a[0]), static_cast<GLsizei>(a[1]),
+                       reinterpret_cast<const GLfloat*>(c.blob));
+          break;
+        case Op::UNIFORM_4FV:
+          glUniform4fv(location(a[0]), static_cast<GLsizei>(a[1]),
+                       reinterpret_cast<const GLfloat*>(c.blob));
+          break;
+        case Op::UNIFORM_MATRIX_4FV:
+          glUniformMatrix4fv(location(a[0]), static_cast<GLsizei>(a[1]), static_cast<GLboolean>(a[2]),
+                             reinterpret_cast<const GLfloat*>(c.blob));
+          break;
+
+        // Buffers
+        case Op::BIND_BUFFER:
+          glBindBuffer(static_cast<GLenum>(a[0]), buffers.get(a[1]));
+          break;
+        case Op::BIND_BUFFER_BASE:
+          glBindBufferBase(static_cast<GLenum>(a[0]), static_cast<GLuint>(a[1]), buffers.get(a[2]));
+          break;
+        case Op::BUFFER_DATA:
+          glBufferData(static_cast<GLenum>(a[0]), static_cast<GLsizeiptr>(a[1]),
+                       c.blobSize > 0 ? c.blob : nullptr, static_cast<GLenum>(a[2]));
+          break;
+        case Op::BUFFER_SUB_DATA:
+          glBufferSubData(static_cast<GLenum>(a[0]), static_cast<GLintptr>(a[1]),
+                          static_cast<GLsizeiptr>(a[2]), c.blob);
+          break;
+
+        // Textures
+        case Op::ACTIVE_TEXTURE:
+          glActiveTexture(static_cast<GLenum>(a[0]));
+          break;
+        case Op::BIND_TEXTURE:
+          glBindTexture(static_cast<GLenum>(a[0]), textures.get(a[1]));
+          break;
+        case Op::TEX_PARAMETER_I:
+          glTexParameteri(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]), static_cast<GLint>(a[2]));
+          break;
+        case Op::TEX_PARAMETER_FV:
+          glTexParameterfv(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]),
+                           reinterpret_cast<const GLfloat*>(c.blob));
+          break;
+        case Op::PIXEL_STORE_I:
+          glPixelStorei(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]));
+          break;
+        case Op::TEX_IMAGE_2D:
+          glTexImage2D(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]), static_cast<GLint>(a[2]),
+                       static_cast<GLsizei>(a[3]), static_cast<GLsizei>(a[4]), static_cast<GLint>(a[5]),
+                       static_cast<GLenum>(a[6]), static_cast<GLenum>(a[7]), imageSource(c));
+          break;
+        case Op::TEX_SUB_IMAGE_2D:
+          glTexSubImage2D(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]),
+                          static_cast<GLint>(a[2]), static_cast<GLint>(a[3]),
+                          static_cast<GLsizei>(a[4]), static_cast<GLsizei>(a[5]),
+                          static_cast<GLenum>(a[6]), static_cast<GLenum>(a[7]), imageSource(c));
+          break;
+        case Op::TEX_IMAGE_3D:
+          glTexImage3D(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]), static_cast<GLint>(a[2]),
+                       static_cast<GLsizei>(a[3]), static_cast<GLsizei>(a[4]), static_cast<GLsizei>(a[5]),
+                       static_cast<GLint>(a[6]), static_cast<GLenum>(a[7]), static_cast<GLenum>(a[8]),
+                       imageSource(c));
+          break;
+        case Op::COPY_TEX_SUB_IMAGE_3D:
+          glCopyTexSubImage3D(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]),
+                              static_cast<GLint>(a[2]), static_cast<GLint>(a[3]), static_cast<GLint>(a[4]),
+                              static_cast<GLint>(a[5]), static_cast<GLint>(a[6]),
+                              static_cast<GLsizei>(a[7]), static_cast<GLsizei>(a[8]));
+          break;
+        case Op::GENERATE_MIPMAP:
+          glGenerateMipmap(static_cast<GLenum>(a[0]));
+          break;
+
+        // Vertex arrays
+        case Op::BIND_VERTEX_ARRAY:
+          glBindVertexArray(vertexArrays.get(a[0]));
+          break;
+        case Op::VERTEX_ATTRIB_POINTER:
+          glVertexAttribPointer(static_cast<GLuint>(a[0]), static_cast<GLint>(a[1]), static_cast<GLenum>(a[2]),
+                                static_cast<GLboolean>(a[3]), static_cast<GLsizei>(a[4]), pointerArg(a[5]));
+          break;
+        case Op::VERTEX_ATTRIB_I_POINTER:
+          glVertexAttribIPointer(static_cast<GLuint>(a[0]), static_cast<GLint>(a[1]), static_cast<GLenum>(a[2]),
+                                 static_cast<GLsizei>(a[3]), pointerArg(a[4]));
+          break;
+        case Op::ENABLE_VERTEX_ATTRIB_ARRAY:
+          glEnableVertexAttribArray(static_cast<GLuint>(a[0]));
+          break;
+        case Op::VERTEX_ATTRIB_DIVISOR:
+          glVertexAttribDivisor(static_cast<GLuint>(a[0]), static_cast<GLuint>(a[1]));
+          break;
+        case Op::VERTEX_ATTRIB_I_4UI:
+          glVertexAttribI4ui(static_cast<GLuint>(a[0]), static_cast<GLuint>(a[1]), static_cast<GLuint>(a[2]),
+                             static_cast<GLuint>(a[3]), static_cast<GLuint>(a[4]));
+          break;
+
+        // Framebuffers
+        case Op::BIND_FRAMEBUFFER:
+          glBindFramebuffer(static_cast<GLenum>(a[0]), framebuffers.get(a[1]));
+          break;
+        case Op::FRAMEBUFFER_TEXTURE_2D:
+          glFramebufferTexture2D(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]),
+                                 static_cast<GLenum>(a[2]), textures.get(a[3]), static_cast<GLint>(a[4]));
+          break;
+        case Op::FRAMEBUFFER_TEXTURE_LAYER:
+          glFramebufferTextureLayer(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]),
+                                    textures.get(a[2]), static_cast<GLint>(a[3]), static_cast<GLint>(a[4]));
+          break;
+        case Op::FRAMEBUFFER_RENDERBUFFER:
+          glFramebufferRenderbuffer(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]),
+                                    static_cast<GLenum>(a[2]), renderbuffers.get(a[3]));
+          break;
+        case Op::BIND_RENDERBUFFER:
+          glBindRenderbuffer(static_cast<GLenum>(a[0]), renderbuffers.get(a[1]));
+          break;
+        case Op::RENDERBUFFER_STORAGE:
+          glRenderbufferStorage(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]),
+                                static_cast<GLsizei>(a[2]), static_cast<GLsizei>(a[3]));
+          break;
+
+        // Fixed-function state
+        case Op::ENABLE:
+          glEnable(static_cast<GLenum>(a[0]));
+          break;
+        case Op::DISABLE:
+          glDisable(static_cast<GLenum>(a[0]));
+          break;
+        case Op::BLEND_FUNC:
+          glBlendFunc(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]));
+          break;
+        case Op::DEPTH_FUNC:
+          glDepthFunc(static_cast<GLenum>(a[0]));
+          break;
+        case Op::DEPTH_MASK:
+          glDepthMask(static_cast<GLboolean>(a[0]));
+          break;
+        case Op::VIEWPORT:
+          glViewport(static_cast<GLint>(a[0]), static_cast<GLint>(a[1]),
+                     static_cast<GLsizei>(a[2]), static_cast<GLsizei>(a[3]));
+          break;
+        case Op::CLEAR_COLOR:
+          glClearColor(floatArg(a[0]), floatArg(a[1]), floatArg(a[2]), floatArg(a[3]));
+          break;
+        case Op::SCISSOR:
+          glScissor(static_cast<GLint>(a[0]), static_cast<GLint>(a[1]),
+                    static_cast<GLsizei>(a[2]), static_cast<GLsizei>(a[3]));
+          break;
+
+        // Work
+        case Op::CLEAR:
+          glClear(static_cast<GLbitfield>(a[0]));
+          break;
+        case Op::BLIT_FRAMEBUFFER:
+          glBlitFramebuffer(static_cast<GLint>(a[0]), static_cast<GLint>(a[1]),
+                            static_cast<GLint>(a[2]), static_cast<GLint>(a[3]),
+                            static_cast<GLint>(a[4]), static_cast<GLint>(a[5]),
+                            static_cast<GLint>(a[6]), static_cast<GLint>(a[7]),
+                            static_cast<GLbitfield>(a[8]), static_cast<GLenum>(a[9]));
+          break;
+        case Op::DRAW_ARRAYS:
+          glDrawArrays(static_cast<GLenum>(a[0]), static_cast<GLint>(a[1]), static_cast<GLsizei>(a[2]));
+          break;
+        case Op::DRAW_ELEMENTS:
+          glDrawElements(static_cast<GLenum>(a[0]), static_cast<GLsizei>(a[1]),
+                         static_cast<GLenum>(a[2]), pointerArg(a[3]));
+          break;
+        case Op::DRAW_ELEMENTS_INSTANCED:
+          glDrawElementsInstanced(static_cast<GLenum>(a[0]), static_cast<GLsizei>(a[1]),
+                                  static_cast<GLenum>(a[2]), pointerArg(a[3]), static_cast<GLsizei>(a[4]));
+          break;
+        case Op::DRAW_ELEMENTS_INDIRECT:
+          glDrawElementsIndirect(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]), pointerArg(a[2]));
+          break;
+        case Op::MULTI_DRAW_ELEMENTS_INDIRECT:
+          glMultiDrawElementsIndirect(static_cast<GLenum>(a[0]), static_cast<GLenum>(a[1]), pointerArg(a[2]),
+                                      static_cast<GLsizei>(a[3]), static_cast<GLsizei>(a[4]));
+          break;
+        case Op::DISPATCH_COMPUTE:
+          glDispatchCompute(static_cast<GLuint>(a[0]), static_cast<GLuint>(a[1]), static_cast<GLuint>(a[2]));
+          break;
+        case Op::MEMORY_BARRIER:
+          glMemoryBarrier(static_cast<GLbitfield>(a[0]));
+          break;
+        case Op::DRAW_ELEMENTS_BASE_VERTEX:
+          glDrawElementsBaseVertex(static_cast<GLenum>(a[0]), static_cast<GLsizei>(a[1]),
+                                   static_cast<GLenum>(a[2]), pointerArg(a[3]), static_cast<GLint>(a[4]));
+          break;
+      }
+    }
+
+    bool decode(const std::vector<uint8_t>& data, size_t offset, std::vector<Command>& out) {
+      auto take = [&](void* value, size_t size) {
+        if (offset + size > data.size()) return false;
+        std::memcpy(value, data.data() + offset, size);
+        offset += size;
+        return true;
+      };
+
+      while (offset < data.size()) {
+        Command command{};
+        uint16_t op;
+        uint8_t argc;
+
+        if (!take(&op, sizeof(op)) || !take(&argc, sizeof(argc))) return false;
+        if (op >= static_cast<uint16_t>(Op::COUNT) || argc > MAX_ARGS) return false;
+
+        command.op = static_cast<Op>(op);
+        command.argc = argc;
+        if (!take(command.args, argc * sizeof(int64_t))) return false;
+        if (!take(&command.blobSize, sizeof(command.blobSize))) return false;
+        if (offset + command.blobSize > data.size()) return false;
+
+        command.blob = data.data() + offset;
+        offset += command.blobSize;
+        out.push_back(command);
+      }
+
+      return true;
+    }
+  }
+
+  int run(const std::string& path, int loops, const std::string& recordPath) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Replay: failed to open " << path << std::endl;
+      return 1;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    GLCapture::Header header;
+    if (data.size() < sizeof(header)) {
+      std::cerr << "Replay: " << path << " is not a trace" << std::endl;
+      return 1;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (header.magic != GLCapture::MAGIC || header.version != GLCapture::VERSION) {
+      std::cerr << "Replay: " << path << " is not a version " << GLCapture::VERSION << " trace" << std::endl;
+      return 1;
+    }
+
+    std::vector<Command> commands;
+    if (!decode(data, sizeof(header), commands)) {
+      std::cerr << "Replay: " << path << " is truncated or corrupt" << std::endl;
+      return 1;
+    }
+
+    // Frame boundaries: [begin, end) command ranges after the pre-roll
+    size_t setupEnd = commands.size();
+    std::vector<std::pair<size_t, size_t>> frames;
+    for (size_t i = 0; i < commands.size(); i++) {
+      if (commands[i].op == Op::CAPTURE_BEGIN) {
+        setupEnd = i + 1;
+      } else if (commands[i].op == Op::FRAME_END) {
+        frames.push_back({ frames.empty() ? setupEnd : frames.back().second, i + 1 });
+      }
+    }
+
+    if (frames.empty()) {
+      std::cerr << "Replay: " << path << " has no complete frames" << std::endl;
+      return 1;
+    }
+
+    Window window("Replay", header.width, header.height, true);
+    if (!window.isOpen()) return 1;
+
+    Replayer replayer;
+    for (size_t i = 0; i < setupEnd; i++) {
+      replayer.execute(commands[i]);
+    }
+    glFinish();
+
+    loops = std::max(1, loops);
+
+    // The first loop's frames, read back like in the game
+    ScreenCapture* screenCapture = window.getScreenCapture();
+    if (!recordPath.empty()) {
+      bool y4m = recordPath.size() > 4 && recordPath.compare(recordPath.size() - 4, 4, ".y4m") == 0;
+      screenCapture->startStream(recordPath, y4m ? ScreenCapture::StreamFormat::Y4M
+                                                 : ScreenCapture::StreamFormat::PNG_SEQUENCE);
+    }
+    std::vector<std::vector<double>> frameTimes(frames.size());
+    std::vector<double> sequenceTimes;
+
+    for (int loop = 0; loop < loops; loop++) {
+      double sequence = 0.0;
+
+      for (size_t f = 0; f < frames.size(); f++) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = frames[f].first; i < frames[f].second; i++) {
+          replayer.execute(commands[i]);
+        }
+        if (screenCapture->isStreaming()) {
+          screenCapture->readFrame(0, header.width, header.height);
+        }
+        glFinish();
+        auto end = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        frameTimes[f].push_back(ms);
+        sequence += ms;
+      }
+
+      sequenceTimes.push_back(sequence);
+
+      if (loop == 0 && screenCapture->isStreaming()) screenCapture->stopStream();
+    }
+
+    auto minOf = [](std::vector<double>& times) { return *std::min_element(times.begin(), times.end()); };
+    auto medianOf = [](std::vector<double>& times) {
+      std::sort(times.begin(), times.end());
+      return times[times.size() / 2];
+    };
+
+    std::cout << "{\"replay\": \"" << path << "\""
+              << ", \"frames\": " << frames.size()
+              << ", \"loops\": " << loops
+              << ", \"commands\": " << commands.size() - setupEnd
+              << ", \"sequence_min_ms\": " << minOf(sequenceTimes)
+              << ", \"sequence_median_ms\": " << medianOf(sequenceTimes) << "," << std::endl;
+    std::cout << " \"frame_ms\": [" << std::endl;
+
+    for (size_t f = 0; f < frames.size(); f++) {
+      std::cout << "  {\"frame\": " << f
+                << ", \"commands\": " << frames[f].second - frames[f].first
+                << ", \"min_ms\": " << minOf(frameTimes[f])
+                << ", \"median_ms\": " << medianOf(frameTimes[f]) << "}"
+                << (f + 1 < frames.size() ? "," : "") << std::endl;
+    }
+
+    std::cout << "]}" << std::endl;
+    return 0;
+  }
+}
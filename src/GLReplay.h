@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+// Offline replay of a GLCapture trace, run with `./game --replay <file> [loops]`.
+//
+// Opens a hidden window, runs the pre-roll once to rebuild every object,
+// then re-executes the captured frames `loops` times with a glFinish after
+// each. No game code runs, so engine or driver changes can be compared on
+// identical frames. Frame times are printed to stdout as JSON.
+//
+// With a record path the first loop is also written out through
+// ScreenCapture: a .y4m path is one video, anything else a PNG sequence.
+namespace GLReplay {
+  int run(const std::string& path, int loops, const std::string& recordPath = "");
+}
@@ -0,0 +1,257 @@
+#include "GLResources.h"
+#include "QuadIndexBuffer.h"
+
+namespace {
+  const char* SHARED_OWNER = "shared meshes";
+
+  const char* KIND_NAMES[GLResources::KIND_COUNT] = {
+    "buffers", "VAOs", "textures", "framebuffers", "renderbuffers", "queries"
+  };
+}
+
+int GLResources::Counts::total() const {
+  int sum = 0;
+  for (int count : live) sum += count;
+  return sum;
+}
+
+GLResources::GLResources()
+  : quadIndexBuffer(0),
+    unitQuadVAO(0),
+    unitQuadVBO(0),
+    fullscreenVAO(0),
+    pendingDeletes(0)
+{
+  // 4 vertices per quad: 0,1,2 / 2,1,3
+  std::vector<uint16_t> indices;
+  indices.reserve(QuadIndexBuffer::QUAD_CAPACITY * 6);
+
+  for (int quad = 0; quad < QuadIndexBuffer::QUAD_CAPACITY; quad++) {
+    uint16_t base = static_cast<uint16_t>(quad * 4);
+    indices.insert(indices.end(), {
+      base, static_cast<uint16_t>(base + 1), static_cast<uint16_t>(base + 2),
+      static_cast<uint16_t>(base + 2), static_cast<uint16_t>(base + 1), static_cast<uint16_t>(base + 3),
+    });
+  }
+
+  // Unbind any VAO so creating this doesn't attach it to someone else's
+  glBindVertexArray(0);
+  quadIndexBuffer = create(Kind::BUFFER, SHARED_OWNER);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+  // 4 corners (shared indices); position doubles as the texture coordinate
+  uint8_t corners[] = {
+    0, 0,
+    1, 0,
+    0, 1,
+    1, 1,
+  };
+
+  unitQuadVAO = create(Kind::VERTEX_ARRAY, SHARED_OWNER);
+  unitQuadVBO = create(Kind::BUFFER, SHARED_OWNER);
+
+  glBindVertexArray(unitQuadVAO);
+
+  glBindBuffer(GL_ARRAY_BUFFER, unitQuadVBO);
+  glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(1);
+
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadIndexBuffer);
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  // Core profile needs some VAO bound even with no attributes
+  fullscreenVAO = create(Kind::VERTEX_ARRAY, SHARED_OWNER);
+}
+
+GLResources::~GLResources() {
+  // Nothing is drawn after this, so there's nothing to wait for
+  for (Retired& frame : retired) {
+    glDeleteSync(frame.fence);
+    for (const Released& object : frame.objects) destroy(object.kind, object.name);
+  }
+  for (const Released& object : releasing) destroy(object.kind, object.name);
+
+  destroy(Kind::VERTEX_ARRAY, unitQuadVAO);
+  destroy(Kind::BUFFER, unitQuadVBO);
+  destroy(Kind::VERTEX_ARRAY, fullscreenVAO);
+  destroy(Kind::BUFFER, quadIndexBuffer);
+}
+
+std::shared_ptr<GLResources> GLResources::acquire() {
+  static std::weak_ptr<GLResources> shared;
+
+  std::shared_ptr<GLResources> resources = shared.lock();
+  if (!resources) {
+    resources = std::shared_ptr<GLResources>(new GLResources());
+    shared = resources;
+  }
+
+  return resources;
+}
+
+GLuint GLResources::getQuadIndexBuffer() const {
+  return quadIndexBuffer;
+}
+
+GLuint GLResources::getUnitQuadVAO() const {
+  return unitQuadVAO;
+}
+
+GLuint GLResources::getUnitQuadBuffer() const {
+  return unitQuadVBO;
+}
+
+GLuint GLResources::getFullscreenVAO() const {
+  return fullscreenVAO;
+}
+
+GLuint GLResources::create(Kind kind, const char* owner) {
+  GLuint name = 0;
+
+  switch (kind) {
+    case Kind::BUFFER: glGenBuffers(1, &name); break;
+    case Kind::VERTEX_ARRAY: glGenVertexArrays(1, &name); break;
+    case Kind::TEXTURE: glGenTextures(1, &name); break;
+    case Kind::FRAMEBUFFER: glGenFramebuffers(1, &name); break;
+    case Kind::RENDERBUFFER: glGenRenderbuffers(1, &name); break;
+    case Kind::QUERY: glGenQueries(1, &name); break;
+    case Kind::COUNT: return 0;
+  }
+
+  auto it = owners.emplace(owner, Counts{}).first;
+  it->second.live[static_cast<int>(kind)]++;
+  return name;
+}
+
+void GLResources::release(Kind kind, GLuint name, const char* owner) {
+  if (name == 0) return;
+
+  releasing.push_back(Released{ kind, name });
+  pendingDeletes++;
+
+  auto it = owners.find(owner);
+  if (it != owners.end()) it->second.live[static_cast<int>(kind)]--;
+}
+
+void GLResources::endFrame() {
+  if (!releasing.empty()) {
+    Retired frame{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), {} };
+    frame.objects.swap(releasing);
+    retired.push_back(std::move(frame));
+  }
+
+  // Fences signal in order; stop at the first frame still in flight
+  while (!retired.empty()) {
+    Retired& frame = retired.front();
+
+    GLenum status = glClientWaitSync(frame.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+
+    glDeleteSync(frame.fence);
+    for (const Released& object : frame.objects) destroy(object.kind, object.name);
+    pendingDeletes -= static_cast<int>(frame.objects.size());
+    retired.pop_front();
+  }
+}
+
+GLResources::Counts GLResources::getCounts() const {
+  Counts sum{};
+  for (const auto& entry : owners) {
+    for (int kind = 0; kind < KIND_COUNT; kind++) sum.live[kind] += entry.second.live[kind];
+  }
+  return sum;
+}
+
+int GLResources::getPendingDeletes() const {
+  return pendingDeletes;
+}
+
+void GLResources::report() const {
+  std::cout << "GL objects by owner:" << std::endl;
+
+  for (const auto& entry : owners) {
+    if (entry.second.total() == 0) continue;
+
+    std::cout << "  " << entry.first << ":";
+    for (int kind = 0; kind < KIND_COUNT; kind++) {
+      if (entry.second.live[kind] > 0) std::cout << " " << entry.second.live[kind] << " " << KIND_NAMES[kind];
+    }
+    std::cout << std::endl;
+  }
+
+  std::cout << "  total: " << getCounts().total()
+            << ", pending delete: " << pendingDeletes << std::endl;
+}
+
+void GLResources::destroy(Kind kind, GLuint name) {
+  switch (kind) {
+    case Kind::BUFFER: glDeleteBuffers(1, &name); break;
+    case Kind::VERTEX_ARRAY: glDeleteVertexArrays(1, &name); break;
+    case Kind::TEXTURE: glDeleteTextures(1, &name); break;
+    case Kind::FRAMEBUFFER: glDeleteFramebuffers(1, &name); break;
+    case Kind::RENDERBUFFER: glDeleteRenderbuffers(1, &name); break;
+    case Kind::QUERY: glDeleteQueries(1, &name); break;
+    case Kind::COUNT: break;
+  }
+}
+
+GLObject::GLObject()
+  : kind(GLResources::Kind::BUFFER),
+    name(0),
+    owner(nullptr)
+{
+}
+
+GLObject::GLObject(GLResources::Kind kind, const char* owner)
+  : resources(GLResources::acquire()),
+    kind(kind),
+    name(0),
+    owner(owner)
+{
+  name = resources->create(kind, owner);
+}
+
+GLObject::~GLObject() {
+  reset();
+}
+
+GLObject::GLObject(GLObject&& other) noexcept
+  : resources(std::move(other.resources)),
+    kind(other.kind),
+    name(other.name),
+    owner(other.owner)
+{
+  other.name = 0;
+}
+
+GLObject& GLObject::operator=(GLObject&& other) noexcept {
+  if (this != &other) {
+    reset();
+    resources = std::move(other.resources);
+    kind = other.kind;
+    name = other.name;
+    owner = other.owner;
+    other.name = 0;
+  }
+  return *this;
+}
+
+void GLObject::reset() {
+  if (name != 0 && resources) {
+    resources->release(kind, name, owner);
+  }
+  name = 0;
+  resources.reset();
+}
+
+GLuint GLObject::get() const {
+  return name;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Common.h"
+
+#include <deque>
+#include <map>
+
+// Registry for GL objects that are shared or owned through GLObject handles.
+// Every buffer, VAO, texture, framebuffer, renderbuffer and query the engine
+// makes goes through it; shader programs, sync objects and what GLReplay
+// recreates from a capture don't.
+//
+// Shared meshes are immutable and built once: the quad index buffer (see
+// QuadIndexBuffer), a unit quad (corners in attributes 0 and 1 as uint8,
+// drawn with the quad indices) and an empty VAO for attribute-less
+// full-screen triangles. Objects released
+// through handles are deleted only after a fence placed at the end of the
+// releasing frame has signaled, so in-flight draws keep their buffers.
+//
+// Held through shared_ptr like QuadIndexBuffer; Window keeps one alive and
+// calls endFrame from swapBuffers.
+class GLResources {
+  public:
+    enum class Kind { BUFFER, VERTEX_ARRAY, TEXTURE, FRAMEBUFFER, RENDERBUFFER, QUERY, COUNT };
+
+    static const int KIND_COUNT = static_cast<int>(Kind::COUNT);
+
+    struct Counts {
+      int live[KIND_COUNT];
+
+      int total() const;
+    };
+
+  private:
+    struct Released {
+      Kind kind;
+      GLuint name;
+    };
+
+    // Everything released during one frame, freed once its fence signals
+    struct Retired {
+      GLsync fence;
+      std::vector<Released> objects;
+    };
+
+    GLuint quadIndexBuffer;
+    GLuint unitQuadVAO;
+    GLuint unitQuadVBO;
+    GLuint fullscreenVAO;
+
+    std::vector<Released> releasing;
+    std::deque<Retired> retired;
+    int pendingDeletes;
+
+    std::map<std::string, Counts> owners;
+
+    GLResources();
+
+    static void destroy(Kind kind, GLuint name);
+
+  public:
+    ~GLResources();
+
+    static std::shared_ptr<GLResources> acquire();
+
+    // Shared meshes; never delete or modify these
+    GLuint getQuadIndexBuffer() const;
+    GLuint getUnitQuadVAO() const;
+    GLuint getUnitQuadBuffer() const;  // For VAOs that add their own instance attributes
+    GLuint getFullscreenVAO() const;
+
+    // Prefer GLObject, which pairs these
+    GLuint create(Kind kind, const char* owner);
+    void release(Kind kind, GLuint name, const char* owner);
+
+    // Fences this frame's releases and deletes those the GPU is done with
+    void endFrame();
+
+    Counts getCounts() const;
+    int getPendingDeletes() const;
+
+    // One line per owner, to stdout
+    void report() const;
+};
+
+// Move-only owner of one GL object created through the registry
+class GLObject {
+  private:
+    std::shared_ptr<GLResources> resources;
+    GLResources::Kind kind;
+    GLuint name;
+    const char* owner;
+
+  public:
+    GLObject();
+    GLObject(GLResources::Kind kind, const char* owner);
+    ~GLObject();
+
+    GLObject(GLObject&& other) noexcept;
+    GLObject& operator=(GLObject&& other) noexcept;
+
+    GLObject(const GLObject&) = delete;
+    GLObject& operator=(const GLObject&) = delete;
+
+    // Queues the object for deletion; 0 afterwards
+    void reset();
+
+    GLuint get() const;
+};
@@ -2,17 +2,72 @@
 #include <SDL2/SDL_stdinc.h>
 #include <SDL2/SDL_timer.h>
 #include <algorithm>
+#include <ctime>
 #include <memory>
 
+#include "DynamicTexture.h"
+#include "GLCapture.h"
+#include "GLDebug.h"
+#include "GLResources.h"
 #include "Game.h"
 #include "Location.h"
 #include "Tilemap.h"
 #include "Vector2.h"
 #include "WarpZone.h"
 
+// Player sight in tiles, in locations with fog of war
+const int FOG_VIEW_RADIUS = 10;
+
+// Second camera pan speed, in screen pixels per second at any zoom
+const float SCOUT_SPEED = 300.0f;
+
+// Picture-in-picture inset: a third of the screen, this far from the corner
+const int INSET_MARGIN = 8;
+
+// Holding SPACE fires a ring of projectiles every frame, turning as it goes
+const int FIRE_RING = 24;
+const float PROJECTILE_SPEED = 360.0f;
+const float PROJECTILE_LIFETIME = 3.0f;
+const int PROJECTILE_DAMAGE = 5;
+const float PROJECTILE_SIZE = 8.0f;
+
+// B fills the pool at once, to stress it
+const int PROJECTILE_BURST = 50000;
+
+// Projectiles hit enemies within this of their center
+const float ENEMY_HIT_RADIUS = 20.0f;
+
+// World units across the view at zoom 1, whatever the internal resolution
+const float VIEW_WORLD_WIDTH = 1920.0f;
+
+// Crowd steering keeps enemies about two of these apart
+const float ENEMY_CROWD_RADIUS = 16.0f;
+
+// H drops this many enemies in a ring around the player, to stress the crowd
+const int HORDE_SIZE = 2000;
+
 Game::Game() {
   isRunning = false;
   debugMode = false;
+  depthPrepass = true;
+  overdrawView = false;
+  showMinimap = true;
+  animationTime = 0.0f;
+  tileRenderMode = TileRenderMode::CHUNKED_MESH;
+  greedyMeshing = true;
+  impostorLod = true;
+  gpuCulling = false;
+  viewMode = ViewMode::SINGLE;
+  paused = false;
+  idleFrameSkipping = true;
+  firing = false;
+  burstRequested = false;
+  fireAngle = 0.0f;
+  hordeRequested = false;
+  framesSinceOverdrawReport = 0;
+  overdrawRatio = 0.0f;
+  statsFrames = 0;
+  statsElapsed = 0.0f;
 
   //  Create window
   window = std::make_unique<Window>("Game Engine", 1920, 1080);
@@ -21,14 +76,47 @@ Game::Game() {
     return;
   }
 
-  // Create camera
-  camera = std::make_unique<Camera>(1920, 1080);
+  // Render the scene at a low internal resolution, upscaled 3x to 1080p
+  window->setInternalResolution(640, 360);
+
+  // Create cameras; applyViewMode scales them to show VIEW_WORLD_WIDTH
+  camera = std::make_unique<Camera>(window->getInternalWidth(), window->getInternalHeight());
+  secondCamera = std::make_unique<Camera>(window->getInternalWidth(), window->getInternalHeight());
+  applyViewMode();
+
+  // Drop to as low as half resolution when the GPU goes over 12ms
+  gpuTimer = std::make_unique<GpuQuery>(GL_TIME_ELAPSED);
+  dynamicResolution = std::make_unique<DynamicResolution>(12.0f, 0.5f, 1.0f);
+
+  // Redraws at least once a second even when nothing changed
+  idleTracker = std::make_unique<IdleTracker>(1000);
+
+  // Counts shaded fragments to measure overdraw
+  overdrawQuery = std::make_unique<GpuQuery>(GL_SAMPLES_PASSED);
   camera->setWorldBounds(0.0f, 0.0f, 2400.0f, 1280.0f);
 
   // Create shaders
   tileShader = std::make_unique<Shader>("shaders/tile.vert", "shaders/tile.frag");
-  spriteShader = std::make_unique<Shader>("shaders/sprite.vert", "shaders/sprite.frag");
+  spriteShader = std::make_unique<Shader>("shaders/sprite_batch.vert", "shaders/sprite_batch.frag");
   debugLineShader = std::make_unique<Shader>("shaders/debug_line.vert", "shaders/debug_line.frag");
+  heatmapShader = std::make_unique<Shader>("shaders/heatmap.vert", "shaders/heatmap.frag");
+  hudShader = std::make_unique<Shader>("shaders/hud.vert", "shaders/hud.frag");
+  minimapShader = std::make_unique<Shader>("shaders/minimap.vert", "shaders/minimap.frag");
+  parallaxShader = std::make_unique<Shader>("shaders/parallax.vert", "shaders/parallax.frag");
+
+  // GL 4.3 path; without it everything stays on the 3.3 CPU-culled path
+  if (window->supportsGpuCulling()) {
+    tileCullShader = std::make_unique<ComputeShader>("shaders/tile_cull.comp");
+    spriteCullShader = std::make_unique<ComputeShader>("shaders/sprite_cull.comp");
+    gpuCulling = tileCullShader->isValid() && spriteCullShader->isValid();
+  }
+
+  spriteSorter = std::make_unique<SpriteSorter>();
+  enemies = std::make_unique<EnemySimulation>();
+  workers = std::make_unique<WorkerPool>();
+  crowd = std::make_unique<CrowdSteering>(ENEMY_CROWD_RADIUS, workers.get());
+  projectiles = std::make_unique<ProjectileSystem>();
+  targetGrid = std::make_unique<SpatialGrid>(64.0f);
 
   // Create input handler
   input = std::make_unique<Input>();
@@ -36,15 +124,42 @@ Game::Game() {
   // Load Textures
   tilesetTexture = std::make_unique<Texture>("assets/tile.png");
 
+  // The tileset has a single water tile, so its frames scroll it instead
+  tileAnimations = std::make_unique<TileAnimationTable>();
+  tileAnimations->add(WATER, {
+    { WATER, 0.25f, glm::vec2(0.00f, 0.0f) },
+    { WATER, 0.25f, glm::vec2(0.25f, 0.0f) },
+    { WATER, 0.25f, glm::vec2(0.50f, 0.0f) },
+    { WATER, 0.25f, glm::vec2(0.75f, 0.0f) },
+  });
+
   playerTexture = std::make_unique<Texture>("assets/player.png");
   enemyTexture = std::make_unique<Texture>("assets/enemy.png");
 
+  // No projectile art yet: the enemy sheet, shrunk and tinted
+  projectileSprite = std::make_unique<Sprite>(enemyTexture.get());
+
+  // Sheets are copied into array pages as sprites first use them
+  spriteTextures = std::make_unique<TextureArray>(1024, 512);
+  spriteBatch = std::make_unique<SpriteBatch>(spriteTextures.get());
+
   setupLocations();
+  applyGpuCulling();
   currentLocation = locations["farm"].get();
   currentLocation->onEnter();
 
   player = std::make_unique<Player>(400.0f, 300.0f, playerTexture.get());
 
+  hud = std::make_unique<HUD>();
+
+  minimap = std::make_unique<Minimap>();
+  minimap->setPaletteColor(GRASS, glm::vec4(0.30f, 0.60f, 0.25f, 1.0f));
+  minimap->setPaletteColor(DIRT,  glm::vec4(0.55f, 0.40f, 0.25f, 1.0f));
+  minimap->setPaletteColor(WATER, glm::vec4(0.20f, 0.40f, 0.80f, 1.0f));
+  minimap->setTilemap(currentLocation->getTilemap());
+  projectiles->setTilemap(currentLocation->getTilemap());
+  crowd->setTilemap(currentLocation->getTilemap());
+
   std::cout << "=== Game Intiliazed ===" << std::endl;
 };
 
@@ -58,55 +173,324 @@ void Game::setupLocations() {
       "farm", 60, 34, 32, tilesetTexture.get()
   );
   farm->addWarp(1888, 0, 32, 1088, "town", Vector2(50, 540));
+
+  // Slow water sky with a band of distant grass in front; one draw each
+  ParallaxLayer sky{
+    tilesetTexture.get(), glm::vec4(WATER * 32, 0, 32, 32), 4.0f,
+    glm::vec2(0.1f), glm::vec2(6.0f, 0.0f), glm::vec2(0.0f), true,
+    glm::vec4(0.45f, 0.55f, 0.75f, 1.0f)
+  };
+  ParallaxLayer hills{
+    tilesetTexture.get(), glm::vec4(GRASS * 32, 0, 32, 32), 3.0f,
+    glm::vec2(0.35f), glm::vec2(0.0f), glm::vec2(0.0f, 160.0f), false,
+    glm::vec4(0.35f, 0.45f, 0.35f, 1.0f)
+  };
+  farm->addBackgroundLayer(sky);
+  farm->addBackgroundLayer(hills);
   locations["farm"] = std::move(farm);
 
   auto town = std::make_unique<Location>(
       "town", 80, 40, 32, tilesetTexture.get()
   );
   town->addWarp(0, 0, 32, 1280, "farm", Vector2(1800,540));
+  // No dungeons yet; the town is explored under fog of war meanwhile
+  town->enableFogOfWar();
   locations["town"] = std::move(town);
+
+  // Every tile in the current tileset wraps seamlessly
+  for (auto& [id, location] : locations) {
+    Tilemap* tilemap = location->getTilemap();
+    tilemap->setRepeatable(GRASS, true);
+    tilemap->setRepeatable(DIRT, true);
+    tilemap->setRepeatable(WATER, true);
+    tilemap->setGreedyMeshing(greedyMeshing);
+  }
+}
+
+void Game::applyGpuCulling() {
+  ComputeShader* tileCull = gpuCulling ? tileCullShader.get() : nullptr;
+  ComputeShader* spriteCull = gpuCulling ? spriteCullShader.get() : nullptr;
+
+  for (auto& [id, location] : locations) {
+    location->getTilemap()->setGpuCulling(tileCull);
+  }
+  spriteBatch->setGpuCulling(spriteCull);
 }
 
 
 void Game::render() {
-  window->clear(0.1f, 0.1f, 0.2f);
-  currentLocation->render(*tileShader, *camera);
+  updateRenderScale();
+  gpuTimer->begin();
+
+  tileShader->use();
+  tileShader->setInt("tileAnimations", 1);
+  tileShader->setFloat("time", animationTime);
+  tileAnimations->bind(1);
 
-  // Draw all enemies
-  for (auto& enemy : enemies) {
-    enemy->render(*spriteShader, *camera);
+  views.setSceneTarget(window->getSceneTarget(), window->getRenderScale());
+  views.update();
+
+  // Stale chunk impostors render into their own target, so before the scene's
+  for (int i = 0; i < views.size(); i++) {
+    currentLocation->getTilemap()->bakeImpostors(*tileShader, views.getCamera(i));
+  }
+
+  glm::vec3 clearColor = overdrawView ? glm::vec3(0.0f) : glm::vec3(0.1f, 0.1f, 0.2f);
+
+  window->beginScene();
+  window->clear(clearColor.x, clearColor.y, clearColor.z);
+
+  // Views with a target of their own start from the same clear
+  for (int i = 0; i < views.size(); i++) {
+    if (views.get(i).target == nullptr) continue;
+    views.bind(i);
+    window->clear(clearColor.x, clearColor.y, clearColor.z);
   }
 
-  // Draw player on top
-  player->render(*spriteShader, *camera);
+  overdrawQuery->begin();
+  renderScene();
+  overdrawQuery->end();
 
   // Debug overlay
   if (debugMode) {
-    currentLocation->renderDebug(*debugLineShader, *camera);
+    GL_DEBUG_GROUP("Tile grid");
+    for (int i = 0; i < views.size(); i++) {
+      views.bind(i);
+      currentLocation->renderDebug(*debugLineShader, views.getCamera(i));
+    }
   }
 
+  // Insets land on top of the scene before it's upscaled
+  views.composite();
+
+  {
+    GL_DEBUG_GROUP("Present");
+    if (overdrawView) {
+      window->presentScene(*heatmapShader);
+    } else {
+      window->presentScene();
+    }
+  }
+
+  // Native resolution from here on
+  {
+    GL_DEBUG_GROUP("HUD");
+    hud->render(*hudShader, window->getWidth(), window->getHeight(),
+                *player, currentLocation, debugMode);
+  }
+  renderMinimap();
+
+  gpuTimer->end();
   window->swapBuffers();
+
+  reportOverdraw();
+}
+
+void Game::renderScene() {
+  GL_DEBUG_GROUP("Scene");
+
+  // Depth sort entities so whoever stands lower on screen draws in front
+  renderQueue.clear();
+  spriteSorter->clear();
+
+  for (int i = 0; i < enemies->size(); i++) {
+    renderQueue.push_back(&enemies->get(i));
+  }
+  renderQueue.push_back(player.get());
+
+  for (Entity* entity : renderQueue) {
+    spriteSorter->add(SpriteSorter::makeKey(entity->getLayer(), entity->getDepthY()));
+  }
+
+  // Depths spread over this frame's keys, so every key has to be in first
+  for (size_t i = 0; i < renderQueue.size(); i++) {
+    renderQueue[i]->setDepth(spriteSorter->keyToDepth(spriteSorter->getKey(i)));
+  }
+
+  const std::vector<uint32_t>& order = spriteSorter->sort();
+
+  tileShader->use();
+  tileShader->setInt("overdrawView", overdrawView);
+
+  // Fog of war on both tiles and sprites, if this location has it
+  FogOfWar* fog = currentLocation->getFogOfWar();
+  for (Shader* shader : { tileShader.get(), spriteShader.get() }) {
+    shader->use();
+    shader->setInt("fogEnabled", fog != nullptr);
+    shader->setInt("fogMask", 3);
+    if (fog != nullptr) shader->setVec2("fogWorldToUV", fog->getWorldToUV());
+  }
+  if (fog != nullptr) fog->bind(3);
+  glActiveTexture(GL_TEXTURE0);
+  spriteShader->use();
+  spriteShader->setInt("overdrawView", overdrawView);
+  parallaxShader->use();
+  parallaxShader->setInt("overdrawView", overdrawView);
+
+  spriteBatch->resetStats();
+  spriteBatch->begin(views);
+
+  // Overdraw view counts every shaded fragment with additive blending
+  glEnable(GL_BLEND);
+  if (overdrawView) {
+    glBlendFunc(GL_ONE, GL_ONE);
+  } else {
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  }
+
+  // Behind everything; it shows wherever the map doesn't cover, e.g. past
+  // its edges when zoomed out
+  currentLocation->renderBackground(*parallaxShader, views, animationTime);
+
+  if (!depthPrepass) {
+    // Painter's algorithm: everything back to front, nothing rejected
+    GL_DEBUG_GROUP("Back to front");
+    currentLocation->render(*tileShader, views);
+    for (uint32_t index : order) {
+      renderQueue[index]->render(*spriteBatch);
+    }
+    spriteBatch->flush(*spriteShader);
+    renderProjectiles();
+    return;
+  }
+
+  glEnable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  glDepthMask(GL_TRUE);
+
+  // Cutout sprites front to back in one draw; alpha is either 0 (discarded)
+  // or 1, so no blending is needed and hidden fragments fail the depth test
+  {
+    GL_DEBUG_GROUP("Cutout sprites");
+    if (!overdrawView) glDisable(GL_BLEND);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      Entity* entity = renderQueue[*it];
+      if (!entity->isTranslucent()) {
+        entity->render(*spriteBatch);
+      }
+    }
+    spriteBatch->flushCulled(*spriteShader);
+  }
+
+  // Ground only fills what the sprites left uncovered
+  {
+    GL_DEBUG_GROUP("Ground");
+    currentLocation->render(*tileShader, views);
+  }
+
+  // Truly translucent sprites back to front: tested, not written
+  {
+    GL_DEBUG_GROUP("Translucent sprites");
+    glDepthMask(GL_FALSE);
+    if (!overdrawView) glEnable(GL_BLEND);
+    for (uint32_t index : order) {
+      Entity* entity = renderQueue[index];
+      if (entity->isTranslucent()) {
+        entity->render(*spriteBatch);
+      }
+    }
+    spriteBatch->flush(*spriteShader);
+  }
+
+  glDepthMask(GL_TRUE);
+  glDisable(GL_DEPTH_TEST);
+  if (!overdrawView) {
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  }
+
+  renderProjectiles();
+
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+void Game::renderMinimap() {
+  if (!showMinimap) return;
+  GL_DEBUG_GROUP("Minimap");
+
+  int screenWidth = window->getWidth();
+  int screenHeight = window->getHeight();
+
+  minimap->render(*minimapShader, screenWidth, screenHeight, player->getPosition());
+
+  // Markers: each entity's current frame, shrunk onto the map, in one draw
+  glm::mat4 projection = glm::ortho(
+      0.0f, static_cast<float>(screenWidth),
+      static_cast<float>(screenHeight), 0.0f
+  );
+  spriteBatch->begin(projection);
+
+  float tileSize = static_cast<float>(currentLocation->getTilemap()->getTileSize());
+  float pixelsPerTile = minimap->getPixelsPerTile();
+
+  for (Entity* entity : renderQueue) {
+    const Sprite* sprite = entity->getSprite();
+    if (sprite == nullptr) continue;
+
+    // Keep markers readable when zoomed far out
+    Vector2 size = sprite->getSize();
+    float markerScale = std::max(pixelsPerTile / tileSize, 12.0f / size.y);
+    Vector2 markerSize(size.x * markerScale, size.y * markerScale);
+
+    Vector2 center(sprite->getPosition().x + size.x * 0.5f,
+                   sprite->getPosition().y + size.y * 0.5f);
+    Vector2 screen;
+    if (!minimap->worldToScreen(center, screen)) continue;
+
+    spriteBatch->submit(*sprite,
+                        Vector2(screen.x - markerSize.x * 0.5f, screen.y - markerSize.y * 0.5f),
+                        markerSize, 0.0f);
+  }
+
+  spriteShader->use();
+  spriteShader->setInt("overdrawView", 0);
+  spriteShader->setInt("fogEnabled", 0);
+  spriteBatch->flush(*spriteShader);
+}
+
+void Game::reportOverdraw() {
+  if (!overdrawQuery->poll()) return;
+
+  float pixels = static_cast<float>(window->getSceneWidth() * window->getSceneHeight());
+  overdrawRatio = overdrawQuery->getLastResult() / pixels;
+
+  if (!overdrawView) return;
+
+  // Print about once a second while the heatmap is up
+  if (++framesSinceOverdrawReport < 60) return;
+  framesSinceOverdrawReport = 0;
+
+  std::cout << "Overdraw: " << overdrawRatio << "x"
+            << " (" << (depthPrepass ? "depth pre-pass" : "back to front") << ")" << std::endl;
+}
+
+void Game::updateRenderScale() {
+  if (!gpuTimer->poll()) return;
+
+  if (dynamicResolution->update(gpuTimer->getLastMs())) {
+    window->setRenderScale(dynamicResolution->getScale());
+    std::cout << "Render scale: " << dynamicResolution->getScale()
+              << " (GPU " << dynamicResolution->getAverageMs() << "ms)" << std::endl;
+  }
 }
 
 void Game::update(float deltaTime) {
+  // Mirror any tile edits into the minimap texture
+  minimap->update();
+
   // Hot-reload shaders
   tileShader->checkReload();
   spriteShader->checkReload();
 
-  // Hot-reload textures
+  // Hot-reload textures (array pages hold copies, so refresh them too)
   tilesetTexture->checkReload();
-  playerTexture->checkReload();
-  enemyTexture->checkReload();
+  if (playerTexture->checkReload()) spriteTextures->refresh(playerTexture.get());
+  if (enemyTexture->checkReload()) spriteTextures->refresh(enemyTexture.get());
 
-  player->update(deltaTime);
-
-  // Update all enemies and make them chase the player
-  for (auto& enemy : enemies) {
-    enemy->setTarget(player->getPosition());
-    enemy->update(deltaTime);
-  }
-
-  checkWarpCollisions();
+  // Paused, the world (animations included) holds still; the cameras,
+  // views and hot-reload keep working
+  if (!paused) updateWorld(deltaTime);
 
   // Center camera on player (with boundary clamping)
   camera->setWorldBounds(
@@ -116,6 +500,38 @@ void Game::update(float deltaTime) {
   );
   camera->centerOn(player->getPosition());
 
+  // The second view pans freely inside the same bounds
+  if (viewMode != ViewMode::SINGLE) {
+    float step = SCOUT_SPEED / secondCamera->getZoom() * deltaTime;
+    secondCamera->setWorldBounds(
+        0, 0,
+        currentLocation->getWorldWidth(),
+        currentLocation->getWorldHeight()
+    );
+    secondCamera->centerOn(secondCamera->getPosition() + input->getSecondaryMovementInput() * step);
+  }
+
+}
+
+void Game::updateWorld(float deltaTime) {
+  // Wrapped so float precision holds up in long sessions
+  animationTime = std::fmod(animationTime + deltaTime, 3600.0f);
+
+  player->update(deltaTime);
+
+  updateEnemies(deltaTime);
+  updateProjectiles(deltaTime);
+
+  checkWarpCollisions();
+
+  // Vision follows the player's feet
+  if (FogOfWar* fog = currentLocation->getFogOfWar()) {
+    Vector2 feet = player->getPosition();
+    feet.y = player->getDepthY();
+    fog->setViewer(0, feet, FOG_VIEW_RADIUS);
+    fog->update();
+  }
+
   // Clean up dead enemies
   removeDeadEntities();
 
@@ -125,6 +541,183 @@ void Game::update(float deltaTime) {
   }
 }
 
+void Game::updateEnemies(float deltaTime) {
+  if (hordeRequested) {
+    hordeRequested = false;
+    spawnHorde();
+  }
+
+  // Enemies chase the player; the simulation decides which ones tick.
+  // Views reach as far as their corners, however far out they're zoomed.
+  auto viewFocus = [](const Camera& view) {
+    glm::vec4 rect = view.getViewRect();
+    Vector2 center((rect.x + rect.z) * 0.5f, (rect.y + rect.w) * 0.5f);
+    return EnemySimulation::Focus{ center, Vector2(rect.z - rect.x, rect.w - rect.y).length() * 0.5f };
+  };
+  simulationFocus.clear();
+  simulationFocus.push_back(EnemySimulation::Focus{ player->getPosition(), 0.0f });
+  simulationFocus.push_back(viewFocus(*camera));
+  if (viewMode != ViewMode::SINGLE) simulationFocus.push_back(viewFocus(*secondCamera));
+
+  // The crowd works on sprite centers
+  Vector2 target = player->getPosition();
+  Vector2 crowdTarget = target + player->getSprite()->getSize() * 0.5f;
+  crowd->clear();
+  crowdEnemies.clear();
+  auto addAgent = [this, &crowdTarget](Enemy& enemy, float step) {
+    Vector2 center = enemy.getPosition() + enemy.getSprite()->getSize() * 0.5f;
+    crowd->add(center, enemy.getVelocity(), crowdTarget, enemy.getSpeed(), step);
+    crowdEnemies.push_back(&enemy);
+  };
+
+  enemies->update(deltaTime, simulationFocus,
+    [&](Enemy& enemy, float step) {
+      enemy.setTarget(target);
+      enemy.updateHurtFlash(step);
+      addAgent(enemy, step);
+    },
+    [&](Enemy& enemy) { addAgent(enemy, 0.0f); });
+
+  crowd->step();
+  for (size_t i = 0; i < crowdEnemies.size(); i++) {
+    Enemy& enemy = *crowdEnemies[i];
+    enemy.setMotion(crowd->getPosition(i) - enemy.getSprite()->getSize() * 0.5f, crowd->getVelocity(i));
+  }
+
+  // Idle is judged on where the crowd left them, not the tick's own motion.
+  // Resting ones stay in the crowd as obstacles.
+  enemies->restIdle();
+}
+
+void Game::spawnHorde() {
+  // A ring just off screen, at a few speeds so the crowd spreads out
+  Vector2 center = player->getPosition();
+  for (int i = 0; i < HORDE_SIZE; i++) {
+    float angle = i * 2.3999632f;
+    float distance = 400.0f + (i % 16) * 24.0f;
+    float speed = 30.0f + (i % 5) * 10.0f;
+    enemies->add(std::make_unique<Enemy>("Horde", center.x + std::cos(angle) * distance,
+                                         center.y + std::sin(angle) * distance, 5, speed, enemyTexture.get()));
+  }
+  std::cout << "Horde spawned: " << HORDE_SIZE << " (" << enemies->size() << " enemies)" << std::endl;
+}
+
+void Game::updateProjectiles(float deltaTime) {
+  Vector2 muzzle = player->getPosition() + player->getSprite()->getSize() * 0.5f;
+  const float turn = 6.2831853f / FIRE_RING;
+
+  if (firing) {
+    for (int i = 0; i < FIRE_RING; i++) {
+      float angle = fireAngle + i * turn;
+      Vector2 velocity(std::cos(angle) * PROJECTILE_SPEED, std::sin(angle) * PROJECTILE_SPEED);
+      projectiles->spawn(muzzle, velocity, PROJECTILE_LIFETIME, PROJECTILE_DAMAGE, 3.0f, 0xFF40C0FF);
+    }
+    fireAngle = std::fmod(fireAngle + turn * 0.37f, 6.2831853f);
+  }
+
+  // A spiral of speeds and directions, so the burst spreads out
+  if (burstRequested) {
+    burstRequested = false;
+    int spawned = 0;
+    for (int i = 0; i < PROJECTILE_BURST; i++) {
+      float angle = i * 2.3999632f;
+      float speed = PROJECTILE_SPEED * (0.25f + (i % 64) / 64.0f);
+      Vector2 velocity(std::cos(angle) * speed, std::sin(angle) * speed);
+      if (!projectiles->spawn(muzzle, velocity, PROJECTILE_LIFETIME * 2.0f, PROJECTILE_DAMAGE, 3.0f, 0xFF4080FF)) break;
+      spawned++;
+    }
+    std::cout << "Projectile burst: " << spawned << " (" << projectiles->size() << " live)" << std::endl;
+  }
+
+  // Enemies by the center of their sprite; pointers, since damage can
+  // wake enemies and reorder the simulation's lists
+  targetEnemies.clear();
+  targetX.clear();
+  targetY.clear();
+  for (int i = 0; i < enemies->size(); i++) {
+    Enemy& enemy = enemies->get(i);
+    if (!enemy.getIsActive()) continue;
+
+    Vector2 center = enemy.getPosition() + enemy.getSprite()->getSize() * 0.5f;
+    targetEnemies.push_back(&enemy);
+    targetX.push_back(center.x);
+    targetY.push_back(center.y);
+  }
+  targetGrid->build(targetX.data(), targetY.data(), targetX.size(),
+                    glm::vec4(0.0f, 0.0f, currentLocation->getWorldWidth(), currentLocation->getWorldHeight()));
+
+  projectiles->update(deltaTime, targetGrid.get(), ENEMY_HIT_RADIUS);
+
+  for (const ProjectileHit& hit : projectiles->getHits()) {
+    if (hit.target >= 0) enemies->damage(*targetEnemies[hit.target], hit.damage);
+  }
+}
+
+void Game::renderProjectiles() {
+  if (projectiles->size() == 0) return;
+  GL_DEBUG_GROUP("Projectiles");
+
+  // Over everything in the scene, one instanced draw
+  projectiles->render(*spriteBatch, *projectileSprite, views.getUnionRect(),
+                      Vector2(PROJECTILE_SIZE, PROJECTILE_SIZE), 0.0f);
+  spriteBatch->flush(*spriteShader);
+}
+
+bool Game::frameChanged() {
+  idleTracker->beginFrame();
+
+  // Not worth hashing: key toggles, resizes, window exposure, streamed
+  // texture uploads and captures waiting on frames
+  if (!idleFrameSkipping || input->hadEvents() || DynamicTexture::getFrameBytes() > 0 ||
+      window->getScreenCapture()->isBusy()) {
+    idleTracker->invalidate();
+  }
+
+  idleTracker->add(window->getWidth());
+  idleTracker->add(window->getHeight());
+  idleTracker->add(window->getRenderScale());
+
+  for (int i = 0; i < views.size(); i++) {
+    const Camera& view = views.getCamera(i);
+    idleTracker->add(view.getPosition().x);
+    idleTracker->add(view.getPosition().y);
+    idleTracker->add(view.getZoom());
+  }
+  idleTracker->add(secondCamera->getPosition().x);
+  idleTracker->add(secondCamera->getPosition().y);
+
+  // Tiles: edits bump the revision; animations only matter on frame changes
+  idleTracker->add(currentLocation->getId());
+  idleTracker->add(currentLocation->getTilemap()->getRevision());
+  tileAnimations->getCurrentFrames(animationTime, tileAnimationFrames);
+  for (int frame : tileAnimationFrames) idleTracker->add(frame);
+  if (currentLocation->hasAnimatedBackground()) idleTracker->add(animationTime);
+
+  auto addEntity = [this](const Entity& entity) {
+    idleTracker->add(entity.getPosition().x);
+    idleTracker->add(entity.getPosition().y);
+    idleTracker->add(entity.getLayer());
+    idleTracker->add(entity.isTranslucent());
+    if (const Sprite* sprite = entity.getSprite()) {
+      idleTracker->add(sprite->getUVOffset().x);
+      idleTracker->add(sprite->getUVOffset().y);
+    }
+  };
+  addEntity(*player);
+  for (int i = 0; i < enemies->size(); i++) addEntity(enemies->get(i));
+  idleTracker->add(enemies->size());
+
+  // Projectiles only move when a fixed step ran
+  idleTracker->add(static_cast<int>(projectiles->size()));
+  if (projectiles->size() > 0) idleTracker->add(projectiles->getStepCount());
+
+  // HUD: everything it draws from
+  idleTracker->add(player->getHealth());
+  if (debugMode) idleTracker->add(debugText);
+
+  return idleTracker->shouldRender(SDL_GetTicks());
+}
+
 void Game::run() {
   isRunning = true;
   lastFrameTime = SDL_GetTicks();
@@ -146,10 +739,93 @@ void Game::run() {
 
     processInput();
     update(deltaTime);
-    render();
+    updateFrameStats(deltaTime);
+
+    if (frameChanged()) {
+      render();
+    } else {
+      // Nothing would change on screen: sleep until input or the next
+      // check instead of spinning (skipped frames don't wait on vsync)
+      SDL_WaitEventTimeout(nullptr, static_cast<int>(idleTracker->getWaitMs(SDL_GetTicks())));
+    }
 
     changeLocation();
   }
+
+  std::cout << "Idle frames skipped: " << idleTracker->getSkippedFrames() << std::endl;
+}
+
+void Game::updateFrameStats(float deltaTime) {
+  statsFrames++;
+  statsElapsed += deltaTime;
+
+  // Refresh a few times a second so the HUD is not rebuilt every frame
+  if (statsElapsed < 0.25f) return;
+
+  std::ostringstream text;
+  text.setf(std::ios::fixed);
+  text.precision(1);
+
+  text << "FPS " << statsFrames / statsElapsed
+       << "  frame " << statsElapsed * 1000.0f / statsFrames << "ms"
+       << "  GPU " << gpuTimer->getLastMs() << "ms\n";
+  text << "scale " << window->getRenderScale() * 100.0f << "% ("
+       << window->getSceneWidth() << "x" << window->getSceneHeight() << ")"
+       << "  overdraw " << overdrawRatio << "x\n";
+  text << "sprites " << spriteBatch->getSpritesDrawn()
+       << " in " << spriteBatch->getDrawCalls() << " draws"
+       << "  HUD rebuilds " << hud->getRebuildCount()
+       << "  minimap texels " << minimap->getTexelsUploaded() << "\n";
+  text << "tile verts " << currentLocation->getTilemap()->getVertexCount()
+       << " (chunk rebuilds " << currentLocation->getTilemap()->getChunkRebuilds() << ")"
+       << "  culling " << (gpuCulling ? "GPU" : "CPU");
+  if (FogOfWar* fog = currentLocation->getFogOfWar()) {
+    text << "  fog texels " << fog->getTexelsUploaded();
+  }
+  text << "  texture upload " << DynamicTexture::getLastFrameBytes() / 1024 << " KB";
+  text << "\nviews " << views.size()
+       << "  zoom " << camera->getZoom() * 100.0f << "%"
+       << (currentLocation->getTilemap()->usesImpostors(*camera) ? " (impostors)" : "")
+       << "  impostor bakes " << currentLocation->getTilemap()->getImpostorBakes();
+
+  EnemySimulation::Stats simulation = enemies->getStats();
+  text << "\nenemies awake " << simulation.awake << " (ticked " << simulation.ticked
+       << ", resting " << simulation.resting << ")"
+       << "  sleeping " << simulation.sleeping << "  woken " << simulation.woken
+       << "  crowd " << crowd->size() << " (" << workers->getThreadCount() << " threads)";
+  text << "  projectiles " << projectiles->size() << " (hits " << projectiles->getHits().size() << ")";
+
+  std::shared_ptr<GLResources> resources = GLResources::acquire();
+  GLResources::Counts objects = resources->getCounts();
+  text << "\nGL objects " << objects.total()
+       << " (buffers " << objects.live[static_cast<int>(GLResources::Kind::BUFFER)]
+       << ", VAOs " << objects.live[static_cast<int>(GLResources::Kind::VERTEX_ARRAY)]
+       << ", textures " << objects.live[static_cast<int>(GLResources::Kind::TEXTURE)] << ")"
+       << "  pending delete " << resources->getPendingDeletes();
+
+  ScreenCapture* screenCapture = window->getScreenCapture();
+  if (screenCapture->isStreaming()) {
+    text << "\nrecording " << screenCapture->getFramesWritten() << " frames"
+         << " (dropped " << screenCapture->getFramesDropped() << ")";
+  }
+  if (GLDebug::isInstalled()) {
+    GLDebug::Counters warnings = GLDebug::getLastFrame();
+    text << "\nGL perf warnings " << warnings.performanceTotal()
+         << " (stalls " << warnings.bufferStalls
+         << ", recompiles " << warnings.recompiles
+         << ", redundant " << warnings.redundantState << ")"
+         << "  errors " << warnings.errors
+         << "  total " << GLDebug::getTotals().performanceTotal();
+  }
+
+  text << "\nidle skipped " << idleTracker->getSkippedFrames()
+       << (idleFrameSkipping ? "" : " (off)") << (paused ? "  PAUSED" : "");
+
+  debugText = text.str();
+  hud->setDebugText(debugText);
+
+  statsFrames = 0;
+  statsElapsed = 0.0f;
 }
 
 void Game::stop() {
@@ -164,6 +840,55 @@ void Game::checkWarpCollisions() {
   }
 }
 
+void Game::applyViewMode() {
+  int width = window->getInternalWidth();
+  int height = window->getInternalHeight();
+
+  // The render target got smaller, not the world: every view keeps the
+  // full-resolution world extent per pixel
+  float pixelScale = width / VIEW_WORLD_WIDTH;
+  camera->setPixelScale(pixelScale);
+  secondCamera->setPixelScale(pixelScale);
+
+  views.clear();
+
+  switch (viewMode) {
+    case ViewMode::SINGLE:
+      camera->setViewportSize(width, height);
+      views.add(*camera);
+      break;
+
+    case ViewMode::SPLIT_SCREEN:
+      // Side by side in the scene target; disjoint, so they share its depth
+      camera->setViewportSize(width / 2, height);
+      secondCamera->setViewportSize(width - width / 2, height);
+      views.add(*camera);
+      views.add(*secondCamera, width / 2, 0);
+      break;
+
+    case ViewMode::PICTURE_IN_PICTURE: {
+      // Overlaps the main view, so it gets its own target and depth buffer
+      int insetWidth = width / 3;
+      int insetHeight = height / 3;
+      if (pictureTarget) {
+        pictureTarget->resize(insetWidth, insetHeight);
+      } else {
+        pictureTarget = std::make_unique<RenderTarget>(insetWidth, insetHeight, true);
+      }
+
+      camera->setViewportSize(width, height);
+      secondCamera->setViewportSize(insetWidth, insetHeight);
+      views.add(*camera);
+      views.add(*secondCamera, width - insetWidth - INSET_MARGIN, INSET_MARGIN, pictureTarget.get());
+      break;
+    }
+  }
+
+  if (viewMode != ViewMode::PICTURE_IN_PICTURE) pictureTarget.reset();
+
+  std::cout << "Views: " << views.size() << std::endl;
+}
+
 void Game::changeLocationRequest(const std::string& id, const Vector2& spawnPos) {
   pendingLocationId = id;
   pendingSpawnPosition = spawnPos;
@@ -183,6 +908,12 @@ void Game::changeLocation() {
   currentLocation->onExit();
   currentLocation = it->second.get();
   currentLocation->onEnter();
+  minimap->setTilemap(currentLocation->getTilemap());
+
+  // In flight ones don't follow the player through the warp
+  projectiles->clear();
+  projectiles->setTilemap(currentLocation->getTilemap());
+  crowd->setTilemap(currentLocation->getTilemap());
 
   player->setPosition(pendingSpawnPosition);
   locationChangeRequested = false;
@@ -200,16 +931,137 @@ void Game::processInput() {
     int newWidth = input->getNewWindowWidth();
     int newHeight = input->getNewWindowHeight();
 
+    // The scene keeps its internal resolution; only the upscale changes
     window->handleResize(newWidth, newHeight);
-    camera->setViewportSize(newWidth, newHeight);
+    applyViewMode();
   }
 
   // Toggle debug mode
   if (input->wasKeyPressed(SDLK_F3)) {
     debugMode = !debugMode;
     std::cout << "Debug mode: " << (debugMode ? "ON" : "OFF") << std::endl;
+    if (debugMode) GLResources::acquire()->report();
+  }
+
+  // Overdraw heatmap and depth pre-pass toggles, to compare the two paths
+  if (input->wasKeyPressed(SDLK_F4)) {
+    overdrawView = !overdrawView;
+    std::cout << "Overdraw view: " << (overdrawView ? "ON" : "OFF") << std::endl;
+  }
+
+  if (input->wasKeyPressed(SDLK_F5)) {
+    depthPrepass = !depthPrepass;
+    std::cout << "Depth pre-pass: " << (depthPrepass ? "ON" : "OFF") << std::endl;
+  }
+
+  // Switch how the ground layer is drawn
+  if (input->wasKeyPressed(SDLK_F6)) {
+    tileRenderMode = tileRenderMode == TileRenderMode::CHUNKED_MESH
+        ? TileRenderMode::INDEX_TEXTURE
+        : TileRenderMode::CHUNKED_MESH;
+
+    for (auto& [id, location] : locations) {
+      location->setTileRenderMode(tileRenderMode);
+    }
+
+    std::cout << "Tile render mode: "
+              << (tileRenderMode == TileRenderMode::CHUNKED_MESH ? "chunked mesh" : "index texture")
+              << std::endl;
+  }
+
+  // Greedy meshing on/off, to compare vertex counts
+  if (input->wasKeyPressed(SDLK_F7)) {
+    greedyMeshing = !greedyMeshing;
+
+    for (auto& [id, location] : locations) {
+      location->getTilemap()->setGreedyMeshing(greedyMeshing);
+    }
+
+    std::cout << "Greedy meshing: " << (greedyMeshing ? "ON" : "OFF") << std::endl;
   }
 
+  // Impostor LOD on/off, to compare zoomed-out frame times
+  if (input->wasKeyPressed(SDLK_F10)) {
+    impostorLod = !impostorLod;
+
+    for (auto& [id, location] : locations) {
+      location->getTilemap()->setImpostorLod(impostorLod);
+    }
+
+    std::cout << "Impostor LOD: " << (impostorLod ? "ON" : "OFF") << std::endl;
+  }
+
+  // GPU culling on/off, where supported, to compare against the CPU path
+  if (input->wasKeyPressed(SDLK_F8) && tileCullShader && spriteCullShader) {
+    gpuCulling = !gpuCulling && tileCullShader->isValid() && spriteCullShader->isValid();
+    applyGpuCulling();
+    std::cout << "GPU culling: " << (gpuCulling ? "ON" : "OFF") << std::endl;
+  }
+
+  // Start a requested GL capture on this frame rather than after the skip
+  if (input->wasKeyPressed(SDLK_F9)) {
+    GLCapture::trigger();
+  }
+
+  // Screenshot, and start/stop recording (read back without stalling)
+  ScreenCapture* screenCapture = window->getScreenCapture();
+  if (input->wasKeyPressed(SDLK_F12)) {
+    screenCapture->screenshot("screenshot_" + std::to_string(std::time(nullptr)) + ".png");
+  }
+
+  if (input->wasKeyPressed(SDLK_F11)) {
+    if (screenCapture->isStreaming()) {
+      screenCapture->stopStream();
+    } else {
+      screenCapture->startStream("recording_" + std::to_string(std::time(nullptr)) + ".y4m",
+                                 ScreenCapture::StreamFormat::Y4M);
+    }
+  }
+
+  // Single view, split-screen, picture-in-picture
+  if (input->wasKeyPressed(SDLK_TAB)) {
+    switch (viewMode) {
+      case ViewMode::SINGLE: viewMode = ViewMode::SPLIT_SCREEN; break;
+      case ViewMode::SPLIT_SCREEN: viewMode = ViewMode::PICTURE_IN_PICTURE; break;
+      case ViewMode::PICTURE_IN_PICTURE: viewMode = ViewMode::SINGLE; break;
+    }
+
+    // Scouting starts from the player; the inset shows an overview
+    secondCamera->setPosition(player->getPosition());
+    secondCamera->setZoom(viewMode == ViewMode::PICTURE_IN_PICTURE ? 0.25f : camera->getZoom());
+    applyViewMode();
+  }
+
+  // Pause freezes the world, so idle frame skipping can kick in
+  if (input->wasKeyPressed(SDLK_p)) {
+    paused = !paused;
+    std::cout << "Paused: " << (paused ? "ON" : "OFF") << std::endl;
+  }
+
+  if (input->wasKeyPressed(SDLK_F2)) {
+    idleFrameSkipping = !idleFrameSkipping;
+    std::cout << "Idle frame skipping: " << (idleFrameSkipping ? "ON" : "OFF") << std::endl;
+  }
+
+  // Minimap toggle and zoom
+  if (input->wasKeyPressed(SDLK_m)) {
+    showMinimap = !showMinimap;
+  }
+
+  if (input->wasKeyPressed(SDLK_EQUALS)) minimap->zoomIn();
+  if (input->wasKeyPressed(SDLK_MINUS)) minimap->zoomOut();
+
+  // Camera zoom: a quarter octave per wheel notch, 0 back to 1:1
+  if (int wheel = input->getWheelDelta()) {
+    camera->setZoom(camera->getZoom() * std::exp2(wheel * 0.25f));
+  }
+  if (input->wasKeyPressed(SDLK_0)) camera->setZoom(1.0f);
+
+  // Fire while SPACE is held; B for a burst
+  firing = input->isKeyDown(SDL_SCANCODE_SPACE);
+  if (input->wasKeyPressed(SDLK_b)) burstRequested = true;
+  if (input->wasKeyPressed(SDLK_h)) hordeRequested = true;
+
   // Get movement from WASD/Arrow keys
   Vector2 movement = input->getMovementInput();
   player->move(movement);
@@ -223,22 +1075,12 @@ void Game::spawnEnemy(const std::string& name, float x, float y, int damage, flo
     // Create a new enemy and add it to our list
     auto enemy = std::make_unique<Enemy>(name, x, y, damage, speed, enemyTexture.get());
     // Move the enemy into our vector
-    enemies.push_back(std::move(enemy));
+    enemies->add(std::move(enemy));
     std::cout << "Spawned: " << name << " at (" << x << ", " << y << ")" << std::endl;
 }
 
 void Game::removeDeadEntities() {
-  // Remove all interactive enemies using erase-remove idiom
-  enemies.erase(
-      std::remove_if(
-        enemies.begin(),
-        enemies.end(),
-        [](const std::unique_ptr<Enemy>& e) {
-          return !e->getIsActive();
-        }
-      ),
-
-      enemies.end()
-  );
+  // Awake or asleep
+  enemies->removeInactive();
 }
 
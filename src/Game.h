@@ -5,14 +5,30 @@
 
 #include "Camera.h"
 #include "Common.h"
+#include "ComputeShader.h"
+#include "CrowdSteering.h"
+#include "DynamicResolution.h"
 #include "Enemy.h"
+#include "EnemySimulation.h"
+#include "GpuQuery.h"
+#include "HUD.h"
+#include "IdleTracker.h"
 #include "Input.h"
 #include "Location.h"
+#include "Minimap.h"
 #include "Player.h"
+#include "ProjectileSystem.h"
 #include "Shader.h"
+#include "SpatialGrid.h"
+#include "SpriteBatch.h"
+#include "SpriteSorter.h"
 #include "Texture.h"
+#include "TextureArray.h"
+#include "TileAnimationTable.h"
 #include "Vector2.h"
+#include "ViewSet.h"
 #include "Window.h"
+#include "WorkerPool.h"
 
 class Game {
 private:
@@ -23,17 +39,115 @@ private:
   std::unique_ptr<Shader> tileShader;
   std::unique_ptr<Shader> spriteShader;
   std::unique_ptr<Shader> debugLineShader;
+  std::unique_ptr<Shader> heatmapShader;
+  std::unique_ptr<Shader> hudShader;
+  std::unique_ptr<Shader> minimapShader;
+  std::unique_ptr<Shader> parallaxShader;
 
   std::unique_ptr<Texture> tilesetTexture;
   std::unique_ptr<Texture> playerTexture;
   std::unique_ptr<Texture> enemyTexture;
 
+  // Animated tiles are resolved in the tile shader from this and the time
+  std::unique_ptr<TileAnimationTable> tileAnimations;
+  float animationTime;
+  TileRenderMode tileRenderMode;
+  bool greedyMeshing;
+
+  // Zoomed out, chunks draw from prebaked impostors instead of tiles
+  bool impostorLod;
+
+  // GPU-driven culling and indirect draws, when the context supports them
+  std::unique_ptr<ComputeShader> tileCullShader;
+  std::unique_ptr<ComputeShader> spriteCullShader;
+  bool gpuCulling;
+  void applyGpuCulling();
+
+  // Every sprite sheet lives in one array so entities batch into one draw
+  std::unique_ptr<TextureArray> spriteTextures;
+  std::unique_ptr<SpriteBatch> spriteBatch;
+
   std::unique_ptr<Player> player;
-  std::vector<std::unique_ptr<Enemy>> enemies;
+
+  // Enemies tick by distance to the player and the cameras; far and idle
+  // ones sleep (see EnemySimulation)
+  std::unique_ptr<EnemySimulation> enemies;
+  std::vector<EnemySimulation::Focus> simulationFocus;
+
+  // The ones that tick steer as a crowd around the player, in parallel
+  // chunks; awake ones that skip the step still take up room
+  std::unique_ptr<WorkerPool> workers;
+  std::unique_ptr<CrowdSteering> crowd;
+  std::vector<Enemy*> crowdEnemies;
+  bool hordeRequested;
+  void updateEnemies(float deltaTime);
+  void spawnHorde();
+
+  // Projectiles live in one pool, not as entities. Enemies are indexed in
+  // a grid each frame for them to hit.
+  std::unique_ptr<ProjectileSystem> projectiles;
+  std::unique_ptr<SpatialGrid> targetGrid;
+  std::vector<Enemy*> targetEnemies;
+  std::vector<float> targetX, targetY;
+  std::unique_ptr<Sprite> projectileSprite;
+  bool firing;
+  bool burstRequested;
+  float fireAngle;
+  void updateProjectiles(float deltaTime);
+  void renderProjectiles();
+
+  // Depth sorting (rebuilt every frame, storage reused)
+  std::unique_ptr<SpriteSorter> spriteSorter;
+  std::vector<Entity*> renderQueue;
+
+  // Overdraw: cutout sprites go front to back against the depth buffer
+  bool depthPrepass;
+  bool overdrawView;
+  std::unique_ptr<GpuQuery> overdrawQuery;
+  int framesSinceOverdrawReport;
+  float overdrawRatio;
+  void renderScene();
+  void reportOverdraw();
 
   std::unique_ptr<Camera> camera;
   Location* currentLocation;
 
+  // Split-screen and picture-in-picture add a second camera, panned with
+  // IJKL. Both views share one pass over the scene (see ViewSet).
+  enum class ViewMode { SINGLE, SPLIT_SCREEN, PICTURE_IN_PICTURE };
+  ViewMode viewMode;
+  std::unique_ptr<Camera> secondCamera;
+  std::unique_ptr<RenderTarget> pictureTarget;  // Inset view, with its own depth
+  ViewSet views;
+  void applyViewMode();
+
+  // Screen-space overlay, drawn at native resolution after the upscale
+  std::unique_ptr<HUD> hud;
+
+  // Tile overview texture plus entity markers, top-right
+  std::unique_ptr<Minimap> minimap;
+  bool showMinimap;
+  void renderMinimap();
+
+  // Frame stats for the F3 debug text
+  int statsFrames;
+  float statsElapsed;
+  std::string debugText;
+  void updateFrameStats(float deltaTime);
+
+  // Frames identical to the last one drawn are skipped (no render, no
+  // swap) and the loop sleeps until input or the heartbeat instead
+  std::unique_ptr<IdleTracker> idleTracker;
+  bool idleFrameSkipping;
+  bool paused;
+  std::vector<int> tileAnimationFrames;
+  bool frameChanged();
+
+  // Dynamic resolution
+  std::unique_ptr<GpuQuery> gpuTimer;
+  std::unique_ptr<DynamicResolution> dynamicResolution;
+  void updateRenderScale();
+
   // Game loop
   bool isRunning;
   bool debugMode;
@@ -41,6 +155,7 @@ private:
 
   void processInput();
   void update(float deltaTime);
+  void updateWorld(float deltaTime);
   void render();
 
   // Location
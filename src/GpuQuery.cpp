@@ -0,0 +1,58 @@
+#include "GpuQuery.h"
+
+namespace {
+  const char* OWNER = "GpuQuery";
+}
+
+GpuQuery::GpuQuery(GLenum target)
+  : target(target),
+    writeIndex(0),
+    readIndex(0),
+    lastResult(0)
+{
+  for (int i = 0; i < QUERY_COUNT; i++) {
+    queries[i] = GLObject(GLResources::Kind::QUERY, OWNER);
+    pending[i] = false;
+  }
+}
+
+void GpuQuery::begin() {
+  // Ring is full - drop this frame rather than reuse an unread query
+  if (pending[writeIndex]) return;
+
+  glBeginQuery(target, queries[writeIndex].get());
+}
+
+void GpuQuery::end() {
+  if (pending[writeIndex]) return;
+
+  glEndQuery(target);
+  pending[writeIndex] = true;
+  writeIndex = (writeIndex + 1) % QUERY_COUNT;
+}
+
+bool GpuQuery::poll() {
+  bool gotResult = false;
+
+  while (pending[readIndex]) {
+    GLint available = 0;
+    glGetQueryObjectiv(queries[readIndex].get(), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) break;
+
+    glGetQueryObjectui64v(queries[readIndex].get(), GL_QUERY_RESULT, &lastResult);
+
+    pending[readIndex] = false;
+    readIndex = (readIndex + 1) % QUERY_COUNT;
+    gotResult = true;
+  }
+
+  return gotResult;
+}
+
+GLuint64 GpuQuery::getLastResult() const {
+  return lastResult;
+}
+
+float GpuQuery::getLastMs() const {
+  return lastResult / 1000000.0f;
+}
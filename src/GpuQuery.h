@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+
+// Wraps a GL query (GL_TIME_ELAPSED, GL_SAMPLES_PASSED, ...) around a span
+// of commands. Results are read back a few frames late from a small ring
+// of query objects so the CPU never waits on the GPU.
+class GpuQuery {
+  private:
+    static const int QUERY_COUNT = 4;
+
+    GLenum target;
+    GLObject queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int writeIndex;
+    int readIndex;
+
+    GLuint64 lastResult;
+
+  public:
+    GpuQuery(GLenum target = GL_TIME_ELAPSED);
+
+    void begin();
+    void end();
+
+    // Collects finished queries. Returns true when a new result arrived.
+    bool poll();
+
+    // Getters
+    GLuint64 getLastResult() const;
+    float getLastMs() const;  // For GL_TIME_ELAPSED queries
+};
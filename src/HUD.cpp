@@ -0,0 +1,244 @@
+#include "HUD.h"
+#include <algorithm>
+
+namespace {
+  const char* OWNER = "HUD";
+
+  // Layout is authored for a 640x360 screen and scaled by whole pixels
+  const int REFERENCE_HEIGHT = 360;
+
+  const int BAR_WIDTH = 8;
+  const int BAR_HEIGHT = 60;
+  const int BAR_MARGIN = 6;
+  const int BAR_SPACING = 4;
+
+  // Stay bounded when debug text changes every few frames
+  const size_t MAX_CACHED_LAYOUTS = 256;
+
+  std::string makeLayoutKey(const std::string& text, const TextStyle& style) {
+    std::string key = text;
+    key.push_back('\0');
+    key.append(reinterpret_cast<const char*>(&style.scale), sizeof(style.scale));
+    key.append(reinterpret_cast<const char*>(&style.color), sizeof(style.color));
+    return key;
+  }
+}
+
+HUD::HUD()
+  : resources(GLResources::acquire()),
+    quadIndices(QuadIndexBuffer::acquire()),
+    instanceCapacity(0),
+    dirty(true),
+    cachedHealth(-1),
+    cachedMaxHealth(-1),
+    cachedScreenWidth(0),
+    cachedScreenHeight(0),
+    cachedDebugMode(false),
+    rebuildCount(0)
+{
+  font = std::make_unique<BitmapFont>();
+  setupMesh();
+}
+
+void HUD::setupMesh() {
+  VAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+  instanceVBO = GLObject(GLResources::Kind::BUFFER, OWNER);
+
+  glBindVertexArray(VAO.get());
+
+  // Shared unit quad; position doubles as the texture coordinate
+  glBindBuffer(GL_ARRAY_BUFFER, resources->getUnitQuadBuffer());
+
+  glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(1);
+
+  quadIndices->bind();
+
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.get());
+
+  glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, rect));
+  glEnableVertexAttribArray(2);
+  glVertexAttribDivisor(2, 1);
+
+  glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, uvRect));
+  glEnableVertexAttribArray(3);
+  glVertexAttribDivisor(3, 1);
+
+  glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, color));
+  glEnableVertexAttribArray(4);
+  glVertexAttribDivisor(4, 1);
+
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindVertexArray(0);
+}
+
+void HUD::setDebugText(const std::string& text) {
+  if (text == debugText) return;
+
+  // Hidden text is only stored; turning debug mode on rebuilds with it
+  debugText = text;
+  if (cachedDebugMode) dirty = true;
+}
+
+void HUD::render(Shader& shader, int screenWidth, int screenHeight,
+                 const Player& player, const Location* location, bool debugMode) {
+  std::string locationId = location ? location->getId() : "";
+
+  if (player.getHealth() != cachedHealth ||
+      player.getMaxHealth() != cachedMaxHealth ||
+      locationId != cachedLocationId ||
+      screenWidth != cachedScreenWidth ||
+      screenHeight != cachedScreenHeight ||
+      debugMode != cachedDebugMode) {
+    dirty = true;
+  }
+
+  if (dirty) {
+    rebuild(screenWidth, screenHeight, player, location, debugMode);
+    upload();
+  }
+
+  if (instances.empty()) return;
+
+  // Screen space: no view matrix, origin top-left
+  glm::mat4 projection = glm::ortho(
+      0.0f, static_cast<float>(screenWidth),
+      static_cast<float>(screenHeight), 0.0f
+  );
+
+  shader.use();
+  shader.setMat4("projection", projection);
+  shader.setInt("fontAtlas", 0);
+
+  font->bind(0);
+
+  glBindVertexArray(VAO.get());
+  glDrawElementsInstanced(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr,
+                          static_cast<GLsizei>(instances.size()));
+  glBindVertexArray(0);
+
+  font->unbind();
+}
+
+void HUD::rebuild(int screenWidth, int screenHeight, const Player& player,
+                  const Location* location, bool debugMode) {
+  cachedHealth = player.getHealth();
+  cachedMaxHealth = player.getMaxHealth();
+  cachedLocationId = location ? location->getId() : "";
+  cachedScreenWidth = screenWidth;
+  cachedScreenHeight = screenHeight;
+  cachedDebugMode = debugMode;
+
+  instances.clear();
+
+  int scale = std::max(1, screenHeight / REFERENCE_HEIGHT);
+
+  // Bars, anchored bottom-right: stamina (always full for now), then health
+  float barW = static_cast<float>(BAR_WIDTH * scale);
+  float barH = static_cast<float>(BAR_HEIGHT * scale);
+  float barY = screenHeight - (BAR_MARGIN + BAR_HEIGHT) * scale;
+  float staminaX = screenWidth - (BAR_MARGIN + BAR_WIDTH) * scale;
+  float healthX = staminaX - (BAR_SPACING + BAR_WIDTH) * scale;
+
+  addRect(staminaX, barY, barW, barH, glm::vec4(0.4f, 0.35f, 0.0f, 0.5f));
+  addRect(staminaX, barY, barW, barH, glm::vec4(1.0f, 0.85f, 0.1f, 1.0f));
+
+  float healthRatio = cachedMaxHealth > 0
+      ? static_cast<float>(cachedHealth) / cachedMaxHealth
+      : 0.0f;
+  float fillH = barH * healthRatio;
+
+  // Fill shrinks from the top
+  addRect(healthX, barY, barW, barH, glm::vec4(0.4f, 0.0f, 0.0f, 0.5f));
+  addRect(healthX, barY + barH - fillH, barW, fillH, glm::vec4(0.9f, 0.1f, 0.1f, 1.0f));
+
+  if (debugMode) {
+    TextStyle title = { scale * 2, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f) };
+    const TextLayout& locationLayout = layoutText(cachedLocationId, title);
+    addText(cachedLocationId, (screenWidth - locationLayout.width) / 2.0f, 4.0f * scale, title);
+
+    // Debug text, one line per row, on a dark backing
+    TextStyle stats = { scale, glm::vec4(0.8f, 1.0f, 0.8f, 1.0f) };
+    std::istringstream lines(debugText);
+    std::string line;
+    float y = 4.0f * scale;
+
+    while (std::getline(lines, line)) {
+      const TextLayout& layout = layoutText(line, stats);
+      addRect(2.0f * scale, y - scale, layout.width + 2.0f * scale, layout.height + 2.0f * scale,
+              glm::vec4(0.0f, 0.0f, 0.0f, 0.5f));
+      addText(line, 3.0f * scale, y, stats);
+      y += BitmapFont::CELL_HEIGHT * scale + 2 * scale;
+    }
+  }
+
+  dirty = false;
+  rebuildCount++;
+}
+
+void HUD::upload() {
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.get());
+
+  if (instances.size() > instanceCapacity) {
+    instanceCapacity = instances.size() * 2;
+    glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+  }
+
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+const HUD::TextLayout& HUD::layoutText(const std::string& text, const TextStyle& style) {
+  std::string key = makeLayoutKey(text, style);
+
+  auto it = layoutCache.find(key);
+  if (it != layoutCache.end()) return it->second;
+
+  if (layoutCache.size() >= MAX_CACHED_LAYOUTS) {
+    layoutCache.clear();
+  }
+
+  TextLayout layout;
+  float glyphW = static_cast<float>(BitmapFont::GLYPH_WIDTH * style.scale);
+  float glyphH = static_cast<float>(BitmapFont::GLYPH_HEIGHT * style.scale);
+  float advance = static_cast<float>(BitmapFont::CELL_WIDTH * style.scale);
+
+  for (size_t i = 0; i < text.size(); i++) {
+    if (text[i] == ' ') continue;
+
+    Instance glyph;
+    glyph.rect = glm::vec4(i * advance, 0.0f, glyphW, glyphH);
+    glyph.uvRect = font->getGlyphUV(text[i]);
+    glyph.color = style.color;
+    layout.glyphs.push_back(glyph);
+  }
+
+  layout.width = static_cast<int>(text.size() * advance);
+  layout.height = static_cast<int>(glyphH);
+
+  return layoutCache.emplace(key, std::move(layout)).first->second;
+}
+
+void HUD::addRect(float x, float y, float w, float h, const glm::vec4& color) {
+  Instance rect;
+  rect.rect = glm::vec4(x, y, w, h);
+  rect.uvRect = font->getSolidUV();
+  rect.color = color;
+  instances.push_back(rect);
+}
+
+void HUD::addText(const std::string& text, float x, float y, const TextStyle& style) {
+  const TextLayout& layout = layoutText(text, style);
+
+  for (Instance glyph : layout.glyphs) {
+    glyph.rect.x += x;
+    glyph.rect.y += y;
+    instances.push_back(glyph);
+  }
+}
+
+int HUD::getRebuildCount() const {
+  return rebuildCount;
+}
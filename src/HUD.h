@@ -0,0 +1,83 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "BitmapFont.h"
+#include "Common.h"
+#include "GLResources.h"
+#include "Location.h"
+#include "QuadIndexBuffer.h"
+#include "Player.h"
+#include "Shader.h"
+
+struct TextStyle {
+  int scale;        // Whole-pixel magnification of the 5x7 glyphs
+  glm::vec4 color;
+};
+
+// Screen-space overlay: health/stamina bars, location name and debug text.
+//
+// Everything (bars and glyphs) is one kind of instanced quad sampling the
+// font atlas, so the whole HUD is a single draw. Geometry is retained: the
+// instance buffer is only rebuilt and re-uploaded when something shown
+// actually changed (health, location, debug text, screen size).
+class HUD {
+  private:
+    struct Instance {
+      glm::vec4 rect;     // position.xy, size.zw in screen pixels
+      glm::vec4 uvRect;   // offset.xy, size.zw in the font atlas
+      glm::vec4 color;
+    };
+
+    struct TextLayout {
+      std::vector<Instance> glyphs;  // Relative to the text origin
+      int width;
+      int height;
+    };
+
+    std::unique_ptr<BitmapFont> font;
+
+    std::shared_ptr<GLResources> resources;
+    std::shared_ptr<QuadIndexBuffer> quadIndices;
+    GLObject VAO;
+    GLObject instanceVBO;
+    size_t instanceCapacity;
+
+    std::vector<Instance> instances;
+
+    // Laid-out strings keyed by text and style
+    std::unordered_map<std::string, TextLayout> layoutCache;
+
+    // What the current geometry was built from
+    bool dirty;
+    int cachedHealth;
+    int cachedMaxHealth;
+    std::string cachedLocationId;
+    std::string debugText;
+    int cachedScreenWidth;
+    int cachedScreenHeight;
+    bool cachedDebugMode;
+
+    int rebuildCount;
+
+    void setupMesh();
+    void rebuild(int screenWidth, int screenHeight, const Player& player,
+                 const Location* location, bool debugMode);
+    void upload();
+
+    const TextLayout& layoutText(const std::string& text, const TextStyle& style);
+    void addRect(float x, float y, float w, float h, const glm::vec4& color);
+    void addText(const std::string& text, float x, float y, const TextStyle& style);
+
+  public:
+    HUD();
+
+    // Multi-line text shown top-left while debug mode is on
+    void setDebugText(const std::string& text);
+
+    void render(Shader& shader, int screenWidth, int screenHeight,
+                const Player& player, const Location* location, bool debugMode);
+
+    // Getters
+    int getRebuildCount() const;
+};
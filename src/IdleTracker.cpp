@@ -0,0 +1,91 @@
+#include "IdleTracker.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+  // FNV-1a
+  const uint64_t HASH_SEED = 14695981039346656037ull;
+  const uint64_t HASH_PRIME = 1099511628211ull;
+
+  uint64_t mix(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+    return hash;
+  }
+}
+
+IdleTracker::IdleTracker(Uint32 heartbeatMs)
+  : hash(HASH_SEED),
+    lastSignature(0),
+    invalidated(true),
+    heartbeatMs(heartbeatMs),
+    lastRenderTicks(0),
+    lastChangeTicks(0),
+    skippedFrames(0)
+{
+}
+
+void IdleTracker::beginFrame() {
+  hash = HASH_SEED;
+}
+
+void IdleTracker::add(int value) {
+  hash = mix(hash, &value, sizeof(value));
+}
+
+void IdleTracker::add(uint64_t value) {
+  hash = mix(hash, &value, sizeof(value));
+}
+
+void IdleTracker::add(float value) {
+  // -0 and 0 draw the same
+  if (value == 0.0f) value = 0.0f;
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  hash = mix(hash, &bits, sizeof(bits));
+}
+
+void IdleTracker::add(const std::string& value) {
+  hash = mix(hash, value.data(), value.size());
+  add(static_cast<int>(value.size()));
+}
+
+void IdleTracker::invalidate() {
+  invalidated = true;
+}
+
+bool IdleTracker::shouldRender(Uint32 now) {
+  bool changed = invalidated || hash != lastSignature;
+  invalidated = false;
+
+  if (changed) lastChangeTicks = now;
+
+  if (changed || now - lastRenderTicks >= heartbeatMs) {
+    lastSignature = hash;
+    lastRenderTicks = now;
+    return true;
+  }
+
+  skippedFrames++;
+  return false;
+}
+
+Uint32 IdleTracker::getWaitMs(Uint32 now) const {
+  if (!isSettled(now)) return ACTIVE_WAIT_MS;
+
+  // Wake in time for the heartbeat
+  Uint32 sinceRender = now - lastRenderTicks;
+  Uint32 untilHeartbeat = sinceRender < heartbeatMs ? heartbeatMs - sinceRender : 0;
+  return std::min(IDLE_WAIT_MS, untilHeartbeat);
+}
+
+int IdleTracker::getSkippedFrames() const {
+  return skippedFrames;
+}
+
+bool IdleTracker::isSettled(Uint32 now) const {
+  return now - lastChangeTicks >= SETTLE_MS;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common.h"
+
+// Decides whether a frame is worth drawing.
+//
+// Every frame the game feeds in what the screen shows (camera, entities,
+// tile revision, animation frames, HUD text...) and the tracker hashes it.
+// A frame whose hash matches the last drawn one is skipped: no render and
+// no swap. Input and anything else that can't be hashed cheaply invalidate
+// the frame instead. A heartbeat redraws now and then regardless.
+//
+// Skipped frames don't block on vsync, so the loop sleeps in SDL instead
+// (getWaitMs): a display frame while things were changing recently, longer
+// once the screen has settled. Input events end the sleep immediately.
+class IdleTracker {
+  private:
+    uint64_t hash;
+    uint64_t lastSignature;
+    bool invalidated;
+
+    Uint32 heartbeatMs;
+    Uint32 lastRenderTicks;
+    Uint32 lastChangeTicks;
+
+    int skippedFrames;
+
+  public:
+    // Unchanged this long, the screen counts as settled
+    static constexpr Uint32 SETTLE_MS = 500;
+
+    // Sleep per skipped frame: about a display frame while active, longer settled
+    static constexpr Uint32 ACTIVE_WAIT_MS = 16;
+    static constexpr Uint32 IDLE_WAIT_MS = 100;
+
+    IdleTracker(Uint32 heartbeatMs = 1000);
+
+    // Starts this frame's hash
+    void beginFrame();
+
+    void add(int value);
+    void add(uint64_t value);
+    void add(float value);
+    void add(const std::string& value);
+
+    // Draw this frame whatever the hash says
+    void invalidate();
+
+    // Compares with the last drawn frame; counts the frame as skipped if not
+    bool shouldRender(Uint32 now);
+
+    // How long to sleep after a skipped frame
+    Uint32 getWaitMs(Uint32 now) const;
+
+    int getSkippedFrames() const;
+    bool isSettled(Uint32 now) const;
+};
@@ -10,14 +10,22 @@ Input::Input() {
   windowResized = false;
   newWindowWidth = 0;
   newWindowHeight = 0;
+  wheelDelta = 0;
+  eventCount = 0;
 }
 
 void Input::update() {
   SDL_Event event;
   windowResized = false;
+  wheelDelta = 0;
+  eventCount = 0;
   keysJustPressed.clear();
 
   while (SDL_PollEvent(&event)) {
+    if (event.type != SDL_MOUSEMOTION) {
+      eventCount++;
+    }
+
     if (event.type == SDL_QUIT) {
       quitRequested = true;
     }
@@ -32,6 +40,10 @@ void Input::update() {
       }
     }
 
+    if (event.type == SDL_MOUSEWHEEL) {
+      wheelDelta += event.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -event.wheel.y : event.wheel.y;
+    }
+
     if (event.type == SDL_WINDOWEVENT) {
       if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
         windowResized = true;
@@ -69,6 +81,14 @@ int Input::getNewWindowHeight() const {
   return newWindowHeight;
 }
 
+int Input::getWheelDelta() const {
+  return wheelDelta;
+}
+
+bool Input::hadEvents() const {
+  return eventCount > 0;
+}
+
 Vector2 Input::getMovementInput() const {
   Vector2 movement(0, 0);
 
@@ -95,3 +115,18 @@ Vector2 Input::getMovementInput() const {
 
   return movement;
 }
+
+Vector2 Input::getSecondaryMovementInput() const {
+  Vector2 movement(0, 0);
+
+  if (keyboardState[SDL_SCANCODE_I]) movement.y -= 1.0f;
+  if (keyboardState[SDL_SCANCODE_K]) movement.y += 1.0f;
+  if (keyboardState[SDL_SCANCODE_J]) movement.x -= 1.0f;
+  if (keyboardState[SDL_SCANCODE_L]) movement.x += 1.0f;
+
+  if (movement.length() > 0) {
+    movement = movement.normalized();
+  }
+
+  return movement;
+}
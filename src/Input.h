@@ -13,6 +13,8 @@ class Input {
     bool windowResized;
     int newWindowWidth;
     int newWindowHeight;
+    int wheelDelta;
+    int eventCount;
     std::unordered_set<SDL_Keycode> keysJustPressed;
 
   public:
@@ -27,5 +29,15 @@ class Input {
     int getNewWindowWidth() const;
     int getNewWindowHeight() const;
 
+    // Mouse wheel notches this frame; positive is away from the user
+    int getWheelDelta() const;
+
+    // Any event this frame other than plain mouse motion (nothing reads the
+    // pointer yet); idle frame skipping wakes on these
+    bool hadEvents() const;
+
     Vector2 getMovementInput() const;
+
+    // IJKL, for a second camera
+    Vector2 getSecondaryMovementInput() const;
 };
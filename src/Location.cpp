@@ -18,14 +18,35 @@ void Location::onExit() {
   std::cout << "Leaving location: " << id << std::endl;
 }
 
-void Location::render(Shader& tileShader, const Camera& camera) {
-  tilemap->render(tileShader, camera);
+void Location::render(Shader& tileShader, const ViewSet& views) {
+  tilemap->render(tileShader, views);
+}
+
+void Location::renderBackground(Shader& parallaxShader, const ViewSet& views, float time) {
+  if (background) background->render(parallaxShader, views, time);
 }
 
 void Location::renderDebug(Shader& debugShader, const Camera& camera) {
   tilemap->renderDebug(debugShader, camera);
 }
 
+void Location::setTileRenderMode(TileRenderMode mode) {
+  tilemap->setRenderMode(mode);
+}
+
+void Location::enableFogOfWar() {
+  if (!fogOfWar) {
+    fogOfWar = std::make_unique<FogOfWar>(tilemap.get());
+  }
+}
+
+void Location::addBackgroundLayer(const ParallaxLayer& layer) {
+  if (!background) {
+    background = std::make_unique<ParallaxBackground>();
+  }
+  background->addLayer(layer);
+}
+
 // void Location::update() {}
 
 void Location::addWarp(float x, float y, float w, float h,
@@ -46,6 +67,15 @@ const WarpZone* Location::checkWarpCollisions(const Vector2& position) const {
 
 const std::string& Location::getId() const { return id; }
 
+Tilemap* Location::getTilemap() { return tilemap.get(); }
+const Tilemap* Location::getTilemap() const { return tilemap.get(); }
+
+FogOfWar* Location::getFogOfWar() const { return fogOfWar.get(); }
+
+bool Location::hasAnimatedBackground() const {
+  return background && background->isAnimated();
+}
+
 int Location::getWorldWidth() const {
   return tilemap->getTileCountX() * tilemap->getTileSize();
 }
@@ -3,10 +3,13 @@
 #include "Camera.h"
 #include "Common.h"
 #include "Enemy.h"
+#include "FogOfWar.h"
+#include "ParallaxBackground.h"
 #include "Shader.h"
 #include "Texture.h"
 #include "Tilemap.h"
 #include "Vector2.h"
+#include "ViewSet.h"
 #include "WarpZone.h"
 
 class Location {
@@ -14,6 +17,12 @@ class Location {
     std::string id;
     std::unique_ptr<Tilemap> tilemap;
 
+    // Only dungeon-like locations have one; explored state persists across visits
+    std::unique_ptr<FogOfWar> fogOfWar;
+
+    // Created with the first layer
+    std::unique_ptr<ParallaxBackground> background;
+
     std::vector<std::unique_ptr<Enemy>> enemies;
  
     std::vector<WarpZone>
@@ -31,8 +40,12 @@ class Location {
     void onExit();
 
     // Game loop
-    void render(Shader& tileShader, const Camera& camera);
+    void render(Shader& tileShader, const ViewSet& views);
+    void renderBackground(Shader& parallaxShader, const ViewSet& views, float time);
     void renderDebug(Shader& debugShader, const Camera& camera);
+    void setTileRenderMode(TileRenderMode mode);
+    void enableFogOfWar();
+    void addBackgroundLayer(const ParallaxLayer& layer);
     // void update();
 
     // Warp zones
@@ -46,6 +59,10 @@ class Location {
 
     // Getters
     const std::string& getId() const;
+    Tilemap* getTilemap();
+    const Tilemap* getTilemap() const;
+    FogOfWar* getFogOfWar() const;
+    bool hasAnimatedBackground() const;
     int getWorldWidth() const;
     int getWorldHeight() const;
 };
@@ -0,0 +1,295 @@
+#include "Minimap.h"
+#include "VertexFormat.h"
+#include <algorithm>
+
+namespace {
+  // Laid out for a 640x360 screen and scaled by whole pixels, like the HUD
+  const int REFERENCE_HEIGHT = 360;
+  const int MAP_SIZE = 96;
+  const int MAP_MARGIN = 6;
+
+  const int MAX_MAP_SIZE = 4096;
+
+  const float MIN_ZOOM = 0.125f;
+  const float MAX_ZOOM = 4.0f;
+
+  // Unknown tile IDs show up loudly
+  const uint32_t MISSING_COLOR = 0xFFFF00FF;
+
+  // Box filter of up to four texels
+  uint32_t average(uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint32_t sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                     ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+      result |= ((sum + 2) / 4) << shift;
+    }
+    return result;
+  }
+}
+
+Minimap::Minimap()
+  : resources(GLResources::acquire()),
+    tilemap(nullptr),
+    seenRevision(0),
+    width(0),
+    height(0),
+    zoom(1.0f),
+    screenRect(0.0f),
+    viewOrigin(0.0f),
+    pixelsPerTile(1.0f),
+    tileSize(1)
+{
+}
+
+void Minimap::setPaletteColor(int tileID, const glm::vec4& color) {
+  if (tileID < 0) return;
+
+  if (tileID >= static_cast<int>(palette.size())) {
+    palette.resize(tileID + 1, MISSING_COLOR);
+  }
+  palette[tileID] = VertexFormat::packColor(color);
+
+  // Recolor whatever is already on the map
+  if (tilemap != nullptr) rebuild();
+}
+
+void Minimap::setTilemap(const Tilemap* map) {
+  if (map == tilemap) return;
+
+  tilemap = map;
+  rebuild();
+}
+
+void Minimap::rebuild() {
+  int previousWidth = width;
+  int previousHeight = height;
+  width = 0;
+  height = 0;
+
+  if (tilemap == nullptr) {
+    texture.reset();
+    return;
+  }
+
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+  int mapWidth = tilemap->getTileCountX();
+  int mapHeight = tilemap->getTileCountY();
+  int limit = std::min(MAX_MAP_SIZE, static_cast<int>(maxTextureSize));
+
+  if (mapWidth > limit || mapHeight > limit) {
+    std::cerr << "Minimap: map too large (" << mapWidth << "x" << mapHeight
+              << ", max " << limit << ")" << std::endl;
+    tilemap = nullptr;
+    texture.reset();
+    return;
+  }
+
+  width = mapWidth;
+  height = mapHeight;
+  tileSize = tilemap->getTileSize();
+  seenRevision = tilemap->getRevision();
+
+  // Full chain down to 1x1
+  int levelCount = 1;
+  while ((std::max(width, height) >> levelCount) > 0) levelCount++;
+
+  // Recolors keep the texture; new sizes need a new one
+  if (!texture || width != previousWidth || height != previousHeight) {
+    texture = std::make_unique<DynamicTexture>(width, height, DynamicTexture::Format::RGBA8, levelCount);
+    glBindTexture(GL_TEXTURE_2D, texture->getID());
+
+    // Crisp when zoomed in, averaged mips when zoomed out
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // Past the map edge is transparent
+    float border[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  uint32_t* base = texture->getPixels32(0);
+  for (int y = 0; y < height; y++) {
+    for (int x = 0; x < width; x++) {
+      base[y * width + x] = colorFor(tilemap->getTile(x, y));
+    }
+  }
+
+  for (int level = 1; level < levelCount; level++) {
+    filterRect(level, 0, 0, levelWidth(level), levelHeight(level));
+  }
+
+  // Streams in over the next frame(s), within the shared upload budget
+  texture->markAllDirty();
+
+  std::cout << "Minimap: " << width << "x" << height
+            << " (" << levelCount << " levels)" << std::endl;
+}
+
+void Minimap::update() {
+  if (tilemap == nullptr) return;
+
+  if (tilemap->getRevision() != seenRevision) {
+    pendingChanges.clear();
+    if (tilemap->getChangesSince(seenRevision, pendingChanges)) {
+      seenRevision = tilemap->getRevision();
+      applyChanges();
+    } else {
+      // Fell too far behind the journal
+      rebuild();
+    }
+  }
+
+  // Also finishes whatever last frame's budget left over
+  if (texture) texture->upload();
+}
+
+void Minimap::applyChanges() {
+  if (pendingChanges.empty()) return;
+
+  int x0 = width, y0 = height, x1 = 0, y1 = 0;
+  for (const TileChange& change : pendingChanges) {
+    texture->getPixels32(0)[change.y * width + change.x] = colorFor(change.tileID);
+    x0 = std::min(x0, change.x);
+    y0 = std::min(y0, change.y);
+    x1 = std::max(x1, change.x + 1);
+    y1 = std::max(y1, change.y + 1);
+  }
+
+  // One rect per level for clustered edits; scattered edits go texel by
+  // texel so a change in each corner doesn't refilter (or re-upload) the
+  // whole map. The texture keeps them as separate dirty rects.
+  int area = (x1 - x0) * (y1 - y0);
+  int clusteredLimit = std::max(256, static_cast<int>(pendingChanges.size()) * 16);
+
+  if (area <= clusteredLimit) {
+    texture->markDirty(x0, y0, x1, y1, 0);
+    for (int level = 1; level < texture->getLevelCount(); level++) {
+      x0 >>= 1;
+      y0 >>= 1;
+      x1 = std::min((x1 + 1) >> 1, levelWidth(level));
+      y1 = std::min((y1 + 1) >> 1, levelHeight(level));
+      filterRect(level, x0, y0, x1, y1);
+      texture->markDirty(x0, y0, x1, y1, level);
+    }
+  } else {
+    for (const TileChange& change : pendingChanges) {
+      int x = change.x;
+      int y = change.y;
+      texture->markDirty(x, y, x + 1, y + 1, 0);
+      for (int level = 1; level < texture->getLevelCount(); level++) {
+        // Halving alone can land past an odd-sized level's last texel
+        x = std::min(x >> 1, levelWidth(level) - 1);
+        y = std::min(y >> 1, levelHeight(level) - 1);
+        filterRect(level, x, y, x + 1, y + 1);
+        texture->markDirty(x, y, x + 1, y + 1, level);
+      }
+    }
+  }
+}
+
+void Minimap::filterRect(int level, int x0, int y0, int x1, int y1) {
+  // Refilter from the level below; odd sizes clamp the last row/column
+  const uint32_t* src = texture->getPixels32(level - 1);
+  uint32_t* dst = texture->getPixels32(level);
+  int srcWidth = levelWidth(level - 1);
+  int srcHeight = levelHeight(level - 1);
+  int dstWidth = levelWidth(level);
+
+  for (int y = y0; y < y1; y++) {
+    int sy0 = y * 2;
+    int sy1 = std::min(sy0 + 1, srcHeight - 1);
+
+    for (int x = x0; x < x1; x++) {
+      int sx0 = x * 2;
+      int sx1 = std::min(sx0 + 1, srcWidth - 1);
+
+      dst[y * dstWidth + x] = average(
+          src[sy0 * srcWidth + sx0], src[sy0 * srcWidth + sx1],
+          src[sy1 * srcWidth + sx0], src[sy1 * srcWidth + sx1]);
+    }
+  }
+}
+
+void Minimap::render(Shader& shader, int screenWidth, int screenHeight, const Vector2& center) {
+  if (tilemap == nullptr || !texture) return;
+
+  int scale = std::max(1, screenHeight / REFERENCE_HEIGHT);
+  float size = static_cast<float>(MAP_SIZE * scale);
+  float margin = static_cast<float>(MAP_MARGIN * scale);
+  screenRect = glm::vec4(screenWidth - margin - size, margin, size, size);
+
+  // Window into the map, in tiles, centered on `center`
+  pixelsPerTile = zoom * scale;
+  float tilesAcross = size / pixelsPerTile;
+  viewOrigin = glm::vec2(center.x / tileSize, center.y / tileSize) - tilesAcross * 0.5f;
+
+  glm::vec4 uvRect(viewOrigin.x / width, viewOrigin.y / height,
+                   tilesAcross / width, tilesAcross / height);
+
+  glm::mat4 projection = glm::ortho(
+      0.0f, static_cast<float>(screenWidth),
+      static_cast<float>(screenHeight), 0.0f
+  );
+
+  shader.use();
+  shader.setMat4("projection", projection);
+  shader.setVec4("rect", screenRect);
+  shader.setVec4("uvRect", uvRect);
+  shader.setInt("minimapTexture", 0);
+
+  texture->bind(0);
+
+  glBindVertexArray(resources->getUnitQuadVAO());
+  glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr);
+  glBindVertexArray(0);
+
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Minimap::worldToScreen(const Vector2& world, Vector2& screen) const {
+  if (tilemap == nullptr) return false;
+
+  glm::vec2 local = (glm::vec2(world.x / tileSize, world.y / tileSize) - viewOrigin) * pixelsPerTile;
+  if (local.x < 0.0f || local.y < 0.0f || local.x >= screenRect.z || local.y >= screenRect.w) {
+    return false;
+  }
+
+  screen = Vector2(screenRect.x + local.x, screenRect.y + local.y);
+  return true;
+}
+
+void Minimap::zoomIn() {
+  zoom = std::min(zoom * 2.0f, MAX_ZOOM);
+}
+
+void Minimap::zoomOut() {
+  zoom = std::max(zoom * 0.5f, MIN_ZOOM);
+}
+
+uint32_t Minimap::colorFor(int tileID) const {
+  if (tileID < 0) return 0;
+  if (tileID >= static_cast<int>(palette.size())) return MISSING_COLOR;
+  return palette[tileID];
+}
+
+int Minimap::levelWidth(int level) const {
+  return std::max(1, width >> level);
+}
+
+int Minimap::levelHeight(int level) const {
+  return std::max(1, height >> level);
+}
+
+float Minimap::getPixelsPerTile() const {
+  return pixelsPerTile;
+}
+
+int Minimap::getTexelsUploaded() const {
+  return texture ? texture->getTexelsUploaded() : 0;
+}
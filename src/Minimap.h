@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Common.h"
+#include "DynamicTexture.h"
+#include "GLResources.h"
+#include "Shader.h"
+#include "Tilemap.h"
+#include "Vector2.h"
+
+// Overview map built straight from tile data: one texel per tile, colored
+// from a per-tile-ID palette, with a full mip chain for zooming out.
+//
+// The texture mirrors the tilemap through its change journal, so a
+// setTile only re-uploads the texels (and the mip texels above them) that
+// changed, streamed through a DynamicTexture. Drawing it is a single
+// textured quad.
+class Minimap {
+  private:
+    std::shared_ptr<GLResources> resources;
+
+    // Every mip level, with a CPU copy so dirty texels can be refiltered
+    std::unique_ptr<DynamicTexture> texture;
+
+    const Tilemap* tilemap;
+    uint64_t seenRevision;
+    std::vector<TileChange> pendingChanges;
+
+    int width;
+    int height;
+
+    std::vector<uint32_t> palette;
+
+    // Screen pixels per tile at the reference resolution
+    float zoom;
+
+    // Where the last render put the map, for placing markers
+    glm::vec4 screenRect;
+    glm::vec2 viewOrigin;
+    float pixelsPerTile;
+    int tileSize;
+
+    void rebuild();
+    void applyChanges();
+    void filterRect(int level, int x0, int y0, int x1, int y1);
+
+    uint32_t colorFor(int tileID) const;
+    int levelWidth(int level) const;
+    int levelHeight(int level) const;
+
+  public:
+    Minimap();
+
+    void setPaletteColor(int tileID, const glm::vec4& color);
+
+    // Switches to another map and rebuilds the whole texture
+    void setTilemap(const Tilemap* map);
+
+    // Pulls tile changes made since the last call
+    void update();
+
+    // Top-right corner, centered on `center` (world units)
+    void render(Shader& shader, int screenWidth, int screenHeight, const Vector2& center);
+
+    // World position -> screen pixels inside the last drawn map.
+    // Returns false when the point falls outside it.
+    bool worldToScreen(const Vector2& world, Vector2& screen) const;
+
+    void zoomIn();
+    void zoomOut();
+
+    // Getters
+    float getPixelsPerTile() const;
+    int getTexelsUploaded() const;
+};
@@ -0,0 +1,135 @@
+#include "ParallaxBackground.h"
+#include "GLDebug.h"
+#include "QuadIndexBuffer.h"
+
+namespace {
+  const char* OWNER = "ParallaxBackground";
+
+  // Uniform buffer binding point of the Layers block
+  const GLuint LAYER_BINDING = 0;
+
+  // One Layers entry, std140
+  struct LayerConstants {
+    glm::vec4 uvRect;        // Source rect, offset.xy and size.zw in UV
+    glm::vec4 tint;
+    glm::vec4 periodScroll;  // period.xy (world units per repeat), scrollFactor.zw
+    glm::vec4 motion;        // autoScroll.xy, offset.zw
+    glm::vec4 flags;         // x: repeatY
+  };
+}
+
+ParallaxBackground::ParallaxBackground()
+  : resources(GLResources::acquire()),
+    dirty(true)
+{
+}
+
+void ParallaxBackground::addLayer(const ParallaxLayer& layer) {
+  if (layer.texture == nullptr || layer.sourceRect.z <= 0.0f || layer.sourceRect.w <= 0.0f ||
+      layer.scale <= 0.0f) {
+    std::cerr << "ParallaxBackground: invalid layer" << std::endl;
+    return;
+  }
+
+  if (static_cast<int>(layers.size()) >= MAX_LAYERS) {
+    std::cerr << "ParallaxBackground: more than " << MAX_LAYERS << " layers" << std::endl;
+    return;
+  }
+
+  layers.push_back(layer);
+  dirty = true;
+}
+
+void ParallaxBackground::clear() {
+  layers.clear();
+  dirty = true;
+}
+
+void ParallaxBackground::uploadLayers() {
+  std::vector<LayerConstants> constants(layers.size());
+  uploadedSizes.resize(layers.size());
+
+  for (size_t i = 0; i < layers.size(); i++) {
+    const ParallaxLayer& layer = layers[i];
+    float textureWidth = static_cast<float>(layer.texture->getWidth());
+    float textureHeight = static_cast<float>(layer.texture->getHeight());
+
+    constants[i].uvRect = glm::vec4(layer.sourceRect.x / textureWidth, layer.sourceRect.y / textureHeight,
+                                    layer.sourceRect.z / textureWidth, layer.sourceRect.w / textureHeight);
+    constants[i].tint = layer.tint;
+    constants[i].periodScroll = glm::vec4(glm::vec2(layer.sourceRect.z, layer.sourceRect.w) * layer.scale,
+                                          layer.scrollFactor);
+    constants[i].motion = glm::vec4(layer.autoScroll, layer.offset);
+    constants[i].flags = glm::vec4(layer.repeatY ? 1.0f : 0.0f, 0.0f, 0.0f, 0.0f);
+    uploadedSizes[i] = glm::ivec2(layer.texture->getWidth(), layer.texture->getHeight());
+  }
+
+  if (layerBuffer.get() == 0) {
+    layerBuffer = GLObject(GLResources::Kind::BUFFER, OWNER);
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, layerBuffer.get());
+  glBufferData(GL_UNIFORM_BUFFER, MAX_LAYERS * sizeof(LayerConstants), nullptr, GL_STATIC_DRAW);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, constants.size() * sizeof(LayerConstants), constants.data());
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  dirty = false;
+}
+
+void ParallaxBackground::render(Shader& shader, const ViewSet& views, float time) {
+  if (layers.empty()) return;
+  GL_DEBUG_GROUP("Background");
+
+  glDisable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+
+  // UVs depend on the texture size, which a hot reload can change
+  for (size_t i = 0; i < layers.size() && !dirty; i++) {
+    dirty = uploadedSizes[i] != glm::ivec2(layers[i].texture->getWidth(), layers[i].texture->getHeight());
+  }
+  if (dirty) uploadLayers();
+
+  shader.use();
+  shader.setFloat("time", time);
+  shader.setInt("layerTexture", 0);
+
+  // Per frame, since a shader hot reload makes a new program
+  GLuint blockIndex = glGetUniformBlockIndex(shader.getID(), "Layers");
+  if (blockIndex != GL_INVALID_INDEX) glUniformBlockBinding(shader.getID(), blockIndex, LAYER_BINDING);
+  glBindBufferBase(GL_UNIFORM_BUFFER, LAYER_BINDING, layerBuffer.get());
+
+  glBindVertexArray(resources->getUnitQuadVAO());
+
+  for (int i = 0; i < views.size(); i++) {
+    views.bind(i);
+    shader.setVec4("viewRect", views.getViewRect(i));
+
+    const Texture* bound = nullptr;
+    for (size_t index = 0; index < layers.size(); index++) {
+      const ParallaxLayer& layer = layers[index];
+      shader.setInt("layerIndex", static_cast<int>(index));
+
+      if (layer.texture != bound) {
+        layer.texture->bind(0);
+        bound = layer.texture;
+      }
+      glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr);
+    }
+  }
+
+  glBindVertexArray(0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBufferBase(GL_UNIFORM_BUFFER, LAYER_BINDING, 0);
+  glDepthMask(GL_TRUE);
+}
+
+bool ParallaxBackground::isAnimated() const {
+  for (const ParallaxLayer& layer : layers) {
+    if (layer.autoScroll.x != 0.0f || layer.autoScroll.y != 0.0f) return true;
+  }
+  return false;
+}
+
+int ParallaxBackground::getLayerCount() const {
+  return static_cast<int>(layers.size());
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "ViewSet.h"
+
+// One repeating image behind the map
+struct ParallaxLayer {
+  Texture* texture;
+  glm::vec4 sourceRect;    // Part of the texture that repeats: x, y, w, h (pixels)
+  float scale;             // World units per texel
+  glm::vec2 scrollFactor;  // 0 = fixed to the screen, 1 = moves with the map
+  glm::vec2 autoScroll;    // World units per second
+  glm::vec2 offset;        // Layer origin, in world units at camera (0, 0)
+  bool repeatY;            // Otherwise a single horizontal band starting at offset.y
+  glm::vec4 tint;
+};
+
+// Background layers drawn back to front, each as one quad covering the
+// view. The vertex shader places the layer from the view rect, the scroll
+// factor and the time; the fragment shader wraps the source rect with
+// fract (like repeated tiles), so textures keep their own wrap mode.
+//
+// The per-layer constants live in a uniform buffer (the Layers block),
+// uploaded only when the layers change. Per frame the CPU sets the time and
+// each view's rect; per layer only its index, plus a texture bind when the
+// texture differs from the last layer's. Each layer costs one draw however
+// large the view is.
+class ParallaxBackground {
+  private:
+    std::shared_ptr<GLResources> resources;
+    std::vector<ParallaxLayer> layers;
+
+    // The Layers block; stale when layers or their texture sizes changed
+    GLObject layerBuffer;
+    std::vector<glm::ivec2> uploadedSizes;
+    bool dirty;
+
+    void uploadLayers();
+
+  public:
+    // Matches MAX_LAYERS in parallax.vert and parallax.frag
+    static const int MAX_LAYERS = 16;
+
+    ParallaxBackground();
+
+    // Appended in front of the existing layers, up to MAX_LAYERS
+    void addLayer(const ParallaxLayer& layer);
+    void clear();
+
+    // Into every view, before the scene; no depth test or writes
+    void render(Shader& shader, const ViewSet& views, float time);
+
+    // Some layer auto-scrolls, so the background changes every frame
+    bool isAnimated() const;
+
+    int getLayerCount() const;
+};
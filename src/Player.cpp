@@ -24,9 +24,18 @@ void Player::update(float deltaTime) {
   animator->update(deltaTime);
 }
 
-void Player::render(Shader& shader, const Camera& camera) {
+void Player::render(SpriteBatch& batch) {
   if (!isActive) return;
-  sprite->draw(shader, camera);
+  batch.submit(*sprite, depth);
+}
+
+float Player::getDepthY() const {
+  // Sort by the feet, not the top of the sprite
+  return position.y + sprite->getSize().y;
+}
+
+const Sprite* Player::getSprite() const {
+  return sprite.get();
 }
 
 void Player::setPosition(const Vector2& pos) {
@@ -60,6 +69,10 @@ int Player::getHealth() const {
   return health;
 }
 
+int Player::getMaxHealth() const {
+  return maxHealth;
+}
+
 float Player::getSpeed() const {
   return speed;
 }
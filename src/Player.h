@@ -3,6 +3,7 @@
 #include "Camera.h"
 #include "Entity.h"
 #include "Sprite.h"
+#include "SpriteBatch.h"
 #include "Shader.h"
 #include "SpriteAnimator.h"
 #include <memory>
@@ -24,7 +25,9 @@ public:
 
   // Override parent methods
   void update(float deltaTime) override;
-  void render(Shader& shader, const Camera& camera) override;
+  void render(SpriteBatch& batch) override;
+  float getDepthY() const override;
+  const Sprite* getSprite() const override;
 
   void setPosition(const Vector2& pos);
   void move(const Vector2& direction);
@@ -0,0 +1,289 @@
+#include "ProjectileSystem.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+  // Projectiles this far out expire, so positions always convert to int
+  const float POSITION_LIMIT = 1.0e7f;
+}
+
+ProjectileSystem::ProjectileSystem(size_t capacity)
+  : capacity(capacity),
+    count(0),
+    maxRadius(0.0f),
+    accumulator(0.0f),
+    stepCount(0)
+{
+  // Allocated once; the pool never grows
+  x.resize(capacity);
+  y.resize(capacity);
+  velocityX.resize(capacity);
+  velocityY.resize(capacity);
+  previousX.resize(capacity);
+  previousY.resize(capacity);
+  timeLeft.resize(capacity);
+  radius.resize(capacity);
+  damage.resize(capacity);
+  color.resize(capacity);
+  visible.resize(capacity);
+  candidates.resize(capacity);
+}
+
+void ProjectileSystem::setTilemap(const Tilemap* tilemap) {
+  tiles.setTilemap(tilemap);
+}
+
+bool ProjectileSystem::spawn(const Vector2& position, const Vector2& velocity, float lifetime, int damage,
+                             float radius, uint32_t color) {
+  if (count == capacity || lifetime <= 0.0f) return false;
+
+  size_t i = count++;
+  x[i] = position.x;
+  y[i] = position.y;
+  velocityX[i] = velocity.x;
+  velocityY[i] = velocity.y;
+  timeLeft[i] = lifetime;
+  this->radius[i] = radius;
+  maxRadius = std::max(maxRadius, radius);
+  this->damage[i] = damage;
+  this->color[i] = color;
+  return true;
+}
+
+void ProjectileSystem::update(float deltaTime, const SpatialGrid* targets, float targetRadius) {
+  hits.clear();
+  tiles.sync();
+
+  // Targets hold still for the whole update
+  if (targets != nullptr && targets->size() > 0) {
+    targets->markCellsNear(maxRadius + targetRadius, targetCells);
+  }
+
+  accumulator = std::min(accumulator + deltaTime, FIXED_STEP * MAX_STEPS);
+  while (accumulator >= FIXED_STEP) {
+    accumulator -= FIXED_STEP;
+    step(targets, targetRadius);
+  }
+}
+
+const std::vector<ProjectileHit>& ProjectileSystem::getHits() const {
+  return hits;
+}
+
+void ProjectileSystem::render(SpriteBatch& batch, const Sprite& sprite, const glm::vec4& viewRect,
+                              const Vector2& size, float depth) {
+  if (count == 0) return;
+
+  // Grown by half a sprite, so ones poking in from outside still draw
+  float rect[4] = {
+    viewRect.x - size.x * 0.5f, viewRect.y - size.y * 0.5f,
+    viewRect.z + size.x * 0.5f, viewRect.w + size.y * 0.5f
+  };
+  size_t visibleCount = Simd::cullPoints(x.data(), y.data(), count, rect, visible.data());
+  batch.submitPoints(sprite, x.data(), y.data(), color.data(), visible.data(), visibleCount, size, depth);
+}
+
+void ProjectileSystem::clear() {
+  count = 0;
+  maxRadius = 0.0f;
+  accumulator = 0.0f;
+  hits.clear();
+}
+
+size_t ProjectileSystem::size() const {
+  return count;
+}
+
+size_t ProjectileSystem::getCapacity() const {
+  return capacity;
+}
+
+uint64_t ProjectileSystem::getStepCount() const {
+  return stepCount;
+}
+
+void ProjectileSystem::step(const SpatialGrid* targets, float targetRadius) {
+  stepCount++;
+  if (count == 0) return;
+
+  std::copy(x.begin(), x.begin() + count, previousX.begin());
+  std::copy(y.begin(), y.begin() + count, previousY.begin());
+  Simd::integrate(x.data(), y.data(), velocityX.data(), velocityY.data(), count, FIXED_STEP);
+
+  for (size_t i = 0; i < count; i++) {
+    timeLeft[i] -= FIXED_STEP;
+    if (std::abs(x[i]) > POSITION_LIMIT || std::abs(y[i]) > POSITION_LIMIT) {
+      timeLeft[i] = 0.0f;
+      x[i] = previousX[i];
+      y[i] = previousY[i];
+    }
+  }
+
+  // Branch-free pass over everything: a path that stays inside one tile
+  // and one target cell, both clear, can't hit anything. Only the rest
+  // (a small share at bullet speeds) get the full sweeps below.
+  bool hasTargets = targets != nullptr && targets->size() > 0;
+  int tileCountX = tiles.getTileCountX(), tileCountY = tiles.getTileCountY();
+  bool hasTiles = tiles.hasTilemap();
+  candidateBits.assign((count + 63) / 64, 0);
+  for (size_t i = 0; i < count; i++) {
+    int startX = tiles.tileFloor(previousX[i]), startY = tiles.tileFloor(previousY[i]);
+    int endX = tiles.tileFloor(x[i]), endY = tiles.tileFloor(y[i]);
+    bool onMap = static_cast<unsigned>(startX) < static_cast<unsigned>(tileCountX) &&
+                 static_cast<unsigned>(startY) < static_cast<unsigned>(tileCountY);
+    size_t bit = onMap ? static_cast<size_t>(startY) * tileCountX + startX : 0;
+    bool tileHit = hasTiles && (((startX != endX) | (startY != endY) | !onMap) || tiles.isSolidIndex(bit));
+
+    bool targetHit = false;
+    if (hasTargets) {
+      size_t startCell = targets->cellIndex(previousX[i], previousY[i]);
+      size_t endCell = targets->cellIndex(x[i], y[i]);
+      targetHit = (startCell != endCell) | static_cast<bool>((targetCells[startCell >> 6] >> (startCell & 63)) & 1);
+    }
+
+    bool alive = timeLeft[i] > 0.0f;
+    candidateBits[i >> 6] |= static_cast<uint64_t>(alive & (tileHit | targetHit)) << (i & 63);
+  }
+
+  size_t candidateCount = Simd::findSetBits(candidateBits.data(), candidateBits.size(), candidates.data());
+  for (size_t k = 0; k < candidateCount; k++) {
+    size_t i = candidates[k];
+
+    int tileX = -1, tileY = -1;
+    float t = hasTiles ? sweepTiles(i, tileX, tileY) : 2.0f;
+
+    int target = -1;
+    if (hasTargets) {
+      float targetT = sweepTargets(i, std::min(t, 1.0f), *targets, targetRadius, target);
+      if (target >= 0) t = targetT;
+    }
+
+    if (t > 1.0f) continue;
+
+    ProjectileHit hit;
+    hit.position = Vector2(previousX[i] + (x[i] - previousX[i]) * t, previousY[i] + (y[i] - previousY[i]) * t);
+    hit.target = target;
+    hit.tileX = target < 0 ? tileX : -1;
+    hit.tileY = target < 0 ? tileY : -1;
+    hit.damage = damage[i];
+    hits.push_back(hit);
+    timeLeft[i] = 0.0f;
+  }
+
+  compact();
+}
+
+float ProjectileSystem::sweepTiles(size_t i, int& tileX, int& tileY) const {
+  float tileSize = tiles.getTileSize();
+  float startX = previousX[i] / tileSize, startY = previousY[i] / tileSize;
+  float endX = x[i] / tileSize, endY = y[i] / tileSize;
+
+  int cellX = SolidTileMask::floorToInt(startX);
+  int cellY = SolidTileMask::floorToInt(startY);
+  if (tiles.isSolid(cellX, cellY)) {
+    tileX = cellX;
+    tileY = cellY;
+    return 0.0f;
+  }
+
+  // Most steps stay inside one tile
+  int lastX = SolidTileMask::floorToInt(endX);
+  int lastY = SolidTileMask::floorToInt(endY);
+  if (cellX == lastX && cellY == lastY) return 2.0f;
+
+  // A path into a neighbour crosses at most one more tile, a corner one
+  bool neighbour = std::abs(lastX - cellX) <= 1 && std::abs(lastY - cellY) <= 1;
+  if (neighbour && !tiles.isSolid(lastX, lastY) &&
+      (lastX == cellX || lastY == cellY || (!tiles.isSolid(lastX, cellY) && !tiles.isSolid(cellX, lastY)))) {
+    return 2.0f;
+  }
+
+  // Walk the tiles the path crosses, in order (Amanatides & Woo)
+  const float infinity = std::numeric_limits<float>::infinity();
+  float dx = endX - startX, dy = endY - startY;
+  int stepX = dx > 0.0f ? 1 : -1;
+  int stepY = dy > 0.0f ? 1 : -1;
+  float deltaX = dx != 0.0f ? 1.0f / std::abs(dx) : infinity;
+  float deltaY = dy != 0.0f ? 1.0f / std::abs(dy) : infinity;
+  float nextX = dx != 0.0f ? (dx > 0.0f ? cellX + 1 - startX : startX - cellX) * deltaX : infinity;
+  float nextY = dy != 0.0f ? (dy > 0.0f ? cellY + 1 - startY : startY - cellY) * deltaY : infinity;
+
+  for (;;) {
+    float t;
+    if (nextX < nextY) {
+      t = nextX;
+      cellX += stepX;
+      nextX += deltaX;
+    } else {
+      t = nextY;
+      cellY += stepY;
+      nextY += deltaY;
+    }
+
+    if (t > 1.0f) return 2.0f;
+    if (tiles.isSolid(cellX, cellY)) {
+      tileX = cellX;
+      tileY = cellY;
+      return t;
+    }
+  }
+}
+
+float ProjectileSystem::sweepTargets(size_t i, float limit, const SpatialGrid& targets, float targetRadius,
+                                     int& target) const {
+  float startX = previousX[i], startY = previousY[i];
+  float dx = x[i] - startX, dy = y[i] - startY;
+  float reach = radius[i] + targetRadius;
+  float reachSquared = reach * reach;
+  float a = dx * dx + dy * dy;
+
+  float best = limit;
+  float endX = startX + dx * limit, endY = startY + dy * limit;
+  targets.forEachInRect(
+      std::min(startX, endX) - reach, std::min(startY, endY) - reach,
+      std::max(startX, endX) + reach, std::max(startY, endY) + reach,
+      [&](uint32_t id, float targetX, float targetY) {
+        // |start + t * d - target| = reach, earliest t
+        float mx = startX - targetX, my = startY - targetY;
+        float c = mx * mx + my * my - reachSquared;
+        float t;
+        if (c <= 0.0f) {
+          t = 0.0f;
+        } else {
+          if (a == 0.0f) return;
+          float b = mx * dx + my * dy;
+          float discriminant = b * b - a * c;
+          if (b >= 0.0f || discriminant < 0.0f) return;
+          t = (-b - std::sqrt(discriminant)) / a;
+        }
+
+        if (t <= best) {
+          best = t;
+          target = static_cast<int>(id);
+        }
+      });
+
+  return best;
+}
+
+void ProjectileSystem::compact() {
+  size_t kept = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (timeLeft[i] <= 0.0f) continue;
+
+    if (kept != i) {
+      x[kept] = x[i];
+      y[kept] = y[i];
+      velocityX[kept] = velocityX[i];
+      velocityY[kept] = velocityY[i];
+      timeLeft[kept] = timeLeft[i];
+      radius[kept] = radius[i];
+      damage[kept] = damage[i];
+      color[kept] = color[i];
+    }
+    kept++;
+  }
+  count = kept;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Common.h"
+#include "SolidTileMask.h"
+#include "SpatialGrid.h"
+#include "Sprite.h"
+#include "SpriteBatch.h"
+#include "Tilemap.h"
+#include "Vector2.h"
+#include "VertexFormat.h"
+
+// Where a projectile stopped: a solid tile or a target
+struct ProjectileHit {
+  Vector2 position;
+  int target;        // Id in the target grid, or -1 for a tile
+  int tileX, tileY;  // Tile hits only
+  int damage;
+};
+
+// Every live projectile in parallel arrays (position, velocity, time
+// left...), kept dense: spawns append and the dead are compacted out after
+// each step. Projectiles are not entities and own no sprites.
+//
+// Steps are fixed (FIXED_STEP). One integrates everything at once (Simd),
+// then sweeps each projectile's path over the step against a bitset of
+// solid tiles (grid traversal, so fast ones can't tunnel through walls)
+// and against the targets in a SpatialGrid, stopping at whichever it
+// reaches first. Hits are appended to storage reused every update.
+//
+// Drawing culls the positions against the view (Simd) and submits the rest
+// into a SpriteBatch as instances of one sprite frame.
+class ProjectileSystem {
+  private:
+    size_t capacity;
+    size_t count;
+
+    std::vector<float> x, y;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> previousX, previousY;  // Start of the step's path
+    std::vector<float> timeLeft;              // <= 0 is removed after the step
+    std::vector<float> radius;
+    std::vector<int> damage;
+    std::vector<uint32_t> color;
+    float maxRadius;
+
+    SolidTileMask tiles;
+
+    float accumulator;
+    uint64_t stepCount;
+    std::vector<ProjectileHit> hits;
+    std::vector<uint32_t> visible;
+
+    // Paths that might hit something this step (bit per projectile), and
+    // target cells with a target within reach (see SpatialGrid::markCellsNear)
+    std::vector<uint64_t> candidateBits;
+    std::vector<uint32_t> candidates;
+    std::vector<uint64_t> targetCells;
+
+    void step(const SpatialGrid* targets, float targetRadius);
+
+    // Fraction of the step's path at which it enters a solid tile, or > 1
+    float sweepTiles(size_t i, int& tileX, int& tileY) const;
+
+    // Same against targets, only looking before `limit`
+    float sweepTargets(size_t i, float limit, const SpatialGrid& targets, float targetRadius,
+                       int& target) const;
+
+    void compact();
+
+  public:
+    static constexpr float FIXED_STEP = 1.0f / 60.0f;
+
+    // Per update; the rest of a longer frame is dropped
+    static const int MAX_STEPS = 4;
+
+    ProjectileSystem(size_t capacity = 65536);
+
+    // Solid tiles stop projectiles (see Tilemap::isSolid); nullptr = none do
+    void setTilemap(const Tilemap* tilemap);
+
+    // False when the pool is full
+    bool spawn(const Vector2& position, const Vector2& velocity, float lifetime, int damage,
+               float radius = 3.0f, uint32_t color = VertexFormat::WHITE);
+
+    // Runs the fixed steps due. Targets are circles of targetRadius at the
+    // grid's points; they hold still for the whole update.
+    void update(float deltaTime, const SpatialGrid* targets, float targetRadius);
+
+    // From the last update
+    const std::vector<ProjectileHit>& getHits() const;
+
+    // The live ones inside the view rect (world min.xy, max.xy), `size`
+    // across and centered on their positions
+    void render(SpriteBatch& batch, const Sprite& sprite, const glm::vec4& viewRect, const Vector2& size,
+                float depth);
+
+    void clear();
+
+    size_t size() const;
+    size_t getCapacity() const;
+
+    // Fixed steps run so far; positions only change when this does
+    uint64_t getStepCount() const;
+};
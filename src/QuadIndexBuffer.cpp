@@ -0,0 +1,27 @@
+#include "QuadIndexBuffer.h"
+#include "GLResources.h"
+
+QuadIndexBuffer::QuadIndexBuffer()
+  : resources(GLResources::acquire())
+{
+}
+
+std::shared_ptr<QuadIndexBuffer> QuadIndexBuffer::acquire() {
+  static std::weak_ptr<QuadIndexBuffer> shared;
+
+  std::shared_ptr<QuadIndexBuffer> buffer = shared.lock();
+  if (!buffer) {
+    buffer = std::shared_ptr<QuadIndexBuffer>(new QuadIndexBuffer());
+    shared = buffer;
+  }
+
+  return buffer;
+}
+
+void QuadIndexBuffer::bind() const {
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, resources->getQuadIndexBuffer());
+}
+
+GLsizei QuadIndexBuffer::indexCount(int quadCount) {
+  return static_cast<GLsizei>(quadCount * 6);
+}
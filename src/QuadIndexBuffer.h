@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Common.h"
+
+class GLResources;
+
+// Static element buffer with the indices of QUAD_CAPACITY quads laid out as
+// 4 vertices each (0,1,2 / 2,1,3), shared by every quad mesh so meshes
+// store 4 vertices per quad instead of 6.
+//
+// The buffer itself is one of GLResources' shared meshes; holding this
+// through shared_ptr keeps the registry (and so the buffer) alive as long
+// as some mesh uses it.
+class QuadIndexBuffer {
+  private:
+    std::shared_ptr<GLResources> resources;
+
+    QuadIndexBuffer();
+
+  public:
+    // 16-bit indices: 16384 quads = 65536 vertices
+    static const int QUAD_CAPACITY = 16384;
+
+    static std::shared_ptr<QuadIndexBuffer> acquire();
+
+    // Attach to the currently bound VAO
+    void bind() const;
+
+    static GLsizei indexCount(int quadCount);
+};
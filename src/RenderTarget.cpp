@@ -0,0 +1,83 @@
+#include "RenderTarget.h"
+
+namespace {
+  const char* OWNER = "RenderTarget";
+}
+
+RenderTarget::RenderTarget(int width, int height, bool withDepth)
+  : hasDepth(withDepth),
+    width(width),
+    height(height)
+{
+  create();
+}
+
+void RenderTarget::create() {
+  // Color attachment
+  colorTexture = GLObject(GLResources::Kind::TEXTURE, OWNER);
+  glBindTexture(GL_TEXTURE_2D, colorTexture.get());
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+  // Nearest filtering keeps pixel art crisp when upscaled
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // Framebuffer
+  FBO = GLObject(GLResources::Kind::FRAMEBUFFER, OWNER);
+  glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture.get(), 0);
+
+  // Depth is never sampled, so a renderbuffer is enough
+  if (hasDepth) {
+    depthBuffer = GLObject(GLResources::Kind::RENDERBUFFER, OWNER);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer.get());
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer.get());
+  }
+
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Render target incomplete (" << width << "x" << height << ")" << std::endl;
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::bind() {
+  glBindFramebuffer(GL_FRAMEBUFFER, FBO.get());
+  glViewport(0, 0, width, height);
+}
+
+void RenderTarget::unbind() {
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderTarget::resize(int newWidth, int newHeight) {
+  if (newWidth == width && newHeight == height) return;
+
+  width = newWidth;
+  height = newHeight;
+
+  // The old attachments go once frames still sampling them are done
+  create();
+}
+
+int RenderTarget::getWidth() const {
+  return width;
+}
+
+int RenderTarget::getHeight() const {
+  return height;
+}
+
+GLuint RenderTarget::getID() const {
+  return FBO.get();
+}
+
+GLuint RenderTarget::getColorTexture() const {
+  return colorTexture.get();
+}
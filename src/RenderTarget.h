@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+
+// Offscreen framebuffer with a nearest-filtered color texture.
+// The scene renders into one of these at the internal resolution and is
+// then upscaled to the window in a single blit.
+class RenderTarget {
+  private:
+    GLObject FBO;
+    GLObject colorTexture;
+    GLObject depthBuffer;
+    bool hasDepth;
+
+    int width;
+    int height;
+
+    void create();
+
+  public:
+    RenderTarget(int width, int height, bool withDepth = false);
+
+    void bind();
+    static void unbind();
+
+    void resize(int newWidth, int newHeight);
+
+    // Getters
+    int getWidth() const;
+    int getHeight() const;
+    GLuint getID() const;
+    GLuint getColorTexture() const;
+};
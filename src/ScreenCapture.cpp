@@ -0,0 +1,403 @@
+#include "ScreenCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+  const char* OWNER = "ScreenCapture";
+
+  // Shutdown only; normal frames never wait
+  const GLuint64 FINISH_TIMEOUT_NS = 1000000000;
+
+  uint8_t clampByte(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+  }
+
+  // RGBA8 bottom row first -> planar 4:2:0, full-range BT.601 (what
+  // C420jpeg means), top row first
+  std::vector<uint8_t> toYCbCr420(const std::vector<uint8_t>& pixels, int width, int height) {
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+
+    std::vector<uint8_t> frame(static_cast<size_t>(width) * height + 2 * chromaWidth * chromaHeight);
+    uint8_t* lumaPlane = frame.data();
+    uint8_t* cbPlane = lumaPlane + width * height;
+    uint8_t* crPlane = cbPlane + chromaWidth * chromaHeight;
+
+    auto pixel = [&](int x, int y) {
+      return &pixels[(static_cast<size_t>(height - 1 - y) * width + x) * 4];
+    };
+
+    for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+        const uint8_t* rgb = pixel(x, y);
+        lumaPlane[y * width + x] = static_cast<uint8_t>((77 * rgb[0] + 150 * rgb[1] + 29 * rgb[2] + 128) >> 8);
+      }
+    }
+
+    for (int cy = 0; cy < chromaHeight; cy++) {
+      for (int cx = 0; cx < chromaWidth; cx++) {
+        int r = 0, g = 0, b = 0, count = 0;
+        for (int y = cy * 2; y < std::min(height, cy * 2 + 2); y++) {
+          for (int x = cx * 2; x < std::min(width, cx * 2 + 2); x++) {
+            const uint8_t* rgb = pixel(x, y);
+            r += rgb[0];
+            g += rgb[1];
+            b += rgb[2];
+            count++;
+          }
+        }
+        r /= count;
+        g /= count;
+        b /= count;
+
+        cbPlane[cy * chromaWidth + cx] = clampByte(128 + ((-43 * r - 85 * g + 128 * b + 128) >> 8));
+        crPlane[cy * chromaWidth + cx] = clampByte(128 + ((128 * r - 107 * g - 21 * b + 128) >> 8));
+      }
+    }
+
+    return frame;
+  }
+}
+
+ScreenCapture::ScreenCapture(int workerCount)
+  : streaming(false),
+    streamFormat(StreamFormat::Y4M),
+    streamFps(60),
+    nextSequence(0),
+    y4mWidth(0),
+    y4mHeight(0),
+    nextY4MFrame(0),
+    unfinishedJobs(0),
+    stopping(false),
+    framesWritten(0),
+    framesDropped(0)
+{
+  workers.resize(std::max(1, workerCount));
+}
+
+ScreenCapture::~ScreenCapture() {
+  stopStream();
+  finish();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  jobReady.notify_all();
+
+  for (std::thread& worker : workers) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+void ScreenCapture::startWorkers() {
+  // Lazily, so a game that never captures runs no extra threads
+  for (std::thread& worker : workers) {
+    if (!worker.joinable()) worker = std::thread(&ScreenCapture::workerLoop, this);
+  }
+}
+
+void ScreenCapture::screenshot(const std::string& path) {
+  pendingScreenshot = path;
+}
+
+bool ScreenCapture::startStream(const std::string& path, StreamFormat format, int fps) {
+  stopStream();
+
+  {
+    // No jobs are in flight after stopStream, so this never waits
+    std::lock_guard<std::mutex> lock(y4mMutex);
+
+    if (format == StreamFormat::Y4M) {
+      y4mFile.open(path, std::ios::binary | std::ios::trunc);
+      if (!y4mFile.is_open()) {
+        std::cerr << "Capture: failed to open " << path << std::endl;
+        return false;
+      }
+    }
+
+    nextY4MFrame = 0;
+    y4mReorder.clear();
+    y4mWidth = 0;
+    y4mHeight = 0;
+  }
+
+  streaming = true;
+  streamFormat = format;
+  streamPath = path;
+  streamFps = std::max(1, fps);
+  nextSequence = 0;
+  framesWritten = 0;
+  framesDropped = 0;
+
+  std::cout << "Recording to " << path << std::endl;
+  return true;
+}
+
+void ScreenCapture::stopStream() {
+  if (!streaming) return;
+  streaming = false;
+
+  // Frames already read back still belong to this stream
+  finish();
+
+  {
+    std::lock_guard<std::mutex> lock(y4mMutex);
+    if (y4mFile.is_open()) y4mFile.close();
+  }
+
+  std::cout << "Recording stopped: " << framesWritten << " frames written, "
+            << framesDropped << " dropped" << std::endl;
+}
+
+bool ScreenCapture::isStreaming() const {
+  return streaming;
+}
+
+bool ScreenCapture::isBusy() const {
+  if (streaming || !pendingScreenshot.empty()) return true;
+
+  for (const Slot& slot : slots) {
+    if (slot.state != SlotState::FREE) return true;
+  }
+  return false;
+}
+
+void ScreenCapture::readFrame(GLuint framebuffer, int width, int height) {
+  collect(false);
+
+  if (width <= 0 || height <= 0) return;
+
+  if (!pendingScreenshot.empty() &&
+      startReadback(Target{ Kind::SCREENSHOT, pendingScreenshot, 0 }, framebuffer, width, height)) {
+    pendingScreenshot.clear();
+  }
+
+  if (!streaming) return;
+
+  Target target{ Kind::Y4M_FRAME, "", nextSequence };
+  if (streamFormat == StreamFormat::PNG_SEQUENCE) {
+    char suffix[32];
+    std::snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(nextSequence + 1));
+    target = Target{ Kind::PNG_FRAME, streamPath + suffix, nextSequence };
+  }
+
+  if (startReadback(target, framebuffer, width, height)) {
+    nextSequence++;
+  } else {
+    framesDropped++;
+  }
+}
+
+bool ScreenCapture::startReadback(const Target& target, GLuint framebuffer, int width, int height) {
+  Slot* slot = nullptr;
+  for (Slot& candidate : slots) {
+    if (candidate.state == SlotState::FREE) {
+      slot = &candidate;
+      break;
+    }
+  }
+
+  // Every slot still in flight: skip rather than stall
+  if (slot == nullptr) return false;
+
+  startWorkers();
+
+  if (slot->buffer.get() == 0) {
+    slot->buffer = GLObject(GLResources::Kind::BUFFER, OWNER);
+  }
+
+  size_t size = static_cast<size_t>(width) * height * 4;
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer.get());
+  if (slot->capacity < size) {
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+    slot->capacity = size;
+  }
+
+  // Into the bound pack buffer, so this returns immediately
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+  if (framebuffer == 0) glReadBuffer(GL_BACK);
+  glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  slot->width = width;
+  slot->height = height;
+  slot->target = target;
+  slot->state = SlotState::READING;
+  return true;
+}
+
+void ScreenCapture::collect(bool wait) {
+  for (int i = 0; i < SLOT_COUNT; i++) {
+    Slot& slot = slots[i];
+
+    if (slot.state == SlotState::MAPPED && slot.copied) {
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+      glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+      glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+      slot.state = SlotState::FREE;
+    }
+
+    if (slot.state != SlotState::READING) continue;
+
+    GLenum status = wait
+        ? glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, FINISH_TIMEOUT_NS)
+        : glClientWaitSync(slot.fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    size_t size = static_cast<size_t>(slot.width) * slot.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.get());
+    void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // A failed map still goes to the workers, so Y4M ordering moves past it
+    if (mapped == nullptr) {
+      std::cerr << "Capture: failed to map readback buffer" << std::endl;
+      slot.state = SlotState::FREE;
+    } else {
+      slot.state = SlotState::MAPPED;
+      slot.copied = false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      jobs.push_back(Job{ mapped != nullptr ? i : -1, static_cast<const uint8_t*>(mapped), {},
+                          slot.width, slot.height, slot.target });
+      unfinishedJobs++;
+    }
+    jobReady.notify_one();
+  }
+}
+
+void ScreenCapture::finish() {
+  // Drain the ring: wait for readbacks, then for workers to copy them out
+  while (true) {
+    collect(true);
+
+    bool busy = false;
+    for (const Slot& slot : slots) {
+      busy = busy || slot.state != SlotState::FREE;
+    }
+    if (!busy) break;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  jobDone.wait(lock, [this] { return unfinishedJobs == 0; });
+}
+
+void ScreenCapture::workerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+      if (jobs.empty()) return;
+
+      job = std::move(jobs.front());
+      jobs.pop_front();
+    }
+
+    // Copy out first so the GL thread can unmap the slot next frame
+    if (job.mapped != nullptr) {
+      size_t size = static_cast<size_t>(job.width) * job.height * 4;
+      job.pixels.assign(job.mapped, job.mapped + size);
+      job.mapped = nullptr;
+      slots[job.slot].copied = true;
+    }
+
+    if (job.target.kind == Kind::Y4M_FRAME) {
+      writeY4M(job);
+    } else {
+      writePNG(job);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      unfinishedJobs--;
+    }
+    jobDone.notify_all();
+  }
+}
+
+void ScreenCapture::writePNG(const Job& job) {
+  if (job.pixels.empty()) {
+    framesDropped++;
+    return;
+  }
+
+  // GL rows start at the bottom; the back buffer's alpha is whatever blending left
+  std::vector<uint8_t> image(job.pixels.size());
+  size_t rowBytes = static_cast<size_t>(job.width) * 4;
+
+  for (int y = 0; y < job.height; y++) {
+    const uint8_t* source = &job.pixels[(job.height - 1 - y) * rowBytes];
+    uint8_t* target = &image[y * rowBytes];
+    std::copy(source, source + rowBytes, target);
+    for (size_t x = 3; x < rowBytes; x += 4) target[x] = 255;
+  }
+
+  SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+      image.data(), job.width, job.height, 32, static_cast<int>(rowBytes), SDL_PIXELFORMAT_RGBA32);
+
+  if (surface == nullptr || IMG_SavePNG(surface, job.target.path.c_str()) != 0) {
+    std::cerr << "Capture: failed to write " << job.target.path << ": " << IMG_GetError() << std::endl;
+    framesDropped++;
+  } else if (job.target.kind == Kind::SCREENSHOT) {
+    std::cout << "Screenshot saved: " << job.target.path << std::endl;
+  } else {
+    framesWritten++;
+  }
+
+  if (surface != nullptr) SDL_FreeSurface(surface);
+}
+
+void ScreenCapture::writeY4M(const Job& job) {
+  Y4MFrame frame{ {}, job.width, job.height };
+  if (!job.pixels.empty()) frame.planes = toYCbCr420(job.pixels, job.width, job.height);
+
+  // Converted in parallel, written in order: frames that arrive early wait
+  // in the reorder buffer, and whoever brings the next one writes out the
+  // run it completes. No worker ever blocks on another's conversion.
+  std::lock_guard<std::mutex> lock(y4mMutex);
+  y4mReorder.emplace(job.target.sequence, std::move(frame));
+
+  for (auto it = y4mReorder.begin(); it != y4mReorder.end() && it->first == nextY4MFrame;
+       it = y4mReorder.erase(it)) {
+    const Y4MFrame& next = it->second;
+
+    if (!next.planes.empty() && y4mWidth == 0) {
+      y4mWidth = next.width;
+      y4mHeight = next.height;
+      y4mFile << "YUV4MPEG2 W" << y4mWidth << " H" << y4mHeight << " F" << streamFps
+              << ":1 Ip A1:1 C420jpeg\n";
+    }
+
+    // The stream's size is fixed by its first frame
+    if (!next.planes.empty() && next.width == y4mWidth && next.height == y4mHeight) {
+      y4mFile << "FRAME\n";
+      y4mFile.write(reinterpret_cast<const char*>(next.planes.data()), next.planes.size());
+      framesWritten++;
+    } else {
+      framesDropped++;
+    }
+
+    nextY4MFrame++;
+  }
+}
+
+int ScreenCapture::getFramesWritten() const {
+  return framesWritten;
+}
+
+int ScreenCapture::getFramesDropped() const {
+  return framesDropped;
+}
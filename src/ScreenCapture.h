@@ -0,0 +1,139 @@
+#pragma once
+
+#include "Common.h"
+#include "GLResources.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Screenshots and frame streams without stalling the pipeline.
+//
+// readFrame starts an asynchronous glReadPixels into a ring of pixel pack
+// buffers. A few frames later, once its fence has signaled, the buffer is
+// mapped and handed to a worker thread, which copies the pixels out (so
+// the slot can be unmapped next frame) and encodes them off the GL thread.
+// If every slot is still busy the frame is dropped, never waited on.
+//
+// Streams are either one Y4M file (4:2:0, for ffmpeg or any player) or a
+// numbered PNG sequence. Screenshots are PNG.
+class ScreenCapture {
+  public:
+    enum class StreamFormat { Y4M, PNG_SEQUENCE };
+
+  private:
+    static const int SLOT_COUNT = 4;
+
+    enum class Kind { SCREENSHOT, PNG_FRAME, Y4M_FRAME };
+
+    enum class SlotState { FREE, READING, MAPPED };
+
+    // What a readback is for, decided when it starts
+    struct Target {
+      Kind kind;
+      std::string path;
+      uint64_t sequence;  // Y4M frames are written in this order
+    };
+
+    struct Slot {
+      GLObject buffer;
+      size_t capacity = 0;
+      int width = 0;
+      int height = 0;
+      GLsync fence = nullptr;
+      SlotState state = SlotState::FREE;
+      Target target;
+      std::atomic<bool> copied{false};  // Set by the worker once it's done with the mapping
+    };
+
+    // Converted Y4M frame waiting for the ones before it; empty = dropped
+    struct Y4MFrame {
+      std::vector<uint8_t> planes;
+      int width;
+      int height;
+    };
+
+    struct Job {
+      int slot;
+      const uint8_t* mapped;
+      std::vector<uint8_t> pixels;  // RGBA8, bottom row first
+      int width;
+      int height;
+      Target target;
+    };
+
+    Slot slots[SLOT_COUNT];
+
+    // Screenshot waiting for a free slot
+    std::string pendingScreenshot;
+
+    // Stream state; the file handles belong to the workers
+    bool streaming;
+    StreamFormat streamFormat;
+    std::string streamPath;
+    int streamFps;
+    uint64_t nextSequence;
+
+    // Y4M writing, under y4mMutex: the file writes are slow, and the GL
+    // thread must only ever wait on the job queue's lock
+    std::mutex y4mMutex;
+    std::ofstream y4mFile;
+    int y4mWidth;
+    int y4mHeight;
+    uint64_t nextY4MFrame;
+    std::map<uint64_t, Y4MFrame> y4mReorder;  // By sequence
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;  // Job queue
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    std::deque<Job> jobs;
+    int unfinishedJobs;  // Queued or being encoded
+    bool stopping;
+
+    std::atomic<int> framesWritten;
+    std::atomic<int> framesDropped;
+
+    void startWorkers();
+    void workerLoop();
+    bool startReadback(const Target& target, GLuint framebuffer, int width, int height);
+    void collect(bool wait);
+    void writePNG(const Job& job);
+    void writeY4M(const Job& job);
+
+  public:
+    // PNG encoding is the slow part; a few workers keep up with 60 fps
+    ScreenCapture(int workerCount = 3);
+
+    // Writes everything still in flight
+    ~ScreenCapture();
+
+    ScreenCapture(const ScreenCapture&) = delete;
+    ScreenCapture& operator=(const ScreenCapture&) = delete;
+
+    // Saved from the next frame readFrame sees
+    void screenshot(const std::string& path);
+
+    // Y4M: path is the file; PNG sequence: path_000001.png, ...
+    bool startStream(const std::string& path, StreamFormat format, int fps = 60);
+    void stopStream();
+    bool isStreaming() const;
+
+    // Something still needs frames to finish: a stream, a screenshot
+    // waiting for a slot or a readback in flight
+    bool isBusy() const;
+
+    // Once per frame, before the swap: collects finished readbacks and
+    // starts one for this frame if anything asked for it. Reads the color
+    // buffer of `framebuffer` (0 = the back buffer).
+    void readFrame(GLuint framebuffer, int width, int height);
+
+    // Blocks until every started readback is encoded (shutdown, replay end)
+    void finish();
+
+    int getFramesWritten() const;
+    int getFramesDropped() const;
+};
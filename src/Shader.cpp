@@ -126,6 +126,10 @@ void Shader::setVec4(const std::string& name, float x, float y, float z, float w
   glUniform4f(glGetUniformLocation(programID, name.c_str()), x, y, z, w);
 }
 
+void Shader::setVec4(const std::string& name, const glm::vec4& value) {
+  glUniform4fv(glGetUniformLocation(programID, name.c_str()), 1, &value[0]);
+}
+
 void Shader::setMat4(const std::string& name, const glm::mat4& matrix) {
   glUniformMatrix4fv(glGetUniformLocation(programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(matrix));
 }
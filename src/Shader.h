@@ -31,5 +31,6 @@ public:
     void setVec2(const std::string& name, const glm::vec2& value);
     void setVec3(const std::string& name, float x, float y, float z);
     void setVec4(const std::string& name, float x, float y, float z, float w);
+    void setVec4(const std::string& name, const glm::vec4& value);
     void setMat4(const std::string& name, const glm::mat4& matrix);
 };
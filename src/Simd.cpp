@@ -0,0 +1,699 @@
+#include "Simd.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+  #define SIMD_X86 1
+  #include <cpuid.h>
+  #include <immintrin.h>
+
+  #define TARGET_SSE2   __attribute__((target("sse2")))
+  #define TARGET_SSE42  __attribute__((target("sse4.2,popcnt")))
+  #define TARGET_AVX2   __attribute__((target("avx2,bmi,bmi2,popcnt")))
+  #define TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512vl,avx512dq,avx2,bmi,bmi2,popcnt")))
+#else
+  #define SIMD_X86 0
+#endif
+
+namespace Simd {
+
+  namespace {
+    // Reference versions; the only ones off x86-64
+
+    void integrateScalar(float* x, float* y, const float* vx, const float* vy, size_t count, float dt) {
+      for (size_t i = 0; i < count; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+      }
+    }
+
+    size_t cullPointsScalar(const float* x, const float* y, size_t count, const float rect[4],
+                            uint32_t* visible) {
+      size_t n = 0;
+      for (size_t i = 0; i < count; i++) {
+        // Branchless: always write, only advance when inside
+        visible[n] = static_cast<uint32_t>(i);
+        n += (x[i] >= rect[0]) & (x[i] <= rect[2]) & (y[i] >= rect[1]) & (y[i] <= rect[3]);
+      }
+      return n;
+    }
+
+    void packSortKeysScalar(const uint32_t* keys, size_t count, uint64_t* packed) {
+      for (size_t i = 0; i < count; i++) {
+        packed[i] = (static_cast<uint64_t>(keys[i]) << 32) | i;
+      }
+    }
+
+    size_t countDescentsScalar(const uint64_t* values, size_t count, size_t limit) {
+      size_t descents = 0;
+      for (size_t i = 1; i < count; i++) {
+        if (values[i] < values[i - 1] && ++descents > limit) break;
+      }
+      return descents;
+    }
+
+    size_t countSetBitsScalar(const uint64_t* words, size_t wordCount) {
+      size_t total = 0;
+      for (size_t i = 0; i < wordCount; i++) {
+        total += static_cast<size_t>(__builtin_popcountll(words[i]));
+      }
+      return total;
+    }
+
+    // Words [first, wordCount), appended at indices
+    size_t findSetBitsFrom(const uint64_t* words, size_t first, size_t wordCount, uint32_t* indices) {
+      size_t n = 0;
+      for (size_t w = first; w < wordCount; w++) {
+        uint64_t bits = words[w];
+        while (bits != 0) {
+          indices[n++] = static_cast<uint32_t>(w * 64 + __builtin_ctzll(bits));
+          bits &= bits - 1;
+        }
+      }
+      return n;
+    }
+
+    size_t findSetBitsScalar(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+      return findSetBitsFrom(words, 0, wordCount, indices);
+    }
+
+#if SIMD_X86
+
+    // pshufb masks that move the selected 32-bit lanes of a vector to the
+    // front, one per 4-bit lane mask
+    struct CompactTable {
+      alignas(16) uint8_t shuffles[16][16];
+
+      CompactTable() {
+        for (int mask = 0; mask < 16; mask++) {
+          int n = 0;
+          for (int lane = 0; lane < 4; lane++) {
+            if ((mask & (1 << lane)) == 0) continue;
+            for (int byte = 0; byte < 4; byte++) shuffles[mask][n * 4 + byte] = static_cast<uint8_t>(lane * 4 + byte);
+            n++;
+          }
+          for (; n < 4; n++) {
+            for (int byte = 0; byte < 4; byte++) shuffles[mask][n * 4 + byte] = 0x80;
+          }
+        }
+      }
+    };
+
+    const CompactTable compactTable;
+
+    // Vector stores of the compacted indices write a full vector at
+    // visible + n. That stays inside the buffer because n <= i and the
+    // block ends at i + width <= count.
+
+    // --- SSE2 ---
+
+    TARGET_SSE2 void integrateSse2(float* x, float* y, const float* vx, const float* vy, size_t count, float dt) {
+      __m128 step = _mm_set1_ps(dt);
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), step)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(vy + i), step)));
+      }
+      integrateScalar(x + i, y + i, vx + i, vy + i, count - i, dt);
+    }
+
+    TARGET_SSE2 size_t cullPointsSse2(const float* x, const float* y, size_t count, const float rect[4],
+                                      uint32_t* visible) {
+      __m128 minX = _mm_set1_ps(rect[0]);
+      __m128 minY = _mm_set1_ps(rect[1]);
+      __m128 maxX = _mm_set1_ps(rect[2]);
+      __m128 maxY = _mm_set1_ps(rect[3]);
+
+      size_t n = 0;
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmple_ps(px, maxX)),
+                                   _mm_and_ps(_mm_cmpge_ps(py, minY), _mm_cmple_ps(py, maxY)));
+
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(inside));
+        while (mask != 0) {
+          visible[n++] = static_cast<uint32_t>(i + __builtin_ctz(mask));
+          mask &= mask - 1;
+        }
+      }
+
+      for (; i < count; i++) {
+        visible[n] = static_cast<uint32_t>(i);
+        n += (x[i] >= rect[0]) & (x[i] <= rect[2]) & (y[i] >= rect[1]) & (y[i] <= rect[3]);
+      }
+      return n;
+    }
+
+    TARGET_SSE2 void packSortKeysSse2(const uint32_t* keys, size_t count, uint64_t* packed) {
+      __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+      __m128i step = _mm_set1_epi32(4);
+
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        // (index, key) pairs are little-endian key << 32 | index
+        __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + i), _mm_unpacklo_epi32(index, key));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(packed + i + 2), _mm_unpackhi_epi32(index, key));
+        index = _mm_add_epi32(index, step);
+      }
+
+      for (; i < count; i++) packed[i] = (static_cast<uint64_t>(keys[i]) << 32) | i;
+    }
+
+    // No popcnt instruction: the bit-twiddling count on two words at once,
+    // summed per 64-bit half by psadbw
+    TARGET_SSE2 size_t countSetBitsSse2(const uint64_t* words, size_t wordCount) {
+      const __m128i ones = _mm_set1_epi8(0x55);
+      const __m128i pairs = _mm_set1_epi8(0x33);
+      const __m128i nibbles = _mm_set1_epi8(0x0F);
+
+      __m128i sums = _mm_setzero_si128();
+      size_t i = 0;
+      for (; i + 2 <= wordCount; i += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + i));
+        v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi64(v, 1), ones));
+        v = _mm_add_epi8(_mm_and_si128(v, pairs), _mm_and_si128(_mm_srli_epi64(v, 2), pairs));
+        v = _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi64(v, 4)), nibbles);
+        sums = _mm_add_epi64(sums, _mm_sad_epu8(v, _mm_setzero_si128()));
+      }
+
+      uint64_t lanes[2];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sums);
+      return static_cast<size_t>(lanes[0] + lanes[1]) + countSetBitsScalar(words + i, wordCount - i);
+    }
+
+    TARGET_SSE2 size_t findSetBitsSse2(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+      size_t n = 0;
+      size_t w = 0;
+      for (; w + 2 <= wordCount; w += 2) {
+        // Sparse bitsets are mostly zero words; skip them two at a time
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + w));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, _mm_setzero_si128())) == 0xFFFF) continue;
+
+        for (size_t j = w; j < w + 2; j++) {
+          uint64_t bits = words[j];
+          while (bits != 0) {
+            indices[n++] = static_cast<uint32_t>(j * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+          }
+        }
+      }
+
+      return n + findSetBitsFrom(words, w, wordCount, indices + n);
+    }
+
+    // --- SSE4.2 (with SSSE3 shuffles and popcnt) ---
+
+    TARGET_SSE42 size_t cullPointsSse42(const float* x, const float* y, size_t count, const float rect[4],
+                                        uint32_t* visible) {
+      __m128 minX = _mm_set1_ps(rect[0]);
+      __m128 minY = _mm_set1_ps(rect[1]);
+      __m128 maxX = _mm_set1_ps(rect[2]);
+      __m128 maxY = _mm_set1_ps(rect[3]);
+      __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+      __m128i step = _mm_set1_epi32(4);
+
+      size_t n = 0;
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(px, minX), _mm_cmple_ps(px, maxX)),
+                                   _mm_and_ps(_mm_cmpge_ps(py, minY), _mm_cmple_ps(py, maxY)));
+        int mask = _mm_movemask_ps(inside);
+
+        // Left-pack the visible indices with one shuffle
+        __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(compactTable.shuffles[mask]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(visible + n), _mm_shuffle_epi8(index, shuffle));
+        n += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+        index = _mm_add_epi32(index, step);
+      }
+
+      for (; i < count; i++) {
+        visible[n] = static_cast<uint32_t>(i);
+        n += (x[i] >= rect[0]) & (x[i] <= rect[2]) & (y[i] >= rect[1]) & (y[i] <= rect[3]);
+      }
+      return n;
+    }
+
+    // SSE2 has no 64-bit compare; pcmpgtq is signed, so flip the sign bits
+    TARGET_SSE42 size_t countDescentsSse42(const uint64_t* values, size_t count, size_t limit) {
+      const __m128i bias = _mm_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+
+      size_t descents = 0;
+      size_t i = 1;
+      for (; i + 2 <= count; i += 2) {
+        __m128i previous = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i - 1)), bias);
+        __m128i current = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)), bias);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(previous, current)));
+
+        descents += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(mask)));
+        if (descents > limit) return descents;
+      }
+
+      for (; i < count; i++) {
+        if (values[i] < values[i - 1] && ++descents > limit) break;
+      }
+      return descents;
+    }
+
+    TARGET_SSE42 size_t countSetBitsSse42(const uint64_t* words, size_t wordCount) {
+      // Four chains so the popcnt latency overlaps
+      uint64_t sums[4] = {};
+      size_t i = 0;
+      for (; i + 4 <= wordCount; i += 4) {
+        for (int lane = 0; lane < 4; lane++) sums[lane] += static_cast<uint64_t>(__builtin_popcountll(words[i + lane]));
+      }
+      for (; i < wordCount; i++) sums[0] += static_cast<uint64_t>(__builtin_popcountll(words[i]));
+
+      return static_cast<size_t>(sums[0] + sums[1] + sums[2] + sums[3]);
+    }
+
+    TARGET_SSE42 size_t findSetBitsSse42(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+      size_t n = 0;
+      size_t w = 0;
+      for (; w + 2 <= wordCount; w += 2) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + w));
+        if (_mm_testz_si128(v, v)) continue;
+
+        for (size_t j = w; j < w + 2; j++) {
+          uint64_t bits = words[j];
+          while (bits != 0) {
+            indices[n++] = static_cast<uint32_t>(j * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+          }
+        }
+      }
+
+      return n + findSetBitsFrom(words, w, wordCount, indices + n);
+    }
+
+    // --- AVX2 (with BMI1/2) ---
+
+    TARGET_AVX2 void integrateAvx2(float* x, float* y, const float* vx, const float* vy, size_t count, float dt) {
+      __m256 step = _mm256_set1_ps(dt);
+      size_t i = 0;
+      for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), step)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), step)));
+      }
+      integrateScalar(x + i, y + i, vx + i, vy + i, count - i, dt);
+    }
+
+    TARGET_AVX2 size_t cullPointsAvx2(const float* x, const float* y, size_t count, const float rect[4],
+                                      uint32_t* visible) {
+      __m256 minX = _mm256_set1_ps(rect[0]);
+      __m256 minY = _mm256_set1_ps(rect[1]);
+      __m256 maxX = _mm256_set1_ps(rect[2]);
+      __m256 maxY = _mm256_set1_ps(rect[3]);
+      __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+      __m256i step = _mm256_set1_epi32(8);
+
+      size_t n = 0;
+      size_t i = 0;
+      for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 inside = _mm256_and_ps(
+            _mm256_and_ps(_mm256_cmp_ps(px, minX, _CMP_GE_OQ), _mm256_cmp_ps(px, maxX, _CMP_LE_OQ)),
+            _mm256_and_ps(_mm256_cmp_ps(py, minY, _CMP_GE_OQ), _mm256_cmp_ps(py, maxY, _CMP_LE_OQ)));
+        uint64_t mask = static_cast<uint64_t>(_mm256_movemask_ps(inside));
+
+        // Lane mask -> byte mask -> the selected lane numbers, packed low
+        uint64_t bytes = _pdep_u64(mask, 0x0101010101010101ull) * 0xFF;
+        uint64_t lanes = _pext_u64(0x0706050403020100ull, bytes);
+        __m256i permutation = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128(static_cast<long long>(lanes)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + n),
+                            _mm256_permutevar8x32_epi32(index, permutation));
+        n += static_cast<size_t>(_mm_popcnt_u64(mask));
+        index = _mm256_add_epi32(index, step);
+      }
+
+      for (; i < count; i++) {
+        visible[n] = static_cast<uint32_t>(i);
+        n += (x[i] >= rect[0]) & (x[i] <= rect[2]) & (y[i] >= rect[1]) & (y[i] <= rect[3]);
+      }
+      return n;
+    }
+
+    TARGET_AVX2 void packSortKeysAvx2(const uint32_t* keys, size_t count, uint64_t* packed) {
+      __m256i index = _mm256_setr_epi64x(0, 1, 2, 3);
+      __m256i step = _mm256_set1_epi64x(4);
+
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        __m256i key = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(packed + i),
+                            _mm256_or_si256(_mm256_slli_epi64(key, 32), index));
+        index = _mm256_add_epi64(index, step);
+      }
+
+      for (; i < count; i++) packed[i] = (static_cast<uint64_t>(keys[i]) << 32) | i;
+    }
+
+    TARGET_AVX2 size_t countDescentsAvx2(const uint64_t* values, size_t count, size_t limit) {
+      const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+
+      size_t descents = 0;
+      size_t i = 1;
+      for (; i + 4 <= count; i += 4) {
+        __m256i previous = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i - 1)), bias);
+        __m256i current = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)), bias);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(previous, current)));
+
+        descents += static_cast<size_t>(_mm_popcnt_u32(static_cast<unsigned>(mask)));
+        if (descents > limit) return descents;
+      }
+
+      for (; i < count; i++) {
+        if (values[i] < values[i - 1] && ++descents > limit) break;
+      }
+      return descents;
+    }
+
+    // Nibble lookup with pshufb, summed per 64-bit lane by vpsadbw
+    TARGET_AVX2 size_t countSetBitsAvx2(const uint64_t* words, size_t wordCount) {
+      const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                             0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+      const __m256i low = _mm256_set1_epi8(0x0F);
+
+      __m256i sums = _mm256_setzero_si256();
+      size_t i = 0;
+      for (; i + 4 <= wordCount; i += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+        __m256i counts = _mm256_add_epi8(
+            _mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+            _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+      }
+
+      uint64_t lanes[4];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sums);
+      size_t total = static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+      for (; i < wordCount; i++) total += static_cast<size_t>(_mm_popcnt_u64(words[i]));
+      return total;
+    }
+
+    TARGET_AVX2 size_t findSetBitsAvx2(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+      size_t n = 0;
+      size_t w = 0;
+      for (; w + 4 <= wordCount; w += 4) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + w));
+        if (_mm256_testz_si256(v, v)) continue;
+
+        for (size_t j = w; j < w + 4; j++) {
+          uint64_t bits = words[j];
+          while (bits != 0) {
+            indices[n++] = static_cast<uint32_t>(j * 64 + _tzcnt_u64(bits));
+            bits = _blsr_u64(bits);
+          }
+        }
+      }
+
+      return n + findSetBitsFrom(words, w, wordCount, indices + n);
+    }
+
+    // --- AVX-512 (F, BW, VL, DQ) ---
+
+    // GCC 12's headers seed some AVX-512 intrinsics with a self-initialized
+    // "undefined" vector, which -Wuninitialized reports at -O2
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+    TARGET_AVX512 void integrateAvx512(float* x, float* y, const float* vx, const float* vy, size_t count, float dt) {
+      __m512 step = _mm512_set1_ps(dt);
+      size_t i = 0;
+      for (; i + 16 <= count; i += 16) {
+        _mm512_storeu_ps(x + i, _mm512_add_ps(_mm512_loadu_ps(x + i), _mm512_mul_ps(_mm512_loadu_ps(vx + i), step)));
+        _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(_mm512_loadu_ps(vy + i), step)));
+      }
+
+      // Masked tail instead of a scalar loop
+      if (i < count) {
+        __mmask16 tail = static_cast<__mmask16>((1u << (count - i)) - 1);
+        __m512 px = _mm512_maskz_loadu_ps(tail, x + i);
+        __m512 py = _mm512_maskz_loadu_ps(tail, y + i);
+        _mm512_mask_storeu_ps(x + i, tail, _mm512_add_ps(px, _mm512_mul_ps(_mm512_maskz_loadu_ps(tail, vx + i), step)));
+        _mm512_mask_storeu_ps(y + i, tail, _mm512_add_ps(py, _mm512_mul_ps(_mm512_maskz_loadu_ps(tail, vy + i), step)));
+      }
+    }
+
+    TARGET_AVX512 size_t cullPointsAvx512(const float* x, const float* y, size_t count, const float rect[4],
+                                          uint32_t* visible) {
+      __m512 minX = _mm512_set1_ps(rect[0]);
+      __m512 minY = _mm512_set1_ps(rect[1]);
+      __m512 maxX = _mm512_set1_ps(rect[2]);
+      __m512 maxY = _mm512_set1_ps(rect[3]);
+      __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+      __m512i step = _mm512_set1_epi32(16);
+
+      size_t n = 0;
+      size_t i = 0;
+      for (; i < count; i += 16) {
+        __mmask16 valid = count - i >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                          : static_cast<__mmask16>((1u << (count - i)) - 1);
+        __m512 px = _mm512_maskz_loadu_ps(valid, x + i);
+        __m512 py = _mm512_maskz_loadu_ps(valid, y + i);
+
+        __mmask16 inside = _mm512_mask_cmp_ps_mask(valid, px, minX, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, px, maxX, _CMP_LE_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, py, minY, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, py, maxY, _CMP_LE_OQ);
+
+        if (valid == 0xFFFF) {
+          // Compress in a register; compressing straight to memory is slow on some cores
+          _mm512_storeu_si512(visible + n, _mm512_maskz_compress_epi32(inside, index));
+        } else {
+          _mm512_mask_compressstoreu_epi32(visible + n, inside, index);
+        }
+        n += static_cast<size_t>(_mm_popcnt_u32(inside));
+        index = _mm512_add_epi32(index, step);
+      }
+      return n;
+    }
+
+    TARGET_AVX512 void packSortKeysAvx512(const uint32_t* keys, size_t count, uint64_t* packed) {
+      __m512i index = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+      __m512i step = _mm512_set1_epi64(8);
+
+      size_t i = 0;
+      for (; i + 8 <= count; i += 8) {
+        __m512i key = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)));
+        _mm512_storeu_si512(packed + i, _mm512_or_si512(_mm512_slli_epi64(key, 32), index));
+        index = _mm512_add_epi64(index, step);
+      }
+
+      for (; i < count; i++) packed[i] = (static_cast<uint64_t>(keys[i]) << 32) | i;
+    }
+
+    TARGET_AVX512 size_t countDescentsAvx512(const uint64_t* values, size_t count, size_t limit) {
+      size_t descents = 0;
+      size_t i = 1;
+      for (; i + 8 <= count; i += 8) {
+        __m512i previous = _mm512_loadu_si512(values + i - 1);
+        __m512i current = _mm512_loadu_si512(values + i);
+
+        // Unsigned compares exist here; no bias needed
+        descents += static_cast<size_t>(_mm_popcnt_u32(_mm512_cmpgt_epu64_mask(previous, current)));
+        if (descents > limit) return descents;
+      }
+
+      for (; i < count; i++) {
+        if (values[i] < values[i - 1] && ++descents > limit) break;
+      }
+      return descents;
+    }
+
+    TARGET_AVX512 size_t countSetBitsAvx512(const uint64_t* words, size_t wordCount) {
+      const __m512i table = _mm512_broadcast_i32x4(_mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4));
+      const __m512i low = _mm512_set1_epi8(0x0F);
+
+      __m512i sums = _mm512_setzero_si512();
+      size_t i = 0;
+      for (; i + 8 <= wordCount; i += 8) {
+        __m512i v = _mm512_loadu_si512(words + i);
+        __m512i counts = _mm512_add_epi8(
+            _mm512_shuffle_epi8(table, _mm512_and_si512(v, low)),
+            _mm512_shuffle_epi8(table, _mm512_and_si512(_mm512_srli_epi16(v, 4), low)));
+        sums = _mm512_add_epi64(sums, _mm512_sad_epu8(counts, _mm512_setzero_si512()));
+      }
+
+      size_t total = static_cast<size_t>(_mm512_reduce_add_epi64(sums));
+      for (; i < wordCount; i++) total += static_cast<size_t>(_mm_popcnt_u64(words[i]));
+      return total;
+    }
+
+    TARGET_AVX512 size_t findSetBitsAvx512(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+      size_t n = 0;
+      size_t w = 0;
+      for (; w + 8 <= wordCount; w += 8) {
+        // One bit per non-zero word; visit only those
+        __m512i v = _mm512_loadu_si512(words + w);
+        unsigned nonZero = _mm512_test_epi64_mask(v, v);
+
+        while (nonZero != 0) {
+          size_t j = w + _tzcnt_u32(nonZero);
+          nonZero = _blsr_u32(nonZero);
+
+          uint64_t bits = words[j];
+          while (bits != 0) {
+            indices[n++] = static_cast<uint32_t>(j * 64 + _tzcnt_u64(bits));
+            bits = _blsr_u64(bits);
+          }
+        }
+      }
+
+      return n + findSetBitsFrom(words, w, wordCount, indices + n);
+    }
+
+    #pragma GCC diagnostic pop
+
+    const Kernels KERNELS[LEVEL_COUNT] = {
+      { integrateScalar, cullPointsScalar, packSortKeysScalar, countDescentsScalar,
+        countSetBitsScalar, findSetBitsScalar },
+      // SSE2 has no 64-bit compare for countDescents
+      { integrateSse2, cullPointsSse2, packSortKeysSse2, countDescentsScalar,
+        countSetBitsSse2, findSetBitsSse2 },
+      // Nothing in SSE4.2 helps streaming float math or key packing
+      { integrateSse2, cullPointsSse42, packSortKeysSse2, countDescentsSse42,
+        countSetBitsSse42, findSetBitsSse42 },
+      { integrateAvx2, cullPointsAvx2, packSortKeysAvx2, countDescentsAvx2,
+        countSetBitsAvx2, findSetBitsAvx2 },
+      { integrateAvx512, cullPointsAvx512, packSortKeysAvx512, countDescentsAvx512,
+        countSetBitsAvx512, findSetBitsAvx512 },
+    };
+
+    uint64_t readXcr0() {
+      uint32_t eax = 0;
+      uint32_t edx = 0;
+      __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+      return (static_cast<uint64_t>(edx) << 32) | eax;
+    }
+
+    Level detectLevel() {
+      unsigned eax, ebx, ecx, edx;
+
+      // SSE2 is part of x86-64
+      Level level = Level::SSE2;
+      unsigned maxLeaf = __get_cpuid_max(0, nullptr);
+      if (maxLeaf < 1) return level;
+
+      __cpuid(1, eax, ebx, ecx, edx);
+      bool sse42 = (ecx & bit_SSSE3) && (ecx & bit_SSE4_1) && (ecx & bit_SSE4_2) && (ecx & bit_POPCNT);
+      if (!sse42) return level;
+      level = Level::SSE42;
+
+      // AVX registers also need the OS to save them (XCR0 bits 1-2)
+      if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX)) return level;
+      uint64_t xcr0 = readXcr0();
+      if ((xcr0 & 0x6) != 0x6 || maxLeaf < 7) return level;
+
+      __cpuid_count(7, 0, eax, ebx, ecx, edx);
+      bool avx2 = (ebx & bit_AVX2) && (ebx & bit_BMI) && (ebx & bit_BMI2);
+      if (!avx2) return level;
+      level = Level::AVX2;
+
+      // ...and the opmask and upper ZMM state (bits 5-7)
+      bool avx512 = (ebx & bit_AVX512F) && (ebx & bit_AVX512BW) && (ebx & bit_AVX512VL) &&
+                    (ebx & bit_AVX512DQ) && (xcr0 & 0xE0) == 0xE0;
+      if (avx512) level = Level::AVX512;
+
+      return level;
+    }
+
+#else
+
+    const Kernels SCALAR_KERNELS = {
+      integrateScalar, cullPointsScalar, packSortKeysScalar, countDescentsScalar,
+      countSetBitsScalar, findSetBitsScalar
+    };
+
+    const Kernels KERNELS[LEVEL_COUNT] = {
+      SCALAR_KERNELS, SCALAR_KERNELS, SCALAR_KERNELS, SCALAR_KERNELS, SCALAR_KERNELS
+    };
+
+    Level detectLevel() {
+      return Level::SCALAR;
+    }
+
+#endif
+
+    const char* LEVEL_NAMES[LEVEL_COUNT] = { "scalar", "sse2", "sse4.2", "avx2", "avx512" };
+
+    Level initialLevel() {
+      Level best = detect();
+      Level level = best;
+
+      const char* forced = std::getenv("GAME_SIMD");
+      if (forced != nullptr) {
+        Level requested;
+        if (!parseLevel(forced, requested)) {
+          std::cerr << "GAME_SIMD: unknown level '" << forced << "'" << std::endl;
+        } else if (requested > best) {
+          std::cerr << "GAME_SIMD: " << forced << " not supported here" << std::endl;
+        } else {
+          level = requested;
+        }
+      }
+
+      std::cout << "SIMD: " << levelName(level) << " (best " << levelName(best) << ")" << std::endl;
+      return level;
+    }
+
+    Level& selectedLevel() {
+      static Level level = initialLevel();
+      return level;
+    }
+  }
+
+  Level detect() {
+    static const Level best = detectLevel();
+    return best;
+  }
+
+  bool isSupported(Level level) {
+    return level >= Level::SCALAR && level <= detect();
+  }
+
+  Level getLevel() {
+    return selectedLevel();
+  }
+
+  bool setLevel(Level level) {
+    if (!isSupported(level)) return false;
+
+    selectedLevel() = level;
+    return true;
+  }
+
+  const char* levelName(Level level) {
+    int index = static_cast<int>(level);
+    return index >= 0 && index < LEVEL_COUNT ? LEVEL_NAMES[index] : "unknown";
+  }
+
+  bool parseLevel(const char* name, Level& level) {
+    for (int index = 0; index < LEVEL_COUNT; index++) {
+      if (std::strcmp(name, LEVEL_NAMES[index]) == 0) {
+        level = static_cast<Level>(index);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const Kernels& kernels() {
+    return KERNELS[static_cast<int>(selectedLevel())];
+  }
+
+  const Kernels& kernelsFor(Level level) {
+    // Never hand out code the CPU can't run
+    if (!isSupported(level)) level = detect();
+    return KERNELS[static_cast<int>(level)];
+  }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Hot loops compiled for several x86 ISA levels and picked at startup.
+//
+// The build targets plain x86-64 (SSE2), so wider versions are compiled
+// per function with target attributes and only called when cpuid (and
+// xgetbv, for AVX register state) says the CPU and OS support them. One
+// binary runs on old kiosks and uses AVX-512 where it exists.
+//
+// Every level produces bit-identical results (no FMA contraction), so a
+// forced level is a valid test of the others. Set GAME_SIMD to scalar,
+// sse2, sse4.2, avx2 or avx512 to force one; levels the CPU lacks fall
+// back to the best supported one below.
+namespace Simd {
+
+  enum class Level { SCALAR, SSE2, SSE42, AVX2, AVX512, COUNT };
+
+  static const int LEVEL_COUNT = static_cast<int>(Level::COUNT);
+
+  struct Kernels {
+    // x += vx * dt, y += vy * dt
+    void (*integrate)(float* x, float* y, const float* vx, const float* vy, size_t count, float dt);
+
+    // Indices of points inside rect (min.xy, max.xy inclusive), in order.
+    // `visible` needs room for `count`.
+    size_t (*cullPoints)(const float* x, const float* y, size_t count, const float rect[4],
+                         uint32_t* visible);
+
+    // packed[i] = key << 32 | i, the radix sort's input
+    void (*packSortKeys)(const uint32_t* keys, size_t count, uint64_t* packed);
+
+    // How many values are smaller than the one before. Stops counting
+    // somewhere past `limit`, so only compare the result against it.
+    size_t (*countDescents)(const uint64_t* values, size_t count, size_t limit);
+
+    size_t (*countSetBits)(const uint64_t* words, size_t wordCount);
+
+    // Indices of set bits in ascending order; `indices` needs room for all
+    // of them (countSetBits)
+    size_t (*findSetBits)(const uint64_t* words, size_t wordCount, uint32_t* indices);
+  };
+
+  // Best level this CPU and OS support
+  Level detect();
+  bool isSupported(Level level);
+
+  // Selected on first use: detect(), or GAME_SIMD if set
+  Level getLevel();
+
+  // For tests and benchmarks; false (and no change) if unsupported
+  bool setLevel(Level level);
+
+  const char* levelName(Level level);
+  bool parseLevel(const char* name, Level& level);
+
+  // Kernels of the selected level, or of a supported one
+  const Kernels& kernels();
+  const Kernels& kernelsFor(Level level);
+
+  inline void integrate(float* x, float* y, const float* vx, const float* vy, size_t count, float dt) {
+    kernels().integrate(x, y, vx, vy, count, dt);
+  }
+
+  inline size_t cullPoints(const float* x, const float* y, size_t count, const float rect[4],
+                           uint32_t* visible) {
+    return kernels().cullPoints(x, y, count, rect, visible);
+  }
+
+  inline void packSortKeys(const uint32_t* keys, size_t count, uint64_t* packed) {
+    kernels().packSortKeys(keys, count, packed);
+  }
+
+  inline size_t countDescents(const uint64_t* values, size_t count, size_t limit) {
+    return kernels().countDescents(values, count, limit);
+  }
+
+  inline size_t countSetBits(const uint64_t* words, size_t wordCount) {
+    return kernels().countSetBits(words, wordCount);
+  }
+
+  inline size_t findSetBits(const uint64_t* words, size_t wordCount, uint32_t* indices) {
+    return kernels().findSetBits(words, wordCount, indices);
+  }
+}
@@ -0,0 +1,61 @@
+#include "SolidTileMask.h"
+
+SolidTileMask::SolidTileMask()
+  : tilemap(nullptr),
+    seenRevision(0),
+    tileCountX(0),
+    tileCountY(0),
+    tileSize(1.0f),
+    inverseTileSize(1.0f)
+{
+}
+
+void SolidTileMask::setTilemap(const Tilemap* tilemap) {
+  this->tilemap = tilemap;
+  bits.clear();
+  tileCountX = 0;
+  tileCountY = 0;
+  if (tilemap == nullptr) return;
+
+  tileCountX = tilemap->getTileCountX();
+  tileCountY = tilemap->getTileCountY();
+  tileSize = static_cast<float>(tilemap->getTileSize());
+  inverseTileSize = 1.0f / tileSize;
+  seenRevision = tilemap->getRevision();
+
+  bits.assign((static_cast<size_t>(tileCountX) * tileCountY + 63) / 64, 0);
+  for (int tileY = 0; tileY < tileCountY; tileY++) {
+    for (int tileX = 0; tileX < tileCountX; tileX++) {
+      if (tilemap->isSolid(tileX, tileY)) set(tileX, tileY, true);
+    }
+  }
+}
+
+void SolidTileMask::sync() {
+  if (tilemap == nullptr || tilemap->getRevision() == seenRevision) return;
+
+  // Fell behind the journal (or the map changed size): start over
+  pendingChanges.clear();
+  if (!tilemap->getChangesSince(seenRevision, pendingChanges) ||
+      tilemap->getTileCountX() != tileCountX || tilemap->getTileCountY() != tileCountY) {
+    setTilemap(tilemap);
+    return;
+  }
+
+  for (const TileChange& change : pendingChanges) {
+    set(change.x, change.y, tilemap->isSolid(change.x, change.y));
+  }
+  seenRevision = tilemap->getRevision();
+}
+
+void SolidTileMask::set(int tileX, int tileY, bool value) {
+  if (tileX < 0 || tileY < 0 || tileX >= tileCountX || tileY >= tileCountY) return;
+
+  size_t bit = static_cast<size_t>(tileY) * tileCountX + tileX;
+  uint64_t mask = uint64_t(1) << (bit & 63);
+  if (value) {
+    bits[bit >> 6] |= mask;
+  } else {
+    bits[bit >> 6] &= ~mask;
+  }
+}
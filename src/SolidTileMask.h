@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Common.h"
+#include "Tilemap.h"
+
+// A tilemap's solid tiles (Tilemap::isSolid), one bit each, for systems
+// that test thousands of points a step. Kept in sync through the map's
+// change journal, so edits cost only the tiles they touched.
+class SolidTileMask {
+  private:
+    const Tilemap* tilemap;
+    uint64_t seenRevision;
+    int tileCountX, tileCountY;
+    float tileSize;
+    float inverseTileSize;
+    std::vector<uint64_t> bits;
+    std::vector<TileChange> pendingChanges;
+
+    void set(int tileX, int tileY, bool value);
+
+  public:
+    SolidTileMask();
+
+    // nullptr = nothing is solid
+    void setTilemap(const Tilemap* tilemap);
+
+    // Applies the map's edits since the last call
+    void sync();
+
+    bool hasTilemap() const { return tilemap != nullptr; }
+
+    // Off the map counts as solid, like Tilemap::isSolid
+    bool isSolid(int tileX, int tileY) const {
+      if (tilemap == nullptr) return false;
+      if (tileX < 0 || tileY < 0 || tileX >= tileCountX || tileY >= tileCountY) return true;
+
+      size_t bit = static_cast<size_t>(tileY) * tileCountX + tileX;
+      return (bits[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    // Same, by tile index (y * tileCountX + x); must be on the map
+    bool isSolidIndex(size_t bit) const {
+      return (bits[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    bool isSolidAt(float worldX, float worldY) const {
+      return isSolid(tileFloor(worldX), tileFloor(worldY));
+    }
+
+    // World coordinate to tile coordinate
+    int tileFloor(float world) const {
+      return floorToInt(world * inverseTileSize);
+    }
+
+    // std::floor is a libm call on plain x86-64 (no SSE4.1 round)
+    static int floorToInt(float value) {
+      int truncated = static_cast<int>(value);
+      return truncated - (value < static_cast<float>(truncated));
+    }
+
+    int getTileCountX() const { return tileCountX; }
+    int getTileCountY() const { return tileCountY; }
+    float getTileSize() const { return tileSize; }
+    float getInverseTileSize() const { return inverseTileSize; }
+};
@@ -0,0 +1,91 @@
+#include "SpatialGrid.h"
+
+SpatialGrid::SpatialGrid(float cellSize)
+  : requestedCellSize(std::max(cellSize, 1.0f)),
+    cellSize(requestedCellSize),
+    inverseCellSize(1.0f / requestedCellSize),
+    originX(0.0f),
+    originY(0.0f),
+    columns(1),
+    rows(1),
+    cellStart(2, 0)
+{
+}
+
+void SpatialGrid::build(const float* x, const float* y, size_t count, const glm::vec4& bounds) {
+  float width = std::max(bounds.z - bounds.x, 1.0f);
+  float height = std::max(bounds.w - bounds.y, 1.0f);
+
+  cellSize = requestedCellSize;
+  for (;;) {
+    columns = std::max(1, static_cast<int>(std::ceil(width / cellSize)));
+    rows = std::max(1, static_cast<int>(std::ceil(height / cellSize)));
+    if (static_cast<int64_t>(columns) * rows <= MAX_CELLS) break;
+    cellSize *= 2.0f;
+  }
+  inverseCellSize = 1.0f / cellSize;
+  originX = bounds.x;
+  originY = bounds.y;
+
+  // Count per cell, shifted by one so the prefix sum gives start offsets
+  size_t cellCount = static_cast<size_t>(columns) * rows;
+  cellStart.assign(cellCount + 1, 0);
+  pointCell.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t cell = static_cast<uint32_t>(cellRow(y[i]) * columns + cellColumn(x[i]));
+    pointCell[i] = cell;
+    cellStart[cell + 1]++;
+  }
+
+  for (size_t cell = 0; cell < cellCount; cell++) {
+    cellStart[cell + 1] += cellStart[cell];
+  }
+
+  // Scatter, advancing each cell's start; afterwards they hold the ends,
+  // which are the next cell's starts, so shift them back
+  ids.resize(count);
+  pointX.resize(count);
+  pointY.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    uint32_t slot = cellStart[pointCell[i]]++;
+    ids[slot] = static_cast<uint32_t>(i);
+    pointX[slot] = x[i];
+    pointY[slot] = y[i];
+  }
+
+  for (size_t cell = cellCount; cell > 0; cell--) {
+    cellStart[cell] = cellStart[cell - 1];
+  }
+  cellStart[0] = 0;
+}
+
+void SpatialGrid::markCellsNear(float margin, std::vector<uint64_t>& mask) const {
+  mask.assign((static_cast<size_t>(columns) * rows + 63) / 64, 0);
+
+  for (size_t slot = 0; slot < ids.size(); slot++) {
+    int column0 = cellColumn(pointX[slot] - margin), column1 = cellColumn(pointX[slot] + margin);
+    int row0 = cellRow(pointY[slot] - margin), row1 = cellRow(pointY[slot] + margin);
+    for (int row = row0; row <= row1; row++) {
+      for (int column = column0; column <= column1; column++) {
+        size_t cell = static_cast<size_t>(row) * columns + column;
+        mask[cell >> 6] |= uint64_t(1) << (cell & 63);
+      }
+    }
+  }
+}
+
+size_t SpatialGrid::size() const {
+  return ids.size();
+}
+
+float SpatialGrid::getCellSize() const {
+  return cellSize;
+}
+
+int SpatialGrid::getColumns() const {
+  return columns;
+}
+
+int SpatialGrid::getRows() const {
+  return rows;
+}
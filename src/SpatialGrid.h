@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Common.h"
+
+// Uniform grid over points, rebuilt from scratch with a counting sort:
+// per-cell start offsets, then the ids and positions grouped by cell, so
+// a query reads a few contiguous runs. Points outside the bounds land in
+// the edge cells. Rebuilding costs O(points + cells), with no allocation
+// once the storage has grown.
+class SpatialGrid {
+  private:
+    float requestedCellSize;
+    float cellSize;
+    float inverseCellSize;
+    float originX, originY;
+    int columns, rows;
+
+    std::vector<uint32_t> cellStart;  // columns * rows + 1
+    std::vector<uint32_t> ids;
+    std::vector<float> pointX, pointY;
+    std::vector<uint32_t> pointCell;  // Build scratch
+
+  public:
+    // Cells past this are merged by growing the cell size
+    static const int MAX_CELLS = 1 << 22;
+
+    // Cap on forEachNear's count
+    static const int MAX_NEAR = 64;
+
+    SpatialGrid(float cellSize);
+
+    // Ids are indices into x/y; bounds are world min.xy, max.xy
+    void build(const float* x, const float* y, size_t count, const glm::vec4& bounds);
+
+    // Clamped; truncation already puts the negative side's first cell in 0
+    int cellColumn(float x) const {
+      int column = static_cast<int>((x - originX) * inverseCellSize);
+      return std::max(0, std::min(column, columns - 1));
+    }
+
+    int cellRow(float y) const {
+      int row = static_cast<int>((y - originY) * inverseCellSize);
+      return std::max(0, std::min(row, rows - 1));
+    }
+
+    // Row-major, clamped like the above
+    size_t cellIndex(float x, float y) const {
+      return static_cast<size_t>(cellRow(y)) * columns + cellColumn(x);
+    }
+
+    // One bit per cell (cellIndex), set where a point is within `margin`
+    // of the cell; a query whose rect stays inside a clear cell finds nothing
+    void markCellsNear(float margin, std::vector<uint64_t>& mask) const;
+
+    // visit(id, x, y) for each point inside the rect (inclusive)
+    template <typename Visit>
+    void forEachInRect(float minX, float minY, float maxX, float maxY, Visit&& visit) const {
+      if (ids.empty()) return;
+
+      int column0 = cellColumn(minX), column1 = cellColumn(maxX);
+      int row0 = cellRow(minY), row1 = cellRow(maxY);
+      for (int row = row0; row <= row1; row++) {
+        const uint32_t* start = cellStart.data() + row * columns;
+        for (uint32_t slot = start[column0]; slot < start[column1 + 1]; slot++) {
+          float px = pointX[slot], py = pointY[slot];
+          if (px < minX || px > maxX || py < minY || py > maxY) continue;
+          visit(ids[slot], px, py);
+        }
+      }
+    }
+
+    // visit(id, x, y) for points within `radius` of (x, y), a point right
+    // there included, stopping after maxCount (at most MAX_NEAR). The home
+    // cell goes first, so in a crowd the budget goes to close points.
+    // Returns how many it visited.
+    template <typename Visit>
+    int forEachNear(float x, float y, float radius, int maxCount, Visit&& visit) const {
+      maxCount = std::min(maxCount, MAX_NEAR);
+      if (ids.empty() || maxCount <= 0) return 0;
+
+      // Collected without a branch per point (the radius test is a coin
+      // flip), then visited
+      uint32_t found[MAX_NEAR];
+      int count = 0;
+      float radiusSquared = radius * radius;
+      auto scan = [&](uint32_t first, uint32_t last) {
+        for (uint32_t slot = first; slot < last && count < maxCount; slot++) {
+          float dx = pointX[slot] - x, dy = pointY[slot] - y;
+          found[count] = slot;
+          count += dx * dx + dy * dy <= radiusSquared;
+        }
+      };
+
+      int homeColumn = cellColumn(x), homeRow = cellRow(y);
+      const uint32_t* home = cellStart.data() + homeRow * columns;
+      scan(home[homeColumn], home[homeColumn + 1]);
+
+      int column0 = cellColumn(x - radius), column1 = cellColumn(x + radius);
+      int row0 = cellRow(y - radius), row1 = cellRow(y + radius);
+      for (int row = row0; row <= row1 && count < maxCount; row++) {
+        const uint32_t* start = cellStart.data() + row * columns;
+        if (row != homeRow) {
+          scan(start[column0], start[column1 + 1]);
+        } else {
+          scan(start[column0], start[homeColumn]);
+          scan(start[homeColumn + 1], start[column1 + 1]);
+        }
+      }
+
+      for (int i = 0; i < count; i++) {
+        visit(ids[found[i]], pointX[found[i]], pointY[found[i]]);
+      }
+      return count;
+    }
+
+    size_t size() const;
+    float getCellSize() const;
+    int getColumns() const;
+    int getRows() const;
+};
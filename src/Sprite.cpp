@@ -1,4 +1,5 @@
 #include "Sprite.h"
+#include "QuadIndexBuffer.h"
 #include "Vector2.h"
 #include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/matrix_transform.hpp>
@@ -9,18 +10,10 @@ Sprite::Sprite(Texture* texture) : uvOffset(0, 0), uvSize(1, 1) {
   this->position = Vector2(0, 0);
   this->size = Vector2(texture->getWidth(), texture->getHeight());
   this->rotation = 0.0f;
+  this->depth = 0.0f;
 
-  VAO = 0;
-  VBO = 0;
-  EBO = 0;
-
-  setupMesh();
-}
-
-Sprite::~Sprite() {
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteBuffers(1, &EBO);
+  // The quad is shared; a sprite owns no GL objects
+  resources = GLResources::acquire();
 }
 
 void Sprite::setUVRegion(const Vector2& offset, const Vector2& size) {
@@ -36,38 +29,6 @@ void Sprite::setUVRegionPixels(float x, float y, float width, float height) {
   uvSize   = Vector2(width /texW, height / texH);
 }
 
-void Sprite::setupMesh() {
-  float vertices[] = {
-    // pos      // tex
-    0.0f, 1.0f, 0.0f, 1.0f, // top-left
-    1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
-    0.0f, 0.0f, 0.0f, 0.0f, // bottom-left
-                            //
-    0.0f, 1.0f, 0.0f, 1.0f, // top-left
-    1.0f, 1.0f, 1.0f, 1.0f, // top-right
-    1.0f, 0.0f, 1.0f, 0.0f, // bottom-right
-  };
-
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
-
-  glBindVertexArray(VAO);
-
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-  // Position attr
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
-  glEnableVertexAttribArray(0);
-
-  // Texture coordinate attribute
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-  glEnableVertexAttribArray(1);
-
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
-}
-
 void Sprite::draw(Shader& shader, const Camera& camera) {
   shader.use();
 
@@ -91,12 +52,13 @@ void Sprite::draw(Shader& shader, const Camera& camera) {
   shader.setMat4("model", model);
   shader.setVec2("uvOffset", uvOffset.x, uvOffset.y);
   shader.setVec2("uvSize", uvSize.x, uvSize.y);
+  shader.setFloat("depth", depth);
   shader.setInt("spriteTexture", 0);
 
   texture->bind(0);
 
-  glBindVertexArray(VAO);
-  glDrawArrays(GL_TRIANGLES, 0, 6);
+  glBindVertexArray(resources->getUnitQuadVAO());
+  glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr);
   glBindVertexArray(0);
 
   texture->unbind();
@@ -114,6 +76,10 @@ void Sprite::setRotation(float degrees) {
   rotation = degrees;
 }
 
+void Sprite::setDepth(float newDepth) {
+  depth = newDepth;
+}
+
 Vector2 Sprite::getPosition() const {
   return position;
 }
@@ -121,3 +87,15 @@ Vector2 Sprite::getPosition() const {
 Vector2 Sprite::getSize() const {
   return size;
 }
+
+Vector2 Sprite::getUVOffset() const {
+  return uvOffset;
+}
+
+Vector2 Sprite::getUVSize() const {
+  return uvSize;
+}
+
+const Texture* Sprite::getTexture() const {
+  return texture;
+}
@@ -2,15 +2,14 @@
 
 #include "Camera.h"
 #include "Common.h"
+#include "GLResources.h"
 #include "Texture.h"
 #include "Shader.h"
 #include "Vector2.h"
 
 class Sprite{
   private:
-    GLuint VAO; // Vertex Array Object
-    GLuint VBO; // Vertex Buffer Object
-    GLuint EBO; // Element Buffer Object
+    std::shared_ptr<GLResources> resources;
 
     Texture* texture;
     Vector2 position;
@@ -20,11 +19,11 @@ class Sprite{
     Vector2 size;
     float rotation;
 
-    void setupMesh();
+    // Clip-space depth for the depth-tested pass
+    float depth;
 
   public:
     Sprite(Texture* texture);
-    ~Sprite();
 
     void draw(Shader& shader, const Camera& camera);
 
@@ -34,7 +33,11 @@ class Sprite{
     void setPosition(const Vector2& pos);
     void setSize(const Vector2& size);
     void setRotation(float degrees);
+    void setDepth(float newDepth);
 
     Vector2 getPosition() const;
     Vector2 getSize() const;
+    Vector2 getUVOffset() const;
+    Vector2 getUVSize() const;
+    const Texture* getTexture() const;
 };
@@ -0,0 +1,418 @@
+#include "SpriteBatch.h"
+
+namespace {
+  const char* OWNER = "SpriteBatch";
+
+  // Fixed-point steps per pixel for instance rects
+  const float SUBPIXELS = 4.0f;
+  const float MAX_OFFSET = 32767.0f / SUBPIXELS;
+
+  // Matches local_size_x in sprite_cull.comp
+  const int CULL_GROUP_SIZE = 64;
+
+  // How far sprites may hang into a view from outside its rect, for the
+  // one-origin check
+  const float VIEW_MARGIN = 1024.0f;
+}
+
+SpriteBatch::SpriteBatch(TextureArray* textures)
+  : resources(GLResources::acquire()),
+    quadIndices(QuadIndexBuffer::acquire()),
+    instanceCapacity(0),
+    textures(textures),
+    viewProjection(1.0f),
+    views(nullptr),
+    origin(0.0f),
+    cullShader(nullptr),
+    culledCapacity(0),
+    viewRect(0.0f),
+    hasViewRect(false),
+    drawCalls(0),
+    spritesDrawn(0)
+{
+  setupMesh();
+}
+
+void SpriteBatch::setupMesh() {
+  VAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+  instanceVBO = GLObject(GLResources::Kind::BUFFER, OWNER);
+
+  glBindVertexArray(VAO.get());
+
+  // Per-vertex: the shared unit quad (4 corners, shared indices)
+  glBindBuffer(GL_ARRAY_BUFFER, resources->getUnitQuadBuffer());
+  glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(0);
+
+  quadIndices->bind();
+
+  // Per-instance: one entry per sprite, expanded by the attribute formats
+  setupInstanceLayout(instanceVBO.get());
+
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::setupInstanceLayout(GLuint buffer) {
+  glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+  glVertexAttribPointer(2, 4, GL_SHORT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, rect));
+  glEnableVertexAttribArray(2);
+  glVertexAttribDivisor(2, 1);
+
+  glVertexAttribPointer(3, 4, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(Instance), (void*)offsetof(Instance, uvRect));
+  glEnableVertexAttribArray(3);
+  glVertexAttribDivisor(3, 1);
+
+  glVertexAttribPointer(4, 1, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, layer));
+  glEnableVertexAttribArray(4);
+  glVertexAttribDivisor(4, 1);
+
+  glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, depth));
+  glEnableVertexAttribArray(5);
+  glVertexAttribDivisor(5, 1);
+
+  glVertexAttribPointer(6, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)offsetof(Instance, color));
+  glEnableVertexAttribArray(6);
+  glVertexAttribDivisor(6, 1);
+}
+
+void SpriteBatch::setupGpuBuffers() {
+  culledVAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+  culledVBO = GLObject(GLResources::Kind::BUFFER, OWNER);
+  drawCommand = GLObject(GLResources::Kind::BUFFER, OWNER);
+  groupOffsets = GLObject(GLResources::Kind::BUFFER, OWNER);
+
+  // Same quad, but instances come from the compacted buffer
+  glBindVertexArray(culledVAO.get());
+  glBindBuffer(GL_ARRAY_BUFFER, resources->getUnitQuadBuffer());
+  glVertexAttribPointer(0, 2, GL_UNSIGNED_BYTE, GL_FALSE, 2 * sizeof(uint8_t), (void*)0);
+  glEnableVertexAttribArray(0);
+  quadIndices->bind();
+  setupInstanceLayout(culledVBO.get());
+  glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommand.get());
+  glBufferData(GL_DRAW_INDIRECT_BUFFER, 5 * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void SpriteBatch::begin(const Camera& camera) {
+  glm::mat4 projection = glm::ortho(
+      0.0f, static_cast<float>(camera.getViewportWidth()),
+      static_cast<float>(camera.getViewportHeight()), 0.0f
+  );
+
+  Vector2 center = camera.getPosition();
+  begin(projection * camera.getViewMatrix(), glm::vec2(center.x, center.y));
+
+  viewRect = camera.getViewRect();
+  hasViewRect = true;
+}
+
+void SpriteBatch::begin(const ViewSet& views) {
+  // Culled once against everything any view can see
+  glm::vec2 center = views.getUnionCenter();
+  begin(views.getViewProjection(0), center);
+  this->views = &views;
+
+  viewRect = views.getUnionRect();
+  hasViewRect = true;
+
+  // Views far apart (split-screen players at opposite ends of the map)
+  // would lose sprites past MAX_OFFSET from the union's center
+  float reach = std::max(viewRect.z - center.x, viewRect.w - center.y) + VIEW_MARGIN;
+  if (reach <= MAX_OFFSET) return;
+
+  viewOrigins.resize(views.size());
+  viewInstances.resize(views.size());
+  for (int i = 0; i < views.size(); i++) {
+    const glm::vec4& rect = views.getViewRect(i);
+    viewOrigins[i] = glm::vec2((rect.x + rect.z) * 0.5f, (rect.y + rect.w) * 0.5f);
+    viewInstances[i].clear();
+  }
+}
+
+void SpriteBatch::begin(const glm::mat4& viewProjection, const glm::vec2& origin) {
+  this->viewProjection = viewProjection;
+  this->origin = origin;
+  views = nullptr;
+  hasViewRect = false;
+  instances.clear();
+  viewOrigins.clear();
+}
+
+void SpriteBatch::submit(const Sprite& sprite, float depth) {
+  submit(sprite, sprite.getPosition(), sprite.getSize(), depth);
+}
+
+void SpriteBatch::submit(const Sprite& sprite, const Vector2& position, const Vector2& size,
+                         float depth, uint32_t color) {
+  Instance instance;
+  if (!makeInstance(sprite, size, depth, instance)) return;
+
+  instance.color = color;
+  push(instance, position.x, position.y);
+}
+
+void SpriteBatch::submitPoints(const Sprite& sprite, const float* x, const float* y, const uint32_t* colors,
+                               const uint32_t* indices, size_t count, const Vector2& size, float depth) {
+  Instance instance;
+  if (count == 0 || !makeInstance(sprite, size, depth, instance)) return;
+
+  float halfWidth = size.x * 0.5f;
+  float halfHeight = size.y * 0.5f;
+  if (viewOrigins.empty()) instances.reserve(instances.size() + count);
+  for (size_t k = 0; k < count; k++) {
+    uint32_t i = indices[k];
+    instance.color = colors != nullptr ? colors[i] : VertexFormat::WHITE;
+    push(instance, x[i] - halfWidth, y[i] - halfHeight);
+  }
+}
+
+void SpriteBatch::push(Instance& instance, float x, float y) {
+  if (viewOrigins.empty()) {
+    pushRelative(instance, x - origin.x, y - origin.y, instances);
+    return;
+  }
+
+  for (size_t i = 0; i < viewOrigins.size(); i++) {
+    pushRelative(instance, x - viewOrigins[i].x, y - viewOrigins[i].y, viewInstances[i]);
+  }
+}
+
+void SpriteBatch::pushRelative(Instance& instance, float x, float y, std::vector<Instance>& into) {
+  // Too far from the origin to be on screen, and to fit the fixed-point rect
+  if (std::abs(x) > MAX_OFFSET || std::abs(y) > MAX_OFFSET) return;
+
+  instance.rect[0] = static_cast<int16_t>(std::lround(x * SUBPIXELS));
+  instance.rect[1] = static_cast<int16_t>(std::lround(y * SUBPIXELS));
+  into.push_back(instance);
+}
+
+bool SpriteBatch::makeInstance(const Sprite& sprite, const Vector2& size, float depth, Instance& instance) {
+  const Texture* texture = sprite.getTexture();
+
+  // First time we see this sheet: copy it into the array
+  int layer = textures->getLayer(texture);
+  if (layer < 0) {
+    layer = textures->addTexture(texture);
+    if (layer < 0) return false;
+  }
+
+  // Sprite UVs are relative to its own sheet; pages can be larger
+  glm::vec2 uvScale = textures->getUVScale(texture);
+  Vector2 uvOffset = sprite.getUVOffset();
+  Vector2 uvSize = sprite.getUVSize();
+
+  instance.rect[2] = static_cast<int16_t>(std::lround(std::min(size.x, MAX_OFFSET) * SUBPIXELS));
+  instance.rect[3] = static_cast<int16_t>(std::lround(std::min(size.y, MAX_OFFSET) * SUBPIXELS));
+  instance.uvRect[0] = VertexFormat::packUnorm16(uvOffset.x * uvScale.x);
+  instance.uvRect[1] = VertexFormat::packUnorm16(uvOffset.y * uvScale.y);
+  instance.uvRect[2] = VertexFormat::packUnorm16(uvSize.x * uvScale.x);
+  instance.uvRect[3] = VertexFormat::packUnorm16(uvSize.y * uvScale.y);
+  instance.layer = static_cast<uint16_t>(layer);
+  instance.padding = 0;
+  instance.depth = depth;
+  return true;
+}
+
+void SpriteBatch::flush(Shader& shader) {
+  if (!viewOrigins.empty()) {
+    flushPerView(shader, false);
+    return;
+  }
+
+  if (instances.empty()) return;
+
+  drawInstances(shader, -1);
+  finishFlush();
+}
+
+void SpriteBatch::flushCulled(Shader& shader) {
+  if (!viewOrigins.empty()) {
+    flushPerView(shader, true);
+    return;
+  }
+
+  if (instances.empty()) return;
+
+  drawCulled(shader, -1);
+  finishFlush();
+}
+
+void SpriteBatch::flushPerView(Shader& shader, bool culled) {
+  glm::vec2 unionOrigin = origin;
+  glm::vec4 unionRect = viewRect;
+
+  for (int i = 0; i < views->size(); i++) {
+    instances.swap(viewInstances[i]);
+    origin = viewOrigins[i];
+    viewRect = views->getViewRect(i);
+
+    if (!instances.empty()) {
+      if (culled) {
+        drawCulled(shader, i);
+      } else {
+        drawInstances(shader, i);
+      }
+    }
+    finishFlush();
+  }
+
+  origin = unionOrigin;
+  viewRect = unionRect;
+}
+
+void SpriteBatch::drawInstances(Shader& shader, int view) {
+  prepareShader(shader);
+  uploadInstances();
+
+  glBindVertexArray(VAO.get());
+  drawViews(shader, view, [&]() {
+    glDrawElementsInstanced(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr,
+                            static_cast<GLsizei>(instances.size()));
+  });
+  glBindVertexArray(0);
+}
+
+void SpriteBatch::drawCulled(Shader& shader, int view) {
+  if (cullShader == nullptr || !hasViewRect) {
+    drawInstances(shader, view);
+    return;
+  }
+
+  uploadInstances();
+
+  if (culledCapacity < instanceCapacity) {
+    culledCapacity = instanceCapacity;
+    glBindBuffer(GL_ARRAY_BUFFER, culledVBO.get());
+    glBufferData(GL_ARRAY_BUFFER, culledCapacity * sizeof(Instance), nullptr, GL_DYNAMIC_COPY);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, groupOffsets.get());
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (culledCapacity / CULL_GROUP_SIZE + 1) * sizeof(GLuint), nullptr,
+                 GL_DYNAMIC_COPY);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  }
+
+  // The scan stage writes the visible count into instanceCount
+  GLuint command[5] = { static_cast<GLuint>(QuadIndexBuffer::indexCount(1)), 0, 0, 0, 0 };
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommand.get());
+  glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), command);
+
+  int count = static_cast<int>(instances.size());
+  int groupCount = (count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE;
+
+  cullShader->use();
+  cullShader->setUint("submittedCount", static_cast<unsigned int>(count));
+  cullShader->setUint("groupCount", static_cast<unsigned int>(groupCount));
+  cullShader->setVec2("batchOrigin", origin);
+  cullShader->setFloat("rectScale", 1.0f / SUBPIXELS);
+  cullShader->setVec4("viewRect", viewRect);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceVBO.get());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, culledVBO.get());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, drawCommand.get());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, groupOffsets.get());
+
+  // Count per group, offsets per group, then the ordered write (see
+  // sprite_cull.comp); an atomic append would shuffle the survivors
+  cullShader->setUint("stage", 0);
+  cullShader->dispatch(count, CULL_GROUP_SIZE);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  cullShader->setUint("stage", 1);
+  cullShader->dispatch(1, CULL_GROUP_SIZE);
+  glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+  cullShader->setUint("stage", 2);
+  cullShader->dispatch(count, CULL_GROUP_SIZE);
+
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+  prepareShader(shader);
+
+  glBindVertexArray(culledVAO.get());
+  drawViews(shader, view, [&]() {
+    glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr);
+  });
+  glBindVertexArray(0);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void SpriteBatch::prepareShader(Shader& shader) {
+  shader.use();
+  shader.setMat4("viewProjection", viewProjection);
+  shader.setVec2("batchOrigin", origin);
+  shader.setFloat("rectScale", 1.0f / SUBPIXELS);
+  shader.setInt("spriteTextures", 0);
+
+  textures->bind(0);
+}
+
+void SpriteBatch::drawViews(Shader& shader, int view, const std::function<void()>& draw) {
+  if (views == nullptr) {
+    draw();
+    drawCalls++;
+    return;
+  }
+
+  // Same instances, same buffers; only the matrix and viewport change
+  int first = view < 0 ? 0 : view;
+  int last = view < 0 ? views->size() : view + 1;
+  for (int i = first; i < last; i++) {
+    views->bind(i);
+    shader.setMat4("viewProjection", views->getViewProjection(i));
+    draw();
+  }
+  drawCalls += last - first;
+}
+
+void SpriteBatch::uploadInstances() {
+  // Orphan the previous storage so the upload never waits on a draw still using it
+  if (instances.size() > instanceCapacity) {
+    instanceCapacity = instances.size() * 2;
+  }
+
+  glBindBuffer(GL_ARRAY_BUFFER, instanceVBO.get());
+  glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+  glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(Instance), instances.data());
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteBatch::finishFlush() {
+  textures->unbind();
+
+  spritesDrawn += static_cast<int>(instances.size());
+  instances.clear();
+}
+
+void SpriteBatch::setGpuCulling(ComputeShader* shader) {
+  if (shader != nullptr && culledVAO.get() == 0) {
+    setupGpuBuffers();
+  } else if (shader == nullptr && culledVAO.get() != 0) {
+    // Freed once the frames still drawing from them are done
+    culledVAO.reset();
+    culledVBO.reset();
+    drawCommand.reset();
+    groupOffsets.reset();
+    culledCapacity = 0;
+  }
+  cullShader = shader;
+}
+
+void SpriteBatch::resetStats() {
+  drawCalls = 0;
+  spritesDrawn = 0;
+}
+
+int SpriteBatch::getDrawCalls() const {
+  return drawCalls;
+}
+
+int SpriteBatch::getSpritesDrawn() const {
+  return spritesDrawn;
+}
+
+bool SpriteBatch::getGpuCulling() const {
+  return cullShader != nullptr;
+}
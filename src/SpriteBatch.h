@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Camera.h"
+#include "Common.h"
+#include "ComputeShader.h"
+#include "GLResources.h"
+#include "QuadIndexBuffer.h"
+#include "Shader.h"
+#include "Sprite.h"
+#include "TextureArray.h"
+#include "VertexFormat.h"
+#include "ViewSet.h"
+
+#include <functional>
+
+// Collects sprites into an instance buffer and draws them with one
+// instanced call. Sprite sheets live in layers of a TextureArray, so
+// sprites from different sheets still share a draw.
+//
+// Begun with a ViewSet, a flush uploads (and GPU-culls) once for the union
+// of the views and then draws once per view. Views too far apart for one
+// 16-bit origin each get their own origin, instances and upload instead.
+class SpriteBatch {
+  private:
+    // 28 bytes per sprite
+    struct Instance {
+      int16_t rect[4];      // position.xy from the batch origin, size.zw (quarter pixels)
+      uint16_t uvRect[4];   // offset.xy, size.zw in page space (unorm16)
+      uint16_t layer;
+      uint16_t padding;
+      float depth;          // Clip depth, full precision: y steps are finer than 16 bits
+      uint32_t color;       // Tint (RGBA8)
+    };
+
+    std::shared_ptr<GLResources> resources;
+    std::shared_ptr<QuadIndexBuffer> quadIndices;
+    GLObject VAO;
+    GLObject instanceVBO;
+    size_t instanceCapacity;
+
+    TextureArray* textures;
+    std::vector<Instance> instances;
+    glm::mat4 viewProjection;
+    const ViewSet* views;  // nullptr = one draw with viewProjection
+
+    // Positions are stored relative to this (the camera for world batches)
+    // so they fit in 16 bits
+    glm::vec2 origin;
+
+    // Per-view origins and instances, when the views don't fit around one;
+    // empty otherwise
+    std::vector<glm::vec2> viewOrigins;
+    std::vector<std::vector<Instance>> viewInstances;
+
+    // GPU culling (GL 4.3): instances go up as an SSBO, compute passes
+    // compact the visible ones into culledVBO in submission order and count
+    // them into the indirect command. Only valid when the batch knows the
+    // camera.
+    ComputeShader* cullShader;
+    GLObject culledVAO;
+    GLObject culledVBO;
+    GLObject drawCommand;
+    GLObject groupOffsets;  // Per cull work group, for the compaction
+    size_t culledCapacity;
+    glm::vec4 viewRect;   // World min.xy, max.xy
+    bool hasViewRect;
+
+    // Per-frame stats
+    int drawCalls;
+    int spritesDrawn;
+
+    // Everything but the position and color; false if the sheet has no layer
+    bool makeInstance(const Sprite& sprite, const Vector2& size, float depth, Instance& instance);
+
+    // Adds the instance at world top-left (x, y), against every origin
+    void push(Instance& instance, float x, float y);
+    void pushRelative(Instance& instance, float x, float y, std::vector<Instance>& into);
+
+    void setupMesh();
+    void setupInstanceLayout(GLuint buffer);
+    void setupGpuBuffers();
+    void uploadInstances();
+    void prepareShader(Shader& shader);
+
+    // Draws the current instances; view -1 = every view
+    void drawInstances(Shader& shader, int view);
+    void drawCulled(Shader& shader, int view);
+    void drawViews(Shader& shader, int view, const std::function<void()>& draw);
+
+    // Each view's own instances in turn, around its own origin
+    void flushPerView(Shader& shader, bool culled);
+    void finishFlush();
+
+  public:
+    SpriteBatch(TextureArray* textures);
+
+    void begin(const Camera& camera);
+    void begin(const ViewSet& views);
+    void begin(const glm::mat4& viewProjection, const glm::vec2& origin = glm::vec2(0.0f));
+    void submit(const Sprite& sprite, float depth);
+
+    // Draws the sprite's current frame into an arbitrary rect, tinted
+    void submit(const Sprite& sprite, const Vector2& position, const Vector2& size,
+                float depth, uint32_t color = VertexFormat::WHITE);
+
+    // One frame at many points (x[i], y[i] for each i in indices), centered;
+    // the sheet and UVs are looked up once. colors may be nullptr (white).
+    void submitPoints(const Sprite& sprite, const float* x, const float* y, const uint32_t* colors,
+                      const uint32_t* indices, size_t count, const Vector2& size, float depth);
+    void flush(Shader& shader);
+
+    // For depth-tested cutouts: culled and compacted on the GPU when
+    // enabled, else a plain flush. Submission order is kept either way, so
+    // sprites at equal depth overlap the same way every frame.
+    void flushCulled(Shader& shader);
+
+    // nullptr turns GPU culling off
+    void setGpuCulling(ComputeShader* shader);
+
+    void resetStats();
+
+    // Getters
+    int getDrawCalls() const;
+    int getSpritesDrawn() const;
+    bool getGpuCulling() const;
+};
@@ -0,0 +1,171 @@
+#include "SpriteSorter.h"
+#include "Simd.h"
+#include <algorithm>
+
+namespace {
+  const int RADIX_BITS = 8;
+  const int RADIX_BUCKETS = 1 << RADIX_BITS;
+  const int KEY_PASSES = 32 / RADIX_BITS;
+
+  // World y range covered by the key: [-Y_BIAS, 2^22 - Y_BIAS)
+  const float Y_BIAS = 65536.0f;
+  const float Y_SUBPIXELS = 4.0f;
+  const uint32_t Y_MAX = (1u << 24) - 1;
+
+  // Give up on the insertion-sort path past this many out-of-order items
+  const size_t MAX_DESCENTS_DIVISOR = 64;
+  const size_t MIN_DESCENTS = 8;
+}
+
+SpriteSorter::SpriteSorter()
+  : minKey(0),
+    maxKey(0),
+    lastCount(0),
+    usedInsertionSort(false)
+{
+}
+
+uint32_t SpriteSorter::makeKey(int layer, float y) {
+  float scaled = (y + Y_BIAS) * Y_SUBPIXELS;
+  uint32_t yq = 0;
+
+  if (scaled > 0.0f) {
+    yq = scaled >= static_cast<float>(Y_MAX) ? Y_MAX : static_cast<uint32_t>(scaled);
+  }
+
+  uint32_t layerBits = static_cast<uint32_t>(std::clamp(layer, 0, 255));
+  return (layerBits << 24) | yq;
+}
+
+float SpriteSorter::keyToDepth(uint32_t key) const {
+  // Sprites use [-1, 0.5]; the ground is drawn further back than that
+  uint32_t span = std::max<uint32_t>(1, maxKey - minKey);
+  double t = static_cast<double>(std::clamp(key, minKey, maxKey) - minKey) / span;
+  return static_cast<float>(0.5 - t * 1.5);
+}
+
+void SpriteSorter::clear() {
+  keys.clear();
+  minKey = 0;
+  maxKey = 0;
+}
+
+void SpriteSorter::add(uint32_t key) {
+  if (keys.empty()) {
+    minKey = key;
+    maxKey = key;
+  } else {
+    minKey = std::min(minKey, key);
+    maxKey = std::max(maxKey, key);
+  }
+  keys.push_back(key);
+}
+
+void SpriteSorter::reserve(size_t count) {
+  keys.reserve(count);
+  sorted.reserve(count);
+  scratch.reserve(count);
+  order.reserve(count);
+}
+
+const std::vector<uint32_t>& SpriteSorter::sort() {
+  usedInsertionSort = tryCoherentSort();
+
+  if (!usedInsertionSort) {
+    radixSort();
+  }
+
+  order.resize(sorted.size());
+  for (size_t i = 0; i < sorted.size(); i++) {
+    order[i] = static_cast<uint32_t>(sorted[i]);
+  }
+
+  lastCount = keys.size();
+  return order;
+}
+
+bool SpriteSorter::tryCoherentSort() {
+  size_t count = keys.size();
+  if (count == 0 || count != lastCount) return false;
+
+  // Replay last frame's order with this frame's keys
+  for (size_t i = 0; i < count; i++) {
+    uint32_t index = static_cast<uint32_t>(sorted[i]);
+    sorted[i] = (static_cast<uint64_t>(keys[index]) << 32) | index;
+  }
+
+  size_t maxDescents = std::max(MIN_DESCENTS, count / MAX_DESCENTS_DIVISOR);
+  size_t descents = Simd::countDescents(sorted.data(), count, maxDescents);
+
+  if (descents > maxDescents) return false;
+  if (descents == 0) return true;
+
+  // Few items out of place - insertion sort is close to linear here
+  for (size_t i = 1; i < count; i++) {
+    uint64_t value = sorted[i];
+    size_t j = i;
+
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+
+    sorted[j] = value;
+  }
+
+  return true;
+}
+
+void SpriteSorter::radixSort() {
+  size_t count = keys.size();
+  sorted.resize(count);
+  scratch.resize(count);
+
+  Simd::packSortKeys(keys.data(), count, sorted.data());
+
+  // All four digit histograms in one pass over the keys
+  uint32_t histograms[KEY_PASSES][RADIX_BUCKETS] = {};
+
+  for (size_t i = 0; i < count; i++) {
+    uint32_t key = keys[i];
+    for (int pass = 0; pass < KEY_PASSES; pass++) {
+      histograms[pass][(key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+  }
+
+  for (int pass = 0; pass < KEY_PASSES; pass++) {
+    uint32_t* histogram = histograms[pass];
+    int shift = 32 + pass * RADIX_BITS;
+
+    // Every key shares this digit - the pass would not move anything
+    uint32_t firstDigit = static_cast<uint32_t>(sorted.empty() ? 0 : (sorted[0] >> shift) & (RADIX_BUCKETS - 1));
+    if (histogram[firstDigit] == count) continue;
+
+    // Exclusive prefix sum -> bucket start offsets
+    uint32_t offset = 0;
+    for (int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+      uint32_t bucketCount = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucketCount;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+      uint64_t value = sorted[i];
+      scratch[histogram[(value >> shift) & (RADIX_BUCKETS - 1)]++] = value;
+    }
+
+    sorted.swap(scratch);
+  }
+}
+
+uint32_t SpriteSorter::getKey(size_t index) const {
+  return keys[index];
+}
+
+size_t SpriteSorter::getCount() const {
+  return keys.size();
+}
+
+bool SpriteSorter::lastSortWasIncremental() const {
+  return usedInsertionSort;
+}
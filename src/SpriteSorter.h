@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Orders sprites back to front by (layer, y) for top-down depth.
+//
+// Each item gets a packed 32-bit sort key; the sort produces an index
+// buffer into the order items were added. Ties keep insertion order.
+//
+// Two paths:
+//  - Stable LSD radix sort over the keys (8-bit digits, passes whose digit
+//    is identical for every key are skipped).
+//  - When the item count matches last frame, the previous order is
+//    replayed and fixed up with insertion sort if only a few items moved.
+//    Entities move a little per frame, so this is the common case.
+//
+// All buffers are reused between frames.
+class SpriteSorter {
+  private:
+    std::vector<uint32_t> keys;
+    uint32_t minKey, maxKey;  // Of the keys added this frame
+
+    // Packed (key << 32 | index) so ties resolve by insertion order
+    std::vector<uint64_t> sorted;
+    std::vector<uint64_t> scratch;
+
+    std::vector<uint32_t> order;
+
+    size_t lastCount;
+    bool usedInsertionSort;
+
+    void radixSort();
+    bool tryCoherentSort();
+
+  public:
+    SpriteSorter();
+
+    // 8 bits of layer over 24 bits of quantized y (quarter pixels)
+    static uint32_t makeKey(int layer, float y);
+
+    // Clip-space depth for one of this frame's keys: later in the order
+    // means nearer. Spread over the keys actually added, not the whole key
+    // space, so sprites a pixel apart still get distinct depths.
+    float keyToDepth(uint32_t key) const;
+
+    void clear();
+    void add(uint32_t key);
+    void reserve(size_t count);
+
+    // Indices of added items, back to front
+    const std::vector<uint32_t>& sort();
+
+    // Getters
+    uint32_t getKey(size_t index) const;
+    size_t getCount() const;
+    bool lastSortWasIncremental() const;
+};
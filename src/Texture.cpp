@@ -4,9 +4,12 @@
 #include <SDL2/SDL_pixels.h>
 #include <SDL2/SDL_surface.h>
 
+namespace {
+  const char* OWNER = "Texture";
+}
+
 Texture::Texture(const std::string& filepath)
   : watcher(filepath),
-    textureID(0),
     width(0),
     height(0),
     channels(0)
@@ -31,8 +34,8 @@ Texture::Texture(const std::string& filepath)
     height  = surface->h;
 
     // Generate OpenGL texture
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    textureID = GLObject(GLResources::Kind::TEXTURE, OWNER);
+    glBindTexture(GL_TEXTURE_2D, textureID.get());
 
     // Set texture parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -61,15 +64,9 @@ Texture::Texture(const std::string& filepath)
     std::cout << "Texture loaded: " << filepath << " (" << width << "x" << height << ")" << std::endl;
 }
 
-Texture::~Texture() {
-  if (textureID != 0) {
-    glDeleteTextures(1, &textureID);
-  }
-}
-
 void Texture::bind(GLuint slot) {
   glActiveTexture(GL_TEXTURE0 + slot);
-  glBindTexture(GL_TEXTURE_2D, textureID);
+  glBindTexture(GL_TEXTURE_2D, textureID.get());
 }
 
 void Texture::unbind() {
@@ -95,17 +92,12 @@ bool Texture::reload() {
     return false;
   }
 
-  // Delete old texture
-  if (textureID != 0) {
-    glDeleteTextures(1, &textureID);
-  }
-
   width   = surface->w;
   height  = surface->h;
 
-  // Generate OpenGL texture
-  glGenTextures(1, &textureID);
-  glBindTexture(GL_TEXTURE_2D, textureID);
+  // Generate OpenGL texture; the old one goes once no frame uses it
+  textureID = GLObject(GLResources::Kind::TEXTURE, OWNER);
+  glBindTexture(GL_TEXTURE_2D, textureID.get());
 
   // Set texture parameters
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
@@ -143,5 +135,5 @@ int Texture::getHeight() const {
 }
 
 GLuint Texture::getID() const {
-  return textureID;
+  return textureID.get();
 }
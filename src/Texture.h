@@ -2,11 +2,12 @@
 
 #include "Common.h"
 #include "FileWatcher.h"
+#include "GLResources.h"
 
 class Texture {
   private:
     FileWatcher watcher;
-    GLuint textureID;
+    GLObject textureID;
 
     int width;
     int height;
@@ -15,7 +16,6 @@ class Texture {
 
   public:
     Texture(const std::string& filepath);
-    ~Texture();
 
     void bind(GLuint slot = 0);
     void unbind();
@@ -0,0 +1,135 @@
+#include "TextureArray.h"
+
+namespace {
+  const char* OWNER = "TextureArray";
+}
+
+TextureArray::TextureArray(int pageWidth, int pageHeight, int initialCapacity)
+  : copyFBO(GLResources::Kind::FRAMEBUFFER, OWNER),
+    pageWidth(pageWidth),
+    pageHeight(pageHeight),
+    capacity(0),
+    layerCount(0)
+{
+  allocate(initialCapacity);
+}
+
+void TextureArray::allocate(int newCapacity) {
+  textureID = GLObject(GLResources::Kind::TEXTURE, OWNER);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID.get());
+
+  glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, pageWidth, pageHeight, newCapacity, 0,
+               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  capacity = newCapacity;
+}
+
+void TextureArray::grow() {
+  GLObject oldTexture = std::move(textureID);
+  int oldCapacity = capacity;
+
+  allocate(oldCapacity * 2);
+
+  // Copy every existing layer GPU-side: old layer -> read FBO -> new layer
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, copyFBO.get());
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID.get());
+
+  for (int layer = 0; layer < layerCount; layer++) {
+    glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, oldTexture.get(), 0, layer);
+    glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 0, 0, pageWidth, pageHeight);
+  }
+
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+  std::cout << "Texture array grown to " << capacity << " layers" << std::endl;
+}
+
+void TextureArray::copyIntoLayer(const Texture* texture, int layer) {
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, copyFBO.get());
+  glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->getID(), 0);
+
+  if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    std::cerr << "Texture array: cannot read source texture" << std::endl;
+  } else {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureID.get());
+    glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, 0, 0,
+                        texture->getWidth(), texture->getHeight());
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  }
+
+  glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0);
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+}
+
+int TextureArray::addTexture(const Texture* texture) {
+  auto it = layers.find(texture);
+  if (it != layers.end()) return it->second;
+
+  if (texture->getWidth() > pageWidth || texture->getHeight() > pageHeight) {
+    std::cerr << "Texture " << texture->getWidth() << "x" << texture->getHeight()
+              << " does not fit a " << pageWidth << "x" << pageHeight << " array page" << std::endl;
+    return -1;
+  }
+
+  if (layerCount == capacity) {
+    grow();
+  }
+
+  int layer = layerCount++;
+  copyIntoLayer(texture, layer);
+  layers[texture] = layer;
+
+  return layer;
+}
+
+void TextureArray::refresh(const Texture* texture) {
+  auto it = layers.find(texture);
+  if (it == layers.end()) return;
+
+  if (texture->getWidth() > pageWidth || texture->getHeight() > pageHeight) {
+    std::cerr << "Reloaded texture no longer fits its array page" << std::endl;
+    return;
+  }
+
+  copyIntoLayer(texture, it->second);
+}
+
+void TextureArray::bind(GLuint slot) {
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D_ARRAY, textureID.get());
+}
+
+void TextureArray::unbind() {
+  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+int TextureArray::getLayer(const Texture* texture) const {
+  auto it = layers.find(texture);
+  return it == layers.end() ? -1 : it->second;
+}
+
+glm::vec2 TextureArray::getUVScale(const Texture* texture) const {
+  return glm::vec2(
+      static_cast<float>(texture->getWidth()) / pageWidth,
+      static_cast<float>(texture->getHeight()) / pageHeight
+  );
+}
+
+int TextureArray::getLayerCount() const {
+  return layerCount;
+}
+
+int TextureArray::getCapacity() const {
+  return capacity;
+}
+
+GLuint TextureArray::getID() const {
+  return textureID.get();
+}
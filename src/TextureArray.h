@@ -0,0 +1,47 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "Common.h"
+#include "GLResources.h"
+#include "Texture.h"
+
+// GL_TEXTURE_2D_ARRAY of equally sized pages. Each sprite sheet is copied
+// into its own layer (top-left aligned), so sprites from different sheets
+// can be drawn together in one instanced draw.
+class TextureArray {
+  private:
+    GLObject textureID;
+    GLObject copyFBO;
+
+    int pageWidth;
+    int pageHeight;
+    int capacity;
+    int layerCount;
+
+    std::unordered_map<const Texture*, int> layers;
+
+    void allocate(int newCapacity);
+    void grow();
+    void copyIntoLayer(const Texture* texture, int layer);
+
+  public:
+    TextureArray(int pageWidth, int pageHeight, int initialCapacity = 4);
+
+    // Copies the texture into a free layer. Returns the layer, or -1 if the
+    // texture is larger than a page.
+    int addTexture(const Texture* texture);
+
+    // Re-copies a texture after it was hot-reloaded
+    void refresh(const Texture* texture);
+
+    void bind(GLuint slot = 0);
+    void unbind();
+
+    // Getters
+    int getLayer(const Texture* texture) const;
+    glm::vec2 getUVScale(const Texture* texture) const;
+    int getLayerCount() const;
+    int getCapacity() const;
+    GLuint getID() const;
+};
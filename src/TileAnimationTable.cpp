@@ -0,0 +1,103 @@
+#include "TileAnimationTable.h"
+
+namespace {
+  const char* OWNER = "TileAnimationTable";
+}
+
+TileAnimationTable::TileAnimationTable()
+  : textureID(GLResources::Kind::TEXTURE, OWNER),
+    dirty(true)
+{
+  glBindTexture(GL_TEXTURE_2D, textureID.get());
+
+  // Read with texelFetch only
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, MAX_FRAMES + 1, MAX_TILES, 0,
+               GL_RGBA, GL_FLOAT, nullptr);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool TileAnimationTable::add(int baseTile, const std::vector<TileFrame>& frames) {
+  if (baseTile < 0 || baseTile >= MAX_TILES) {
+    std::cerr << "Tile animation: tile " << baseTile << " out of range" << std::endl;
+    return false;
+  }
+
+  if (frames.empty() || static_cast<int>(frames.size()) > MAX_FRAMES) {
+    std::cerr << "Tile animation: tile " << baseTile << " needs 1-"
+              << MAX_FRAMES << " frames" << std::endl;
+    return false;
+  }
+
+  animations[baseTile] = frames;
+  dirty = true;
+  return true;
+}
+
+void TileAnimationTable::remove(int baseTile) {
+  if (animations.erase(baseTile) > 0) {
+    dirty = true;
+  }
+}
+
+void TileAnimationTable::upload() {
+  // Small enough (16x256) to rewrite whole whenever the table changes
+  std::vector<glm::vec4> texels((MAX_FRAMES + 1) * MAX_TILES, glm::vec4(0.0f));
+
+  for (const auto& [baseTile, frames] : animations) {
+    glm::vec4* row = &texels[baseTile * (MAX_FRAMES + 1)];
+
+    float endTime = 0.0f;
+    for (size_t i = 0; i < frames.size(); i++) {
+      endTime += frames[i].duration;
+      row[i + 1] = glm::vec4(static_cast<float>(frames[i].tile), endTime,
+                             frames[i].offset.x, frames[i].offset.y);
+    }
+
+    row[0] = glm::vec4(static_cast<float>(frames.size()), endTime, 0.0f, 0.0f);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, textureID.get());
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, MAX_FRAMES + 1, MAX_TILES,
+                  GL_RGBA, GL_FLOAT, texels.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  dirty = false;
+}
+
+void TileAnimationTable::bind(GLuint slot) {
+  if (dirty) upload();
+
+  glActiveTexture(GL_TEXTURE0 + slot);
+  glBindTexture(GL_TEXTURE_2D, textureID.get());
+}
+
+void TileAnimationTable::getCurrentFrames(float time, std::vector<int>& frames) const {
+  frames.clear();
+
+  for (const auto& [baseTile, animation] : animations) {
+    float loopLength = 0.0f;
+    for (const TileFrame& frame : animation) loopLength += frame.duration;
+
+    int current = 0;
+    if (loopLength > 0.0f) {
+      float t = std::fmod(time, loopLength);
+      float endTime = 0.0f;
+      for (size_t i = 0; i < animation.size(); i++) {
+        current = static_cast<int>(i);
+        endTime += animation[i].duration;
+        if (t < endTime) break;
+      }
+    }
+
+    frames.push_back(current);
+  }
+}
+
+int TileAnimationTable::getAnimationCount() const {
+  return static_cast<int>(animations.size());
+}
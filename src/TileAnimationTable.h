@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+
+#include "Common.h"
+#include "GLResources.h"
+
+struct TileFrame {
+  int tile;            // Tileset cell shown during this frame
+  float duration;      // Seconds
+  glm::vec2 offset;    // Scroll within the cell, in tiles (wraps)
+};
+
+// Tile animations resolved on the GPU. Each animated base tile gets a row
+// in a small float texture; the tile shader picks the current frame from
+// the global time, so animated tiles never touch tile data or buffers.
+//
+// Row layout (one row per tile ID):
+//   texel 0     = (frame count, loop length, 0, 0)
+//   texel 1..n  = (tile, frame end time, offset.x, offset.y)
+class TileAnimationTable {
+  private:
+    GLObject textureID;
+    std::map<int, std::vector<TileFrame>> animations;
+    bool dirty;
+
+    void upload();
+
+  public:
+    static const int MAX_TILES = 256;
+    static const int MAX_FRAMES = 15;
+
+    TileAnimationTable();
+
+    // Returns false if the tile ID or frame count is out of range
+    bool add(int baseTile, const std::vector<TileFrame>& frames);
+    void remove(int baseTile);
+
+    // Uploads pending changes, then binds
+    void bind(GLuint slot);
+
+    // Frame each animation shows at `time`, as the tile shader picks it;
+    // the list only changes when some animated tile changes on screen
+    void getCurrentFrames(float time, std::vector<int>& frames) const;
+
+    // Getters
+    int getAnimationCount() const;
+};
@@ -1,129 +1,622 @@
 #include "Tilemap.h"
+#include "GLCapture.h"
+#include "GLDebug.h"
+#include "TileAnimationTable.h"
 #include "glad/gl.h"
 #include <glm/detail/qualifier.hpp>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/fwd.hpp>
+#include <algorithm>
+#include <array>
 
-enum Tile {
-  GRASS = 0,
-  DIRT  = 1,
-  WATER = 2,
-};
+// Behind every sprite (sprites use [-1, 0.5]) so covered ground fails the depth test
+const float GROUND_DEPTH = 0.75f;
+
+// Oldest journal entries are dropped past this
+const size_t MAX_JOURNAL_SIZE = 4096;
+
+// Tiles per chunk side in chunked mesh mode
+const int CHUNK_SIZE = 16;
+
+// Vertex slot per chunk in the GPU culling buffer (worst case: no merging)
+const int CHUNK_SLOT_VERTICES = CHUNK_SIZE * CHUNK_SIZE * 4;
+
+// Matches local_size_x in tile_cull.comp
+const int CULL_GROUP_SIZE = 64;
+
+// Index texture value for "no tile"
+const uint16_t EMPTY_TILE = 0xFFFF;
+
+// Texture units the tile shader expects (0 = tileset, 1 = animation table)
+const int INDEX_TEXTURE_UNIT = 2;
+
+// Registry owner tag for resource counts
+const char* OWNER = "Tilemap";
+
+// Largest side of the impostor texture; bigger maps bake at coarser scales
+const int MAX_IMPOSTOR_SIZE = 4096;
+
+// Rects are min.xy, max.xy
+static bool overlaps(const glm::vec4& a, const glm::vec4& b) {
+  return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+}
 
 Tilemap::Tilemap(int width, int height, int tileSize, Texture* tileset)
   : width(width),
     height(height),
     tileSize(tileSize),
     tileset(tileset),
-    VAO(0),
-    VBO(0),
-    debugVAO(0),
-    debugVBO(0),
-    debugLineCount(0)
+    renderMode(TileRenderMode::CHUNKED_MESH),
+    greedyMeshing(false),
+    vertexCount(0),
+    chunkRebuilds(0),
+    cullShader(nullptr),
+    indexTextureRevision(0),
+    impostorDivisor(2),
+    impostorLod(true),
+    impostorBakes(0),
+    resources(GLResources::acquire()),
+    quadIndices(QuadIndexBuffer::acquire()),
+    debugLineCount(0),
+    revision(0)
 {
   this->tilesPerRow = tileset->getWidth() / tileSize;
 
   // Allocate tile data
   tiles.resize(width * height, 0);
 
+  // Chunk meshes are built lazily, the first time they're visible
+  chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  chunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  chunks.resize(chunksX * chunksY);
+
+  // Impostors start at half scale, coarser if the map wouldn't fit
+  GLint maxTextureSize = 0;
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+  int limit = std::min(MAX_IMPOSTOR_SIZE, static_cast<int>(maxTextureSize));
+  int mapPixels = std::max(width, height) * tileSize;
+  while (limit > 0 && mapPixels > limit * impostorDivisor) impostorDivisor *= 2;
+
   // Set OpenGL Buffers
-  setupMesh();
   setupDebugMesh();
 }
 
-Tilemap::~Tilemap() {
-  glDeleteVertexArrays(1, &VAO);
-  glDeleteBuffers(1, &VBO);
-  glDeleteVertexArrays(1, &debugVAO);
-  glDeleteBuffers(1, &debugVBO);
+void Tilemap::render(Shader& shader, const Camera& camera) {
+  // One view, into whatever the caller bound
+  ViewSet views;
+  views.add(camera);
+  views.update();
+  render(shader, views);
 }
 
-void Tilemap::render(Shader& shader, const Camera& camera) {
+void Tilemap::render(Shader& shader, const ViewSet& views) {
+  // Union of the views that draw tiles (impostor views need none)
+  bool detailed = false;
+  glm::vec4 detailRect(0.0f);
+  for (int i = 0; i < views.size(); i++) {
+    if (usesImpostors(views.getCamera(i))) continue;
+
+    const glm::vec4& rect = views.getViewRect(i);
+    detailRect = detailed ? glm::vec4(std::min(detailRect.x, rect.x), std::min(detailRect.y, rect.y),
+                                      std::max(detailRect.z, rect.z), std::max(detailRect.w, rect.w))
+                          : rect;
+    detailed = true;
+  }
+
+  // Camera-independent work, once for all views
+  int minX, minY, maxX, maxY;
+  if (detailed && visibleTiles(detailRect, minX, minY, maxX, maxY)) {
+    if (renderMode == TileRenderMode::INDEX_TEXTURE) {
+      syncIndexTexture();
+    } else if (cullShader != nullptr) {
+      cullGpuChunks(detailRect);
+    } else {
+      // Views far apart leave a gap in the union; nothing there is built
+      float chunkSpan = static_cast<float>(CHUNK_SIZE * tileSize);
+      auto seenByAnyView = [&](int cx, int cy) {
+        glm::vec4 rect(cx * chunkSpan, cy * chunkSpan, (cx + 1) * chunkSpan, (cy + 1) * chunkSpan);
+        for (int i = 0; i < views.size(); i++) {
+          if (usesImpostors(views.getCamera(i))) continue;
+          if (overlaps(rect, views.getViewRect(i))) return true;
+        }
+        return false;
+      };
+
+      visibleChunks.clear();
+      for (int cy = minY / CHUNK_SIZE; cy <= (maxY - 1) / CHUNK_SIZE; cy++) {
+        for (int cx = minX / CHUNK_SIZE; cx <= (maxX - 1) / CHUNK_SIZE; cx++) {
+          if (!seenByAnyView(cx, cy)) continue;
+
+          Chunk& chunk = chunks[cy * chunksX + cx];
+          if (chunk.dirty) buildChunk(cx, cy);
+          if (chunk.quadCount > 0) visibleChunks.push_back(cy * chunksX + cx);
+        }
+      }
+    }
+  } else {
+    detailed = false;
+    visibleChunks.clear();
+  }
+
   shader.use();
+  setTileUniforms(shader);
 
-  // Projection & view
-  glm::mat4 projection = glm::ortho(
-      0.0f, static_cast<float>(camera.getViewportWidth()),
-      static_cast<float>(camera.getViewportHeight()), 0.0f
-  );
-  glm::mat4 view = camera.getViewMatrix();
+  for (int i = 0; i < views.size(); i++) {
+    const Camera& camera = views.getCamera(i);
+    if (!visibleTiles(views.getViewRect(i), minX, minY, maxX, maxY)) continue;
+
+    views.bind(i);
+    shader.setMat4("projection", views.getProjection(i));
+    shader.setMat4("view", camera.getViewMatrix());
+
+    bool impostorMode = usesImpostors(camera);
+    shader.setInt("impostorMode", impostorMode);
+    shader.setInt("indexTextureMode", !impostorMode && renderMode == TileRenderMode::INDEX_TEXTURE);
+
+    if (impostorMode) {
+      renderImpostors(shader, minX, minY, maxX, maxY);
+    } else if (detailed) {
+      renderDetailed(shader, views.getViewRect(i), minX, minY, maxX, maxY);
+    }
+  }
+}
+
+void Tilemap::renderDetailed(Shader& shader, const glm::vec4& viewRect,
+                             int minX, int minY, int maxX, int maxY) {
+  tileset->bind(0);
+
+  if (renderMode == TileRenderMode::INDEX_TEXTURE) {
+    glActiveTexture(GL_TEXTURE0 + INDEX_TEXTURE_UNIT);
+    glBindTexture(GL_TEXTURE_2D, indexTexture.get());
+    glActiveTexture(GL_TEXTURE0);
+
+    // One quad over the visible tiles; the fragment shader looks tiles up
+    glm::mat4 model = glm::translate(glm::mat4(1.0f),
+        glm::vec3(minX * tileSize, minY * tileSize, 0.0f));
+    model = glm::scale(model,
+        glm::vec3((maxX - minX) * tileSize, (maxY - minY) * tileSize, 1.0f));
+    shader.setMat4("model", model);
+
+    // Shared unit quad: corners are both position and tile coordinate.
+    // It has no tile attribute, and this mode never reads one.
+    glBindVertexArray(resources->getUnitQuadVAO());
+    glVertexAttribI4ui(2, 0, 0, 0, 0);
+    glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr);
+    glBindVertexArray(0);
+    return;
+  }
+
+  if (cullShader != nullptr) {
+    // Commands were culled against every view at once; the rest clips
+    shader.setMat4("model", glm::mat4(1.0f));
+
+    glBindVertexArray(gpuVAO.get());
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, drawCommands.get());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr,
+                                static_cast<GLsizei>(chunks.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+    return;
+  }
 
-  shader.setMat4("projection", projection);
-  shader.setMat4("view", view);
+  // Filter the shared visible list down to this view
+  float chunkSpan = static_cast<float>(CHUNK_SIZE * tileSize);
+
+  for (int index : visibleChunks) {
+    float x = (index % chunksX) * chunkSpan;
+    float y = (index / chunksX) * chunkSpan;
+    if (!overlaps(glm::vec4(x, y, x + chunkSpan, y + chunkSpan), viewRect)) continue;
+
+    // Chunk vertices are relative to the chunk origin
+    shader.setMat4("model", glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f)));
+
+    const Chunk& chunk = chunks[index];
+    glBindVertexArray(chunk.VAO.get());
+    glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(chunk.quadCount),
+                   GL_UNSIGNED_SHORT, nullptr);
+  }
+
+  glBindVertexArray(0);
+}
+
+void Tilemap::renderImpostors(Shader& shader, int minX, int minY, int maxX, int maxY) {
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, impostors->getColorTexture());
+
+  // The texture covers whole texels, so slightly more than the map
+  float spanX = static_cast<float>(impostors->getWidth() * impostorDivisor);
+  float spanY = static_cast<float>(impostors->getHeight() * impostorDivisor);
+  shader.setVec2("impostorWorldToUV", glm::vec2(1.0f / spanX, 1.0f / spanY));
+
+  // One quad over the visible tiles, however many there are
+  glm::mat4 model = glm::translate(glm::mat4(1.0f),
+      glm::vec3(minX * tileSize, minY * tileSize, 0.0f));
+  model = glm::scale(model,
+      glm::vec3((maxX - minX) * tileSize, (maxY - minY) * tileSize, 1.0f));
+  shader.setMat4("model", model);
+
+  glBindVertexArray(resources->getUnitQuadVAO());
+  glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(1), GL_UNSIGNED_SHORT, nullptr);
+  glBindVertexArray(0);
+}
+
+void Tilemap::bakeImpostors(Shader& shader, const Camera& camera) {
+  if (!impostorLod || camera.getScale() > getImpostorZoom()) return;
+
+  int minX, minY, maxX, maxY;
+  if (!visibleTiles(camera.getViewRect(), minX, minY, maxX, maxY)) return;
+
+  if (!impostors) {
+    int impostorWidth = (width * tileSize + impostorDivisor - 1) / impostorDivisor;
+    int impostorHeight = (height * tileSize + impostorDivisor - 1) / impostorDivisor;
+    impostors = std::make_unique<RenderTarget>(impostorWidth, impostorHeight);
+
+    // Smooth when shrunk further; the chain is regenerated after each bake
+    glBindTexture(GL_TEXTURE_2D, impostors->getColorTexture());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    for (Chunk& chunk : chunks) chunk.impostorStale = true;
+
+    std::cout << "Tilemap: impostors " << impostorWidth << "x" << impostorHeight
+              << " (1/" << impostorDivisor << " scale)" << std::endl;
+  }
+
+  // Only what's in view; the rest waits until it scrolls in
+  std::vector<int> stale;
+  for (int cy = minY / CHUNK_SIZE; cy <= (maxY - 1) / CHUNK_SIZE; cy++) {
+    for (int cx = minX / CHUNK_SIZE; cx <= (maxX - 1) / CHUNK_SIZE; cx++) {
+      if (chunks[cy * chunksX + cx].impostorStale) stale.push_back(cy * chunksX + cx);
+    }
+  }
+  if (stale.empty()) return;
+
+  GL_DEBUG_GROUP("Chunk impostors");
+
+  // Bottom-up, so the impostor UV of a world position is just a scale
+  float spanX = static_cast<float>(impostors->getWidth() * impostorDivisor);
+  float spanY = static_cast<float>(impostors->getHeight() * impostorDivisor);
+
+  shader.use();
+  shader.setMat4("projection", glm::ortho(0.0f, spanX, 0.0f, spanY));
+  shader.setMat4("view", glm::mat4(1.0f));
+  setTileUniforms(shader);
+  shader.setInt("indexTextureMode", 0);
+  shader.setInt("impostorMode", 0);
+  shader.setInt("fogEnabled", 0);
+  shader.setInt("overdrawView", 0);
+  tileset->bind(0);
+
+  // Baked once, drawn from for many frames: a capture's pre-roll keeps it
+  GLCapture::PersistentPass persistent;
+
+  impostors->bind();
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+  glEnable(GL_SCISSOR_TEST);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+  int chunkSpan = CHUNK_SIZE * tileSize;
+
+  for (int index : stale) {
+    Chunk& chunk = chunks[index];
+    int cx = index % chunksX;
+    int cy = index / chunksX;
+    if (chunk.dirty) buildChunk(cx, cy);
+
+    // The chunk's region, in impostor texels; empty tiles stay transparent
+    int x0 = cx * chunkSpan / impostorDivisor;
+    int y0 = cy * chunkSpan / impostorDivisor;
+    int x1 = std::min(impostors->getWidth(), ((cx + 1) * chunkSpan + impostorDivisor - 1) / impostorDivisor);
+    int y1 = std::min(impostors->getHeight(), ((cy + 1) * chunkSpan + impostorDivisor - 1) / impostorDivisor);
+    glScissor(x0, y0, x1 - x0, y1 - y0);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    if (chunk.quadCount > 0) {
+      shader.setMat4("model", glm::translate(glm::mat4(1.0f),
+          glm::vec3(cx * chunkSpan, cy * chunkSpan, 0.0f)));
+
+      if (cullShader != nullptr) {
+        // The chunk's slot in the shared buffer; instance 0's origin is (0, 0)
+        glBindVertexArray(gpuVAO.get());
+        glDrawElementsBaseVertex(GL_TRIANGLES, QuadIndexBuffer::indexCount(chunk.quadCount),
+                                 GL_UNSIGNED_SHORT, nullptr, index * CHUNK_SLOT_VERTICES);
+      } else {
+        glBindVertexArray(chunk.VAO.get());
+        glDrawElements(GL_TRIANGLES, QuadIndexBuffer::indexCount(chunk.quadCount),
+                       GL_UNSIGNED_SHORT, nullptr);
+      }
+    }
+
+    chunk.impostorStale = false;
+    impostorBakes++;
+  }
+
+  glBindVertexArray(0);
+  glDisable(GL_SCISSOR_TEST);
+  RenderTarget::unbind();
+
+  // Every smaller level follows the new texels
+  glBindTexture(GL_TEXTURE_2D, impostors->getColorTexture());
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Tilemap::setTileUniforms(Shader& shader) {
   shader.setInt("spriteTexture", 0);
+  shader.setInt("tileIndices", INDEX_TEXTURE_UNIT);
+  shader.setFloat("depth", GROUND_DEPTH);
 
-  // UV size
+  // Tileset layout, for turning a (resolved) tile ID into UVs
   float uvWidth = static_cast<float>(tileSize) / tileset->getWidth();
   float uvHeight = static_cast<float>(tileSize) / tileset->getHeight();
   shader.setVec2("uvSize", glm::vec2(uvWidth, uvHeight));
+  shader.setInt("tilesPerRow", tilesPerRow);
+  shader.setFloat("tileSize", static_cast<float>(tileSize));
+}
 
-  tileset->bind(0);
-  glBindVertexArray(VAO);  
+bool Tilemap::visibleTiles(const glm::vec4& view, int& minX, int& minY, int& maxX, int& maxY) const {
 
-  for (int i = 0; i < width * height; i++) {
-    int tileID = tiles[i];
-    if (tileID < 0) continue;
+  minX = std::max(0, static_cast<int>(std::floor(view.x / tileSize)));
+  minY = std::max(0, static_cast<int>(std::floor(view.y / tileSize)));
+  maxX = std::min(width, static_cast<int>(std::ceil(view.z / tileSize)));
+  maxY = std::min(height, static_cast<int>(std::ceil(view.w / tileSize)));
 
-    // Derive grid coords
-    int x = i % width;
-    int y = i / width;
+  return minX < maxX && minY < maxY;
+}
 
-    // Model matrix
-    float worldX = x * tileSize;
-    float worldY = y * tileSize;
+void Tilemap::cullGpuChunks(const glm::vec4& viewRect) {
+  // No visibility test here: whatever changed is rebuilt, on screen or not
+  for (int index : dirtyChunks) {
+    if (chunks[index].dirty) buildChunk(index % chunksX, index / chunksX);
+  }
+  dirtyChunks.clear();
 
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(worldX, worldY, 0.0f));
-    model = glm::scale(model, glm::vec3(tileSize, tileSize, 1.0f));
-    shader.setMat4("model", model);
+  int chunkCount = static_cast<int>(chunks.size());
 
-    // UV offset
-    int tileCol = tileID % tilesPerRow;
-    int tileRow = tileID / tilesPerRow;
-    float uvX = tileCol * uvWidth;
-    float uvY = tileRow * uvHeight;
-    shader.setVec2("uvOffset", uvX, uvY);
+  cullShader->use();
+  cullShader->setVec4("viewRect", viewRect);
+  cullShader->setUint("chunkCount", static_cast<unsigned int>(chunkCount));
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, chunkTable.get());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, drawCommands.get());
+  cullShader->dispatch(chunkCount, CULL_GROUP_SIZE);
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-  }
+  // Commands must land before the draws read them
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
 }
 
-void Tilemap::setupMesh() {
-  std::array<glm::vec4, 6> vertices = {
-    // pos      // tex
-    glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), // top-left
-    glm::vec4(1.0f, 0.0f, 1.0f, 0.0f), // bottom-right
-    glm::vec4(0.0f, 0.0f, 0.0f, 0.0f), // bottom-left
+void Tilemap::buildChunk(int chunkX, int chunkY) {
+  int chunkIndex = chunkY * chunksX + chunkX;
+  Chunk& chunk = chunks[chunkIndex];
 
-    glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), // top-left
-    glm::vec4(1.0f, 1.0f, 1.0f, 1.0f), // top-right
-    glm::vec4(1.0f, 0.0f, 1.0f, 0.0f), // bottom-right
+  // Quad corners in the order the shared index buffer expects
+  static const int CORNERS[4][2] = {
+    {0, 0}, {1, 0}, {0, 1}, {1, 1},
   };
 
-  glGenVertexArrays(1, &VAO);
-  glGenBuffers(1, &VBO);
+  std::vector<TileVertex> vertices;
+  vertices.reserve(CHUNK_SIZE * CHUNK_SIZE * 4);
 
-  glBindVertexArray(VAO);
-  glBindBuffer(GL_ARRAY_BUFFER, VBO);
-  glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec4), vertices.data(), GL_STATIC_DRAW);
+  int startX = chunkX * CHUNK_SIZE;
+  int startY = chunkY * CHUNK_SIZE;
+  int endX = std::min(width, startX + CHUNK_SIZE);
+  int endY = std::min(height, startY + CHUNK_SIZE);
 
-  // Position attr;
-  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)0);
-  glEnableVertexAttribArray(0);
+  // Tiles already covered by a merged quad
+  std::array<bool, CHUNK_SIZE * CHUNK_SIZE> covered{};
+  auto isCovered = [&](int x, int y) -> bool& {
+    return covered[(y - startY) * CHUNK_SIZE + (x - startX)];
+  };
 
-  // Texture coordinate
-  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), (void*)(2 * sizeof(float)));
-  glEnableVertexAttribArray(1);
+  for (int y = startY; y < endY; y++) {
+    for (int x = startX; x < endX; x++) {
+      int tileID = tiles[y * width + x];
+      if (tileID < 0 || isCovered(x, y)) continue;
+
+      // Greedy: grow a run of identical repeatable tiles right, then grow
+      // it down while whole rows match
+      int runWidth = 1;
+      int runHeight = 1;
+
+      if (greedyMeshing && isRepeatable(tileID)) {
+        while (x + runWidth < endX &&
+               tiles[y * width + x + runWidth] == tileID &&
+               !isCovered(x + runWidth, y)) {
+          runWidth++;
+        }
+
+        for (bool rowMatches = true; rowMatches && y + runHeight < endY; ) {
+          for (int rx = x; rx < x + runWidth; rx++) {
+            if (tiles[(y + runHeight) * width + rx] != tileID || isCovered(rx, y + runHeight)) {
+              rowMatches = false;
+              break;
+            }
+          }
+          if (rowMatches) runHeight++;
+        }
+      }
+
+      for (int ry = y; ry < y + runHeight; ry++) {
+        for (int rx = x; rx < x + runWidth; rx++) {
+          isCovered(rx, ry) = true;
+        }
+      }
+
+      // Tile ID, not UVs: the shader resolves animation and atlas position,
+      // and wraps the corner coordinate so merged quads repeat the tile
+      for (const auto& corner : CORNERS) {
+        int u = corner[0] * runWidth;
+        int v = corner[1] * runHeight;
+        vertices.push_back({
+          static_cast<int16_t>((x - startX + u) * tileSize),
+          static_cast<int16_t>((y - startY + v) * tileSize),
+          static_cast<uint8_t>(u), static_cast<uint8_t>(v),
+          static_cast<uint16_t>(tileID)
+        });
+      }
+    }
+  }
+
+  int quadCount = static_cast<int>(vertices.size()) / 4;
+
+  if (cullShader != nullptr) {
+    // Into the chunk's slot, then tell the cull pass how much of it to draw
+    glBindBuffer(GL_ARRAY_BUFFER, gpuVBO.get());
+    glBufferSubData(GL_ARRAY_BUFFER,
+                    static_cast<GLintptr>(chunkIndex) * CHUNK_SLOT_VERTICES * sizeof(TileVertex),
+                    vertices.size() * sizeof(TileVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    uint32_t count = static_cast<uint32_t>(quadCount);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, chunkTable.get());
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                    chunkIndex * sizeof(GpuChunk) + offsetof(GpuChunk, quadCount),
+                    sizeof(count), &count);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  } else {
+    if (chunk.VAO.get() == 0) {
+      chunk.VAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+      chunk.VBO = GLObject(GLResources::Kind::BUFFER, OWNER);
+
+      glBindVertexArray(chunk.VAO.get());
+      glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO.get());
+      setupVertexLayout();
+      glBindVertexArray(0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, chunk.VBO.get());
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(TileVertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+  }
+
+  vertexCount += (quadCount - chunk.quadCount) * 4;
+  chunk.quadCount = quadCount;
+  chunk.dirty = false;
+  chunkRebuilds++;
+}
+
+void Tilemap::syncIndexTexture() {
+  bool created = false;
+
+  if (indexTexture.get() == 0) {
+    indexTexture = GLObject(GLResources::Kind::TEXTURE, OWNER);
+    glBindTexture(GL_TEXTURE_2D, indexTexture.get());
+
+    // Integer texture: texelFetch only, no filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16UI, width, height, 0,
+                 GL_RED_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+    created = true;
+  } else if (indexTextureRevision == revision) {
+    return;
+  } else {
+    glBindTexture(GL_TEXTURE_2D, indexTexture.get());
+  }
+
+  // Rows of 16-bit texels aren't always 4-byte aligned
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+
+  std::vector<TileChange> pending;
+  if (!created && getChangesSince(indexTextureRevision, pending)) {
+    // Just the texels setTile touched
+    for (const TileChange& change : pending) {
+      uint16_t value = change.tileID < 0 ? EMPTY_TILE : static_cast<uint16_t>(change.tileID);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, change.x, change.y, 1, 1,
+                      GL_RED_INTEGER, GL_UNSIGNED_SHORT, &value);
+    }
+  } else {
+    std::vector<uint16_t> data(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++) {
+      data[i] = tiles[i] < 0 ? EMPTY_TILE : static_cast<uint16_t>(tiles[i]);
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height,
+                    GL_RED_INTEGER, GL_UNSIGNED_SHORT, data.data());
+  }
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  indexTextureRevision = revision;
+}
+
+void Tilemap::setupGpuBuffers() {
+  int chunkCount = static_cast<int>(chunks.size());
+  float chunkSpan = static_cast<float>(CHUNK_SIZE * tileSize);
+
+  // Bounds and origins never change; only quad counts follow rebuilds
+  std::vector<GpuChunk> table(chunkCount);
+  std::vector<glm::vec2> origins(chunkCount);
+
+  for (int i = 0; i < chunkCount; i++) {
+    float x = (i % chunksX) * chunkSpan;
+    float y = (i / chunksX) * chunkSpan;
+
+    table[i] = GpuChunk{
+      { x, y, std::min(x + chunkSpan, static_cast<float>(width * tileSize)),
+              std::min(y + chunkSpan, static_cast<float>(height * tileSize)) },
+      0, static_cast<uint32_t>(i * CHUNK_SLOT_VERTICES), { 0, 0 }
+    };
+    origins[i] = glm::vec2(x, y);
+  }
+
+  chunkTable = GLObject(GLResources::Kind::BUFFER, OWNER);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, chunkTable.get());
+  glBufferData(GL_SHADER_STORAGE_BUFFER, table.size() * sizeof(GpuChunk), table.data(), GL_DYNAMIC_DRAW);
+
+  // Written only by the cull pass
+  drawCommands = GLObject(GLResources::Kind::BUFFER, OWNER);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawCommands.get());
+  glBufferData(GL_SHADER_STORAGE_BUFFER, chunkCount * 5 * sizeof(GLuint), nullptr, GL_DYNAMIC_COPY);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  gpuVAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+  gpuVBO = GLObject(GLResources::Kind::BUFFER, OWNER);
+  chunkOrigins = GLObject(GLResources::Kind::BUFFER, OWNER);
+
+  glBindVertexArray(gpuVAO.get());
+
+  glBindBuffer(GL_ARRAY_BUFFER, gpuVBO.get());
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(chunkCount) * CHUNK_SLOT_VERTICES * sizeof(TileVertex),
+               nullptr, GL_DYNAMIC_DRAW);
+  setupVertexLayout();
+
+  // One "instance" per chunk; each command's baseInstance picks its origin
+  glBindBuffer(GL_ARRAY_BUFFER, chunkOrigins.get());
+  glBufferData(GL_ARRAY_BUFFER, origins.size() * sizeof(glm::vec2), origins.data(), GL_STATIC_DRAW);
+  glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+  glEnableVertexAttribArray(3);
+  glVertexAttribDivisor(3, 1);
 
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
   glBindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void Tilemap::setupVertexLayout() {
+  // Integers straight into float attributes; no normalization needed
+  glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, sizeof(TileVertex), (void*)offsetof(TileVertex, x));
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(TileVertex), (void*)offsetof(TileVertex, u));
+  glEnableVertexAttribArray(1);
+  glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(TileVertex), (void*)offsetof(TileVertex, tile));
+  glEnableVertexAttribArray(2);
+
+  quadIndices->bind();
 }
 
 bool Tilemap::isSolid(int tileX, int tileY) const {
-  int tileID = getTile(tileX, tileY);
-  return tileID != WATER;
+  // Anything you can't stand on blocks, including off the map
+  return !isWalkable(tileX, tileY);
 }
 
 bool Tilemap::isWalkable(int x, int y) const {
+  if (x < 0 || y < 0 || x >= width || y >= height) return false;
+
   int tileID = getTile(x, y);
   return tileID == GRASS || tileID == DIRT;
 }
@@ -135,10 +628,123 @@ int Tilemap::getTile(int x, int y) const {
 int Tilemap::getTileCountX() const { return width; }
 int Tilemap::getTileCountY() const { return height; }
 int Tilemap::getTileSize()   const { return tileSize; }
+TileRenderMode Tilemap::getRenderMode() const { return renderMode; }
+bool Tilemap::getGreedyMeshing() const { return greedyMeshing; }
+bool Tilemap::getGpuCulling() const { return cullShader != nullptr; }
+int Tilemap::getVertexCount() const { return vertexCount; }
+int Tilemap::getChunkRebuilds() const { return chunkRebuilds; }
+bool Tilemap::getImpostorLod() const { return impostorLod; }
+int Tilemap::getImpostorBakes() const { return impostorBakes; }
+float Tilemap::getImpostorZoom() const { return 1.0f / impostorDivisor; }
+
+bool Tilemap::usesImpostors(const Camera& camera) const {
+  return impostorLod && impostors && camera.getScale() <= getImpostorZoom();
+}
+
+uint64_t Tilemap::getRevision() const { return revision; }
 
 void Tilemap::setTile(int x, int y, int tileID) {
-  int tile = getTile(x, y);
-  tiles[tile] = tileID;
+  if (x < 0 || y < 0 || x >= width || y >= height) return;
+
+  // The shaders look IDs up in the animation table, one row per ID
+  if (tileID >= TileAnimationTable::MAX_TILES) {
+    std::cerr << "Tilemap: tile " << tileID << " out of range" << std::endl;
+    return;
+  }
+
+  int& tile = tiles[y * width + x];
+  if (tile == tileID) return;
+  tile = tileID;
+
+  if (changes.size() >= MAX_JOURNAL_SIZE) {
+    changes.erase(changes.begin(), changes.begin() + MAX_JOURNAL_SIZE / 2);
+  }
+
+  changes.push_back({x, y, tileID});
+  revision++;
+
+  // Rebaked next time it's in view zoomed out
+  chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE].impostorStale = true;
+  markChunkDirty((y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE);
+}
+
+void Tilemap::setRenderMode(TileRenderMode mode) {
+  renderMode = mode;
+}
+
+void Tilemap::setGreedyMeshing(bool enabled) {
+  if (greedyMeshing == enabled) return;
+  greedyMeshing = enabled;
+  markAllChunksDirty();
+}
+
+void Tilemap::setGpuCulling(ComputeShader* shader) {
+  if (cullShader == shader) return;
+
+  if (shader != nullptr && gpuVAO.get() == 0) {
+    setupGpuBuffers();
+  }
+
+  // Per-chunk meshes are dead weight on the GPU path; freed once the
+  // frames that drew them are done
+  if (shader != nullptr) {
+    for (Chunk& chunk : chunks) {
+      chunk.VAO.reset();
+      chunk.VBO.reset();
+    }
+  }
+
+  // Meshes live in different buffers on each path
+  cullShader = shader;
+  markAllChunksDirty();
+}
+
+void Tilemap::setImpostorLod(bool enabled) {
+  impostorLod = enabled;
+
+  // Recreated (and rebaked) on demand
+  if (!enabled) impostors.reset();
+}
+
+void Tilemap::setRepeatable(int tileID, bool repeatable) {
+  if (tileID < 0) return;
+
+  if (tileID >= static_cast<int>(repeatableTiles.size())) {
+    repeatableTiles.resize(tileID + 1, false);
+  }
+  repeatableTiles[tileID] = repeatable;
+  markAllChunksDirty();
+}
+
+bool Tilemap::isRepeatable(int tileID) const {
+  return tileID >= 0 && tileID < static_cast<int>(repeatableTiles.size()) && repeatableTiles[tileID];
+}
+
+void Tilemap::markChunkDirty(int index) {
+  if (chunks[index].dirty) return;
+  chunks[index].dirty = true;
+
+  // The GPU path rebuilds from this list; the CPU path finds dirty chunks
+  // as they come into view
+  if (cullShader != nullptr) dirtyChunks.push_back(index);
+}
+
+void Tilemap::markAllChunksDirty() {
+  dirtyChunks.clear();
+
+  for (size_t i = 0; i < chunks.size(); i++) {
+    chunks[i].dirty = true;
+    if (cullShader != nullptr) dirtyChunks.push_back(static_cast<int>(i));
+  }
+}
+
+bool Tilemap::getChangesSince(uint64_t sinceRevision, std::vector<TileChange>& out) const {
+  uint64_t missing = revision - sinceRevision;
+  if (missing == 0) return true;
+  if (missing > changes.size()) return false;
+
+  out.insert(out.end(), changes.end() - missing, changes.end());
+  return true;
 }
 
 void Tilemap::setupDebugMesh() {
@@ -171,11 +777,11 @@ void Tilemap::setupDebugMesh() {
 
   debugLineCount = (height + 1 + width + 1) * 2;  // 2 vertices per line
 
-  glGenVertexArrays(1, &debugVAO);
-  glGenBuffers(1, &debugVBO);
+  debugVAO = GLObject(GLResources::Kind::VERTEX_ARRAY, OWNER);
+  debugVBO = GLObject(GLResources::Kind::BUFFER, OWNER);
 
-  glBindVertexArray(debugVAO);
-  glBindBuffer(GL_ARRAY_BUFFER, debugVBO);
+  glBindVertexArray(debugVAO.get());
+  glBindBuffer(GL_ARRAY_BUFFER, debugVBO.get());
   glBufferData(GL_ARRAY_BUFFER, lineVertices.size() * sizeof(float), lineVertices.data(), GL_STATIC_DRAW);
 
   // Position attribute (vec2)
@@ -203,7 +809,7 @@ void Tilemap::renderDebug(Shader& debugShader, const Camera& camera) {
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-  glBindVertexArray(debugVAO);
+  glBindVertexArray(debugVAO.get());
   glDrawArrays(GL_LINES, 0, debugLineCount);
   glBindVertexArray(0);
 
@@ -2,11 +2,59 @@
 
 #include "Camera.h"
 #include "Common.h"
+#include "ComputeShader.h"
+#include "GLResources.h"
 #include "Shader.h"
+#include "QuadIndexBuffer.h"
+#include "RenderTarget.h"
 #include "Texture.h"
+#include "ViewSet.h"
+
+#include <cstdint>
+
+enum Tile {
+  GRASS = 0,
+  DIRT  = 1,
+  WATER = 2,
+};
+
+// One setTile call, as seen by systems that mirror the map (minimap, ...)
+struct TileChange {
+  int x, y;
+  int tileID;
+};
+
+// How the ground layer reaches the screen. Both resolve animated tiles
+// in the shader (see TileAnimationTable).
+enum class TileRenderMode {
+  CHUNKED_MESH,   // Static vertex buffer per chunk, rebuilt when a tile changes
+  INDEX_TEXTURE,  // Tile IDs in a texture, one quad over the view
+};
 
 class Tilemap {
   private:
+    struct Chunk {
+      GLObject VAO, VBO;
+      int quadCount = 0;
+      bool dirty = true;
+      bool impostorStale = true;  // Region of the impostor texture needs a re-render
+    };
+
+    // GPU culling table entry (std430 layout of ChunkBounds in tile_cull.comp)
+    struct GpuChunk {
+      float rect[4];        // World min.xy, max.xy
+      uint32_t quadCount;
+      uint32_t baseVertex;  // Start of the chunk's slot in the shared buffer
+      uint32_t padding[2];
+    };
+
+    // 8 bytes; quads are 4 of these plus the shared index buffer
+    struct TileVertex {
+      int16_t x, y;     // Pixels from the chunk origin
+      uint8_t u, v;     // Corner within the run, in tiles
+      uint16_t tile;
+    };
+
     int width, height, tileSize;
 
     std::vector<int> tiles;    // Grounds layer
@@ -15,20 +63,85 @@ class Tilemap {
     Texture* tileset;
     int tilesPerRow;
 
-    GLuint VAO, VBO;
-    GLuint debugVAO, debugVBO;
+    TileRenderMode renderMode;
+
+    // Chunked mesh mode
+    std::vector<Chunk> chunks;
+    int chunksX, chunksY;
+
+    // Greedy meshing merges runs of identical repeatable tiles into one quad
+    bool greedyMeshing;
+    std::vector<bool> repeatableTiles;
+    int vertexCount;     // Across built chunks
+    int chunkRebuilds;
+
+    // Chunks in view of any camera this frame, with something to draw
+    std::vector<int> visibleChunks;
+
+    // GPU culling (GL 4.3): every chunk owns a fixed slot in one vertex
+    // buffer, and a compute pass turns the chunk table into one indirect
+    // command per chunk, so a single multi-draw covers the whole map
+    ComputeShader* cullShader;
+    GLObject gpuVAO, gpuVBO;
+    GLObject chunkTable;      // SSBO of GpuChunk
+    GLObject drawCommands;    // DrawElementsIndirectCommand per chunk
+    GLObject chunkOrigins;    // Per-instance origin, selected by baseInstance
+    std::vector<int> dirtyChunks;
+
+    // Index texture mode (R16UI, kept in sync through the change journal)
+    GLObject indexTexture;
+    uint64_t indexTextureRevision;
+
+    // Zoomed-out LOD: the map pre-rendered at 1/impostorDivisor scale into
+    // one mipmapped texture, each chunk baked into its own region. Below
+    // the impostor zoom the ground is one quad sampling it, so the cost no
+    // longer grows with the number of tiles in view.
+    std::unique_ptr<RenderTarget> impostors;
+    int impostorDivisor;
+    bool impostorLod;
+    int impostorBakes;
+
+    std::shared_ptr<GLResources> resources;  // Unit quad for index texture mode
+    std::shared_ptr<QuadIndexBuffer> quadIndices;
+    GLObject debugVAO, debugVBO;
     int debugLineCount;
 
-    void setupMesh();
+    // Change journal: consumers remember the revision they last saw and
+    // read everything after it. Bounded; falling behind means a full resync.
+    std::vector<TileChange> changes;
+    uint64_t revision;
+
+    void setupVertexLayout();
     void setupDebugMesh();
+    void setupGpuBuffers();
+    void buildChunk(int chunkX, int chunkY);
+    void cullGpuChunks(const glm::vec4& viewRect);
+    void renderDetailed(Shader& shader, const glm::vec4& viewRect,
+                        int minX, int minY, int maxX, int maxY);
+    void renderImpostors(Shader& shader, int minX, int minY, int maxX, int maxY);
+    void setTileUniforms(Shader& shader);
+    bool visibleTiles(const glm::vec4& view, int& minX, int& minY, int& maxX, int& maxY) const;
+    void syncIndexTexture();
+    void markChunkDirty(int index);
+    void markAllChunksDirty();
+    bool isRepeatable(int tileID) const;
 
   public:
     Tilemap(int width, int height, int tileSize, Texture* tileset);
-    ~Tilemap();
 
+    // Only tiles inside the camera view are drawn
     void render(Shader& shader, const Camera& camera);
+
+    // Every view: chunks are culled and rebuilt once for all of them,
+    // then drawn per view
+    void render(Shader& shader, const ViewSet& views);
     void renderDebug(Shader& debugShader, const Camera& camera);
 
+    // Re-renders the stale chunk impostors in view when render will use
+    // them. Draws into its own framebuffer, so call it before the scene
+    // target is bound; leaves the tile shader's fog and overdraw off.
+    void bakeImpostors(Shader& shader, const Camera& camera);
+
     // Collisions
     bool isWalkable(int tileX, int tileY) const;
     bool isSolid(int tileX, int tileY) const;
@@ -38,8 +151,36 @@ class Tilemap {
     int getTileCountX() const;
     int getTileCountY() const;
     int getTileSize()   const;
+    TileRenderMode getRenderMode() const;
+    bool getGreedyMeshing() const;
+    bool getGpuCulling() const;
+    int getVertexCount() const;
+    int getChunkRebuilds() const;
+    bool getImpostorLod() const;
+    int getImpostorBakes() const;
+
+    // Camera scale (Camera::getScale) at and below which chunks are drawn
+    // from impostors
+    float getImpostorZoom() const;
+    bool usesImpostors(const Camera& camera) const;
 
+    uint64_t getRevision() const;
+
+    // Appends changes after `sinceRevision` to `out`. Returns false if they
+    // are no longer all in the journal and the caller should resync fully.
+    bool getChangesSince(uint64_t sinceRevision, std::vector<TileChange>& out) const;
 
     // Setters
+    // Negative = empty; IDs from TileAnimationTable::MAX_TILES on are rejected
     void setTile(int x, int y, int tileID);
+    void setRenderMode(TileRenderMode mode);
+    void setGreedyMeshing(bool enabled);
+    void setImpostorLod(bool enabled);
+
+    // Chunked mesh mode culls and draws on the GPU with this; nullptr
+    // returns to per-chunk draws culled on the CPU
+    void setGpuCulling(ComputeShader* shader);
+
+    // Tiles whose art wraps seamlessly, so greedy meshing may merge them
+    void setRepeatable(int tileID, bool repeatable);
 };
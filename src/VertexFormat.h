@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Common.h"
+
+// Packing helpers for compact vertex/instance attributes. The GPU expands
+// these back with normalized attribute pointers.
+namespace VertexFormat {
+  // [0, 1] -> GL_UNSIGNED_SHORT, normalized
+  inline uint16_t packUnorm16(float v) {
+    return static_cast<uint16_t>(std::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+  }
+
+  // RGBA in [0, 1] -> 4x GL_UNSIGNED_BYTE, normalized. Byte order matches
+  // GL_RGBA / GL_UNSIGNED_BYTE on little-endian.
+  inline uint32_t packColor(const glm::vec4& color) {
+    auto channel = [](float v) {
+      return static_cast<uint32_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+    };
+
+    return channel(color.x) | (channel(color.y) << 8) |
+           (channel(color.z) << 16) | (channel(color.w) << 24);
+  }
+
+  const uint32_t WHITE = 0xFFFFFFFF;
+}
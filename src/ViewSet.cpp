@@ -0,0 +1,130 @@
+#include "ViewSet.h"
+
+#include <algorithm>
+#include <cmath>
+
+ViewSet::ViewSet()
+  : unionRect(0.0f),
+    sceneTarget(nullptr),
+    sceneScale(1.0f)
+{
+}
+
+void ViewSet::clear() {
+  views.clear();
+  projections.clear();
+  viewProjections.clear();
+  viewRects.clear();
+}
+
+void ViewSet::add(const Camera& camera, int x, int y, RenderTarget* target) {
+  views.push_back(View{ &camera, target, x, y });
+  projections.emplace_back(1.0f);
+  viewProjections.emplace_back(1.0f);
+  viewRects.emplace_back(0.0f);
+}
+
+void ViewSet::update() {
+  for (size_t i = 0; i < views.size(); i++) {
+    const Camera& camera = *views[i].camera;
+
+    projections[i] = glm::ortho(
+        0.0f, static_cast<float>(camera.getViewportWidth()),
+        static_cast<float>(camera.getViewportHeight()), 0.0f
+    );
+    viewProjections[i] = projections[i] * camera.getViewMatrix();
+    viewRects[i] = camera.getViewRect();
+
+    if (i == 0) {
+      unionRect = viewRects[i];
+    } else {
+      unionRect = glm::vec4(std::min(unionRect.x, viewRects[i].x), std::min(unionRect.y, viewRects[i].y),
+                            std::max(unionRect.z, viewRects[i].z), std::max(unionRect.w, viewRects[i].w));
+    }
+  }
+}
+
+void ViewSet::setSceneTarget(RenderTarget* target, float scale) {
+  sceneTarget = target;
+  sceneScale = scale;
+}
+
+void ViewSet::bind(int index) const {
+  const View& view = views[index];
+  int width = view.camera->getViewportWidth();
+  int height = view.camera->getViewportHeight();
+
+  if (view.target != nullptr) {
+    glBindFramebuffer(GL_FRAMEBUFFER, view.target->getID());
+    glViewport(0, 0, width, height);
+    return;
+  }
+
+  if (sceneTarget == nullptr) return;
+
+  // GL rows count up from the bottom; the scene fills the bottom-left
+  // sceneScale of the target (see Window::beginScene)
+  int bottom = sceneTarget->getHeight() - view.y - height;
+  glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget->getID());
+  glViewport(static_cast<int>(std::lround(view.x * sceneScale)),
+             static_cast<int>(std::lround(bottom * sceneScale)),
+             static_cast<int>(std::lround(width * sceneScale)),
+             static_cast<int>(std::lround(height * sceneScale)));
+}
+
+void ViewSet::composite() const {
+  if (sceneTarget == nullptr) return;
+
+  for (const View& view : views) {
+    if (view.target == nullptr) continue;
+
+    int width = view.camera->getViewportWidth();
+    int height = view.camera->getViewportHeight();
+    int bottom = sceneTarget->getHeight() - view.y - height;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, view.target->getID());
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sceneTarget->getID());
+    glBlitFramebuffer(
+        0, 0, width, height,
+        static_cast<int>(std::lround(view.x * sceneScale)),
+        static_cast<int>(std::lround(bottom * sceneScale)),
+        static_cast<int>(std::lround((view.x + width) * sceneScale)),
+        static_cast<int>(std::lround((bottom + height) * sceneScale)),
+        GL_COLOR_BUFFER_BIT, GL_NEAREST
+    );
+  }
+
+  glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget->getID());
+}
+
+int ViewSet::size() const {
+  return static_cast<int>(views.size());
+}
+
+const ViewSet::View& ViewSet::get(int index) const {
+  return views[index];
+}
+
+const Camera& ViewSet::getCamera(int index) const {
+  return *views[index].camera;
+}
+
+const glm::mat4& ViewSet::getProjection(int index) const {
+  return projections[index];
+}
+
+const glm::mat4& ViewSet::getViewProjection(int index) const {
+  return viewProjections[index];
+}
+
+const glm::vec4& ViewSet::getViewRect(int index) const {
+  return viewRects[index];
+}
+
+const glm::vec4& ViewSet::getUnionRect() const {
+  return unionRect;
+}
+
+glm::vec2 ViewSet::getUnionCenter() const {
+  return glm::vec2((unionRect.x + unionRect.z) * 0.5f, (unionRect.y + unionRect.w) * 0.5f);
+}
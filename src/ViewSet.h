@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Camera.h"
+#include "Common.h"
+#include "RenderTarget.h"
+
+// The cameras drawn this frame, and where each one's image goes: a rect
+// of the scene target (split-screen) or a render target of its own
+// (picture-in-picture, composited into the scene afterwards).
+//
+// Work that doesn't depend on the camera (culling, mesh rebuilds,
+// instance uploads) runs once against the union of the view rects; only
+// the draws repeat per view, with that view's matrices.
+class ViewSet {
+  public:
+    struct View {
+      const Camera* camera;
+      RenderTarget* target;  // nullptr = the scene target
+      int x, y;              // Top-left in the scene, internal pixels
+    };
+
+  private:
+    std::vector<View> views;
+    std::vector<glm::mat4> projections;
+    std::vector<glm::mat4> viewProjections;
+    std::vector<glm::vec4> viewRects;
+    glm::vec4 unionRect;
+
+    // Without one, scene views draw wherever the caller bound, so only a
+    // single view makes sense
+    RenderTarget* sceneTarget;
+    float sceneScale;
+
+  public:
+    ViewSet();
+
+    void clear();
+
+    // The view's size is the camera's viewport
+    void add(const Camera& camera, int x = 0, int y = 0, RenderTarget* target = nullptr);
+
+    // Once per frame, after the cameras moved: matrices and view rects
+    void update();
+
+    // Scene views land in `target`, scaled by the dynamic resolution scale
+    void setSceneTarget(RenderTarget* target, float scale);
+
+    // Binds the view's framebuffer and viewport
+    void bind(int index) const;
+
+    // Blits every render-target view into its rect of the scene target
+    void composite() const;
+
+    int size() const;
+    const View& get(int index) const;
+    const Camera& getCamera(int index) const;
+    const glm::mat4& getProjection(int index) const;
+    const glm::mat4& getViewProjection(int index) const;
+    const glm::vec4& getViewRect(int index) const;
+
+    // Bounds of every view rect (world min.xy, max.xy)
+    const glm::vec4& getUnionRect() const;
+    glm::vec2 getUnionCenter() const;
+};
@@ -1,19 +1,41 @@
 #include "Window.h"
 #include "Common.h"
+#include "DynamicTexture.h"
+#include "GLCapture.h"
+#include "GLDebug.h"
+#include "GLResources.h"
+#include "ScreenCapture.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_error.h>
 #include <SDL2/SDL_video.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <ostream>
 #include <type_traits>
 
-Window::Window(const std::string& title, int width, int height) {
+Window::Window(const std::string& title, int width, int height, bool hidden) {
   this->title = title;
   this->width = width;
   this->height = height;
   this->open = true;
   this->window = nullptr;
   this->glContext = nullptr;
+  this->internalWidth = width;
+  this->internalHeight = height;
+  this->renderScale = 1.0f;
+  this->sceneWidth = width;
+  this->sceneHeight = height;
+  this->presentX = 0;
+  this->presentY = 0;
+  this->presentWidth = width;
+  this->presentHeight = height;
+  this->debugContext = false;
+
+#ifndef NDEBUG
+  const char* debugSetting = std::getenv("GAME_GL_DEBUG");
+  this->debugContext = debugSetting != nullptr && std::string(debugSetting) == "1";
+#endif
 
   // Initialize SDL
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -22,14 +44,13 @@ Window::Window(const std::string& title, int width, int height) {
     return;
   }
 
-  // Set OpenGL version
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
-  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
-
   // Enable double buffering
   SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
 
+  if (debugContext) {
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, SDL_GL_CONTEXT_DEBUG_FLAG);
+  }
+
   // Create window with OpenGL support
   window = SDL_CreateWindow(
       title.c_str(),
@@ -37,7 +58,7 @@ Window::Window(const std::string& title, int width, int height) {
       SDL_WINDOWPOS_CENTERED,
       width,
       height,
-      SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE
+      SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | (hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
   );
 
   if (!window) {
@@ -46,9 +67,8 @@ Window::Window(const std::string& title, int width, int height) {
     return;
   }
 
-  // Create OpenGL context
-  glContext = SDL_GL_CreateContext(window);
-  if (!glContext) {
+  // Ask for 4.3 (GPU culling) first; 3.3 core is all the renderer needs
+  if (!createContext(4, 3) && !createContext(3, 3)) {
     std::cerr << "Failed to create OpenGL context: " << SDL_GetError() << std::endl;
     open = false;
     return;
@@ -61,6 +81,20 @@ Window::Window(const std::string& title, int width, int height) {
     return;
   }
 
+  // Before any other GL call, so the trace can rebuild everything
+  if (GLCapture::isRequested()) {
+    GLCapture::install(width, height);
+  }
+
+  // Driver messages; a no-op in release builds
+  if (debugContext && !GLDebug::install()) {
+    std::cerr << "GL debug output unavailable (no KHR_debug context)" << std::endl;
+  }
+
+  // Shared meshes and deferred deletion, alive until the context goes
+  resources = GLResources::acquire();
+  screenCapture = std::make_unique<ScreenCapture>();
+
   // Enable VSync
   SDL_GL_SetSwapInterval(1);
 
@@ -73,9 +107,24 @@ Window::Window(const std::string& title, int width, int height) {
 
   std::cout << "Window created successfully!" << std::endl;
   std::cout << "OpenGL version: " << glGetString(GL_VERSION) << std::endl;
+  std::cout << "GPU culling: " << (supportsGpuCulling() ? "supported" : "unsupported") << std::endl;
+}
+
+bool Window::createContext(int major, int minor) {
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, major);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, minor);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+
+  glContext = SDL_GL_CreateContext(window);
+  return glContext != nullptr;
 }
 
 Window::~Window() {
+  // GL objects must go before the context does
+  screenCapture.reset();
+  sceneTarget.reset();
+  resources.reset();
+
   if (glContext) {
     SDL_GL_DeleteContext(glContext);
   }
@@ -89,12 +138,20 @@ Window::~Window() {
 }
 
 void Window::swapBuffers() {
+  GLCapture::endFrame();
+  GLDebug::endFrame();
+  if (resources) resources->endFrame();
+  DynamicTexture::endFrame();
+
+  // Reads the finished back buffer asynchronously; free when idle
+  if (screenCapture) screenCapture->readFrame(0, width, height);
+
   SDL_GL_SwapWindow(window);
 }
 
 void Window::clear(float r, float g, float b, float a) {
   glClearColor(r, g, b, a);
-  glClear(GL_COLOR_BUFFER_BIT);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 bool Window::isOpen() const {
@@ -109,6 +166,108 @@ void Window::handleResize(int newWidth, int newHeight) {
   width = newWidth;
   height = newHeight;
   glViewport(0, 0, width, height);
+
+  updatePresentRect();
+}
+
+void Window::setInternalResolution(int newWidth, int newHeight) {
+  internalWidth = newWidth;
+  internalHeight = newHeight;
+
+  if (sceneTarget) {
+    sceneTarget->resize(internalWidth, internalHeight);
+  } else {
+    sceneTarget = std::make_unique<RenderTarget>(internalWidth, internalHeight, true);
+  }
+
+  setRenderScale(renderScale);
+  updatePresentRect();
+  std::cout << "Internal resolution: " << internalWidth << "x" << internalHeight << std::endl;
+}
+
+void Window::updatePresentRect() {
+  // Largest whole-number scale that fits keeps every texel the same size
+  int scale = std::min(width / internalWidth, height / internalHeight);
+
+  if (scale >= 1) {
+    presentWidth = internalWidth * scale;
+    presentHeight = internalHeight * scale;
+  } else {
+    // Window smaller than the internal resolution - fit and accept uneven texels
+    float fit = std::min(static_cast<float>(width) / internalWidth,
+                         static_cast<float>(height) / internalHeight);
+    presentWidth = static_cast<int>(internalWidth * fit);
+    presentHeight = static_cast<int>(internalHeight * fit);
+  }
+
+  presentX = (width - presentWidth) / 2;
+  presentY = (height - presentHeight) / 2;
+}
+
+void Window::setRenderScale(float scale) {
+  renderScale = scale;
+  sceneWidth = std::max(1, static_cast<int>(internalWidth * renderScale + 0.5f));
+  sceneHeight = std::max(1, static_cast<int>(internalHeight * renderScale + 0.5f));
+}
+
+void Window::beginScene() {
+  if (!sceneTarget) return;
+  sceneTarget->bind();
+
+  // The camera still covers the same world area, just with fewer pixels
+  glViewport(0, 0, sceneWidth, sceneHeight);
+}
+
+void Window::presentScene() {
+  if (!sceneTarget) return;
+
+  RenderTarget::unbind();
+  glViewport(0, 0, width, height);
+
+  // Letterbox bars
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // Nearest-neighbour upscale straight into the default framebuffer.
+  // Anything drawn after this (HUD) stays at native resolution.
+  glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget->getID());
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBlitFramebuffer(
+      0, 0, sceneWidth, sceneHeight,
+      presentX, presentY, presentX + presentWidth, presentY + presentHeight,
+      GL_COLOR_BUFFER_BIT, GL_NEAREST
+  );
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void Window::presentScene(Shader& postShader) {
+  if (!sceneTarget) return;
+
+  RenderTarget::unbind();
+  glViewport(0, 0, width, height);
+
+  glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  // Same letterboxed rect as the blit, but through a shader
+  glViewport(presentX, presentY, presentWidth, presentHeight);
+  glDisable(GL_BLEND);
+
+  postShader.use();
+  postShader.setInt("sceneTexture", 0);
+  postShader.setVec2("uvScale",
+      static_cast<float>(sceneWidth) / internalWidth,
+      static_cast<float>(sceneHeight) / internalHeight);
+
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, sceneTarget->getColorTexture());
+  glBindVertexArray(resources->getFullscreenVAO());
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glBindVertexArray(0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glEnable(GL_BLEND);
+  glViewport(0, 0, width, height);
 }
 
 int Window::getWidth() const {
@@ -119,6 +278,54 @@ int Window::getHeight() const {
   return height;
 }
 
+int Window::getInternalWidth() const {
+  return internalWidth;
+}
+
+int Window::getInternalHeight() const {
+  return internalHeight;
+}
+
+int Window::getSceneWidth() const {
+  return sceneWidth;
+}
+
+int Window::getSceneHeight() const {
+  return sceneHeight;
+}
+
+float Window::getRenderScale() const {
+  return renderScale;
+}
+
+RenderTarget* Window::getSceneTarget() const {
+  return sceneTarget.get();
+}
+
+bool Window::supportsGpuCulling() const {
+  if (glContext == nullptr) return false;
+
+  // The culling shaders are GLSL 4.30
+  GLint major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  if (major < 4 || (major == 4 && minor < 3)) return false;
+
+  // The loader is generated for 3.3 core, so 4.x entry points are only
+  // loaded through their extensions
+  return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object &&
+         GLAD_GL_ARB_draw_indirect && GLAD_GL_ARB_multi_draw_indirect &&
+         GLAD_GL_ARB_base_instance && GLAD_GL_ARB_shader_image_load_store;
+}
+
+bool Window::isDebugContext() const {
+  return debugContext;
+}
+
+ScreenCapture* Window::getScreenCapture() const {
+  return screenCapture.get();
+}
+
 SDL_Window* Window::getSDLWindow() const {
   return window;
 }
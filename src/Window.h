@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Common.h"
+#include "GLResources.h"
+#include "RenderTarget.h"
+#include "ScreenCapture.h"
+#include "Shader.h"
 #include <SDL2/SDL_video.h>
 
 class Window {
@@ -14,8 +18,38 @@ class Window {
     bool open;
     std::string title;
 
+    // Internal resolution the scene is rendered at before upscaling
+    std::unique_ptr<RenderTarget> sceneTarget;
+    int internalWidth;
+    int internalHeight;
+
+    // Dynamic resolution: the scene renders into a sub-viewport of the
+    // full-size target so scale changes never reallocate it
+    float renderScale;
+    int sceneWidth;
+    int sceneHeight;
+
+    // Where the upscaled scene lands inside the window (letterboxed)
+    int presentX, presentY;
+    int presentWidth, presentHeight;
+
+    // Shared meshes (the full-screen pass VAO) and deferred GL deletion
+    std::shared_ptr<GLResources> resources;
+
+    // Screenshots and recordings, read back at swap time
+    std::unique_ptr<ScreenCapture> screenCapture;
+
+    // KHR_debug context with synchronous output, which stalls the driver:
+    // debug builds only, and only with GAME_GL_DEBUG=1
+    bool debugContext;
+
+    bool createContext(int major, int minor);
+
+    void updatePresentRect();
+
 public:
-    Window(const std::string& title, int width, int height);
+    // Hidden windows still get a context, for offscreen work (benchmarks)
+    Window(const std::string& title, int width, int height, bool hidden = false);
     ~Window();
 
     void swapBuffers();
@@ -26,9 +60,30 @@ public:
 
     void handleResize(int newWidth, int newHeight);
 
+    // Low resolution scene rendering
+    void setInternalResolution(int newWidth, int newHeight);
+    void beginScene();
+    void presentScene();
+    void presentScene(Shader& postShader);
+    void setRenderScale(float scale);
+
     // Getters
     int getWidth() const;
     int getHeight() const;
+    int getInternalWidth() const;
+    int getInternalHeight() const;
+    int getSceneWidth() const;
+    int getSceneHeight() const;
+    float getRenderScale() const;
+    RenderTarget* getSceneTarget() const;
+
+    // Compute shaders, SSBOs and indirect multi-draw with base instance
+    // (core in 4.3, or extensions on older contexts)
+    bool supportsGpuCulling() const;
+
+    bool isDebugContext() const;
+
+    ScreenCapture* getScreenCapture() const;
 
     SDL_Window* getSDLWindow() const;
 };
@@ -0,0 +1,101 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool::WorkerPool(int workerCount)
+  : generation(0),
+    busyWorkers(0),
+    stopping(false),
+    work(nullptr),
+    total(0),
+    chunkSize(1),
+    nextChunk(0)
+{
+  if (workerCount < 0) {
+    workerCount = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+  }
+  workers.resize(std::max(0, workerCount));
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  workReady.notify_all();
+
+  for (std::thread& worker : workers) {
+    if (worker.joinable()) worker.join();
+  }
+}
+
+void WorkerPool::startWorkers() {
+  // Lazily, so a pool that only ever sees small loops runs no extra threads
+  for (std::thread& worker : workers) {
+    if (!worker.joinable()) worker = std::thread(&WorkerPool::workerLoop, this);
+  }
+}
+
+void WorkerPool::parallelFor(size_t count, size_t chunkSize, const ChunkFunction& work) {
+  if (count == 0) return;
+  chunkSize = std::max<size_t>(1, chunkSize);
+
+  if (workers.empty() || count <= chunkSize) {
+    work(0, count);
+    return;
+  }
+
+  startWorkers();
+  {
+    // A worker that woke late for the last loop may still be leaving it
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+
+    this->work = &work;
+    this->total = count;
+    this->chunkSize = chunkSize;
+    nextChunk.store(0, std::memory_order_relaxed);
+    generation++;
+  }
+  workReady.notify_all();
+
+  runChunks();
+
+  // Every chunk is claimed; wait for the ones still running elsewhere
+  std::unique_lock<std::mutex> lock(mutex);
+  workDone.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+int WorkerPool::getThreadCount() const {
+  return static_cast<int>(workers.size()) + 1;
+}
+
+void WorkerPool::workerLoop() {
+  uint64_t seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      workReady.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping) return;
+
+      seen = generation;
+      busyWorkers++;
+    }
+
+    runChunks();
+
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      busyWorkers--;
+    }
+    workDone.notify_all();
+  }
+}
+
+void WorkerPool::runChunks() {
+  while (true) {
+    size_t begin = nextChunk.fetch_add(chunkSize, std::memory_order_relaxed);
+    if (begin >= total) return;
+    (*work)(begin, std::min(begin + chunkSize, total));
+  }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Common.h"
+
+// Fork-join helper for data-parallel loops over SoA arrays.
+//
+// parallelFor splits [0, count) into fixed-size chunks that the workers and
+// the calling thread claim off an atomic counter, and returns once every
+// chunk is done. The threads persist between loops (started on the first
+// one) and sleep on a condition variable in between. Chunks must only
+// write their own slice; which thread runs a chunk is not fixed.
+class WorkerPool {
+  public:
+    // begin, end
+    using ChunkFunction = std::function<void(size_t, size_t)>;
+
+  private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    uint64_t generation;  // Bumped for each loop the workers should join
+    int busyWorkers;      // Inside the current loop
+    bool stopping;
+
+    // The current loop; only written while no worker is busy
+    const ChunkFunction* work;
+    size_t total;
+    size_t chunkSize;
+    std::atomic<size_t> nextChunk;
+
+    void startWorkers();
+    void workerLoop();
+    void runChunks();
+
+  public:
+    // Threads besides the caller; -1 = one per other hardware thread
+    WorkerPool(int workerCount = -1);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs work(begin, end) over every chunk. A loop with one chunk, or a
+    // pool without workers, runs inline.
+    void parallelFor(size_t count, size_t chunkSize, const ChunkFunction& work);
+
+    // Including the calling thread
+    int getThreadCount() const;
+};
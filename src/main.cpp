@@ -1,8 +1,28 @@
+#include "Benchmark.h"
+#include "GLCapture.h"
+#include "GLReplay.h"
 #include "Game.h"
 
+#include <cstdlib>
+
 int main(int argc, char* argv[]) {
-  (void)argc;
-  (void)argv;
+  std::string mode = argc > 1 ? argv[1] : "";
+
+  // Micro-benchmarks, no game: ./game --bench [filter]
+  if (mode == "--bench") {
+    return Benchmark::run(argc > 2 ? argv[2] : "");
+  }
+
+  // Headless re-execution of a trace: ./game --replay <file> [loops] [record]
+  if (mode == "--replay" && argc > 2) {
+    return GLReplay::run(argv[2], argc > 3 ? std::atoi(argv[3]) : 100, argc > 4 ? argv[4] : "");
+  }
+
+  // Record frames while playing: ./game --capture <file> [frames] [skip]
+  if (mode == "--capture" && argc > 2) {
+    GLCapture::request(argv[2], argc > 3 ? std::atoi(argv[3]) : 60,
+                       argc > 4 ? std::atoi(argv[4]) : 600);
+  }
 
   Game game;
   game.run();